@@ -0,0 +1,36 @@
+#!/bin/sh
+# Builds and runs every benches/*.c, the results end up in bench_output.txt (see c_bench_print()).
+# usage: ./bench.sh [baseline.txt]
+#   With a baseline (a bench_output.txt from before), the medians are compared and the ones more than
+#   THRESHOLD percent slower are marked.
+
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2}
+THRESHOLD=${THRESHOLD:-10}
+OUTPUT=bench_output.txt
+
+: > $OUTPUT || exit 1
+for src in ./benches/*.c; do
+    bin=${src%.c}
+    echo "[BENCH] $bin" 1>&2
+    $CC $CFLAGS -o $bin $src -lm -lpthread || exit 1
+    $bin >> $OUTPUT || exit 1
+done
+
+if [ -z "$1" ]; then
+    grep -v '^#' $OUTPUT
+    exit 0
+fi
+
+awk -F '\t' -v threshold=$THRESHOLD '
+    /^#/ { next }
+    FNR == NR { base[$1] = $5; next }
+    {
+        if (!($1 in base)) { printf "%-32s %12s %12.3f %8s\n", $1, "-", $5, "new"; next }
+        ratio = base[$1] > 0 ? $5 / base[$1] : 1
+        mark = ratio > 1 + threshold / 100 ? "  SLOWER" : ratio < 1 - threshold / 100 ? "  faster" : ""
+        printf "%-32s %12.3f %12.3f %7.2fx%s\n", $1, base[$1], $5, ratio, mark
+        if (mark == "  SLOWER") slower++
+    }
+    END { exit slower > 0 }
+' "$1" $OUTPUT
@@ -0,0 +1,53 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#define ROUND 1024
+
+static void alloc_reset(uint64 iters, void *ctx) {
+    Arena *a = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        BENCH_KEEP(arena_alloc(a, 64));
+        if (i % ROUND == ROUND - 1) arena_reset(a);
+    }
+    arena_reset(a);
+}
+
+static void alloc_dealloc(uint64 iters, void *ctx) {
+    Arena *a = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        void *p = arena_alloc(a, 64);
+        BENCH_KEEP(p);
+        arena_dealloc(a, p);
+    }
+    arena_reset(a);
+}
+
+// Mixed sizes, half of them given back before the next ones, like per-frame scratch data
+static void churn(uint64 iters, void *ctx) {
+    Arena *a = ctx;
+    Rng rng;
+    rng_seed(&rng, 1);
+    void *live[64];
+    for (uint64 i = 0; i < iters; ++i) {
+        for (int j = 0; j < 64; ++j) live[j] = arena_alloc(a, (size_t)rng_range(&rng, 8, 256));
+        for (int j = 0; j < 64; j += 2) arena_dealloc(a, live[j]);
+        for (int j = 0; j < 32; ++j) BENCH_KEEP(arena_alloc(a, (size_t)rng_range(&rng, 8, 128)));
+        arena_reset(a);
+    }
+}
+
+int main(void) {
+    Arena a = arena_make(ROUND * 64);
+    bench_print_header(stdout);
+
+    Bench_result r = bench_run("arena/alloc_64_reset", alloc_reset, &a, NULL);
+    bench_print(stdout, &r);
+    r = bench_run("arena/alloc_dealloc_64", alloc_dealloc, &a, NULL);
+    bench_print(stdout, &r);
+    r = bench_run("arena/churn_mixed_96", churn, &a, NULL);
+    bench_print(stdout, &r);
+
+    arena_free(&a);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+typedef struct {
+    String_view text;
+    String_builder packed;
+    String_builder unpacked;
+} Ctx;
+
+static void compress(uint64 iters, void *ctx) {
+    Ctx *c = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        c->packed.count = 0;
+        lz_compress(c->text, &c->packed);
+    }
+}
+
+static void decompress(uint64 iters, void *ctx) {
+    Ctx *c = ctx;
+    String_view packed = { .data = c->packed.items, .count = c->packed.count };
+    for (uint64 i = 0; i < iters; ++i) {
+        c->unpacked.count = 0;
+        BENCH_KEEP(lz_decompress(packed, &c->unpacked));
+    }
+}
+
+int main(void) {
+    // Something like the text artifacts we ship: source code
+    int size = 0;
+    const char *text = read_file("commonlib.h", &size);
+    if (text == NULL) return 1;
+    Ctx c = { .text = { .data = (char *)text, .count = (size_t)size } };
+    Bench_options opts = { .bytes_per_iter = (uint64)size };
+    bench_print_header(stdout);
+
+    Bench_result r = bench_run("lz/compress_commonlib.h", compress, &c, &opts);
+    bench_print(stdout, &r);
+    r = bench_run("lz/decompress_commonlib.h", decompress, &c, &opts);
+    bench_print(stdout, &r);
+
+    sb_free(&c.packed);
+    sb_free(&c.unpacked);
+    C_FREE((void *)text);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+typedef struct {
+    int64 *items;
+    size_t count;
+    size_t capacity;
+} Ints; // @darr
+
+#define GROWN 4096
+
+// Capacity is already there, so this is just the append itself
+static void append(uint64 iters, void *ctx) {
+    Ints *xs = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        if (xs->count == GROWN) xs->count = 0;
+        darr_append(*xs, (int64)i);
+    }
+    BENCH_CLOBBER();
+}
+
+// From empty, with all the reallocs on the way
+static void append_grow(uint64 iters, void *ctx) {
+    (void)ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        Ints xs = {0};
+        for (int64 j = 0; j < GROWN; ++j) darr_append(xs, j);
+        BENCH_KEEP(xs.items);
+        darr_free(xs);
+    }
+}
+
+int main(void) {
+    Ints xs = {0};
+    for (int64 i = 0; i < GROWN; ++i) darr_append(xs, i);
+    bench_print_header(stdout);
+
+    Bench_result r = bench_run("darr/append", append, &xs, &(Bench_options){ .bytes_per_iter = sizeof(int64) });
+    bench_print(stdout, &r);
+    r = bench_run("darr/append_grow_4096", append_grow, NULL, &(Bench_options){ .bytes_per_iter = GROWN * sizeof(int64) });
+    bench_print(stdout, &r);
+
+    darr_free(xs);
+    return 0;
+}
@@ -0,0 +1,54 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#define PATH "bench_read_file.tmp"
+#define SIZE (4 << 20)
+
+static void read_whole(uint64 iters, void *ctx) {
+    (void)ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        int size = 0;
+        const char *data = read_file(PATH, &size);
+        BENCH_KEEP(data[size / 2]);
+        C_FREE((void *)data);
+    }
+}
+
+static void map_whole(uint64 iters, void *ctx) {
+    (void)ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        String_view sv = map_file(PATH, C_MAP_SEQUENTIAL);
+        // Touch every page, the mapping alone doesn't read anything
+        uint64 sum = 0;
+        for (size_t j = 0; j < sv.count; j += 4096) sum += (uint8)sv.data[j];
+        BENCH_KEEP(sum);
+        unmap_file(sv);
+    }
+}
+
+int main(void) {
+    File_writer w;
+    if (!file_writer_open(&w, PATH, 0, 0)) return 1;
+    Rng rng;
+    rng_seed(&rng, 1);
+    for (int i = 0; i < SIZE / 64; ++i) {
+        char line[64];
+        for (int j = 0; j < 63; ++j) line[j] = (char)('a' + rng_below(&rng, 26));
+        line[63] = '\n';
+        file_writer_write(&w, line, sizeof(line));
+    }
+    if (!file_writer_close(&w)) return 1;
+
+    Bench_options opts = { .bytes_per_iter = SIZE, .sample_ns = 20000000ull, .samples = 11 };
+    bench_print_header(stdout);
+
+    // NOTE: The file stays in the page cache, so this measures the copying, not the disk
+    Bench_result r = bench_run("file/read_file_4M", read_whole, NULL, &opts);
+    bench_print(stdout, &r);
+    r = bench_run("file/map_file_4M", map_whole, NULL, &opts);
+    bench_print(stdout, &r);
+
+    remove(PATH);
+    return 0;
+}
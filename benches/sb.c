@@ -0,0 +1,60 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#define FULL (1 << 16)
+
+static void append(uint64 iters, void *ctx) {
+    String_builder *sb = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        if (sb->count >= FULL) sb->count = 0;
+        sb_append(sb, "sixteen  bytes!!");
+    }
+    BENCH_CLOBBER();
+}
+
+static void append_char(uint64 iters, void *ctx) {
+    String_builder *sb = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        if (sb->count >= FULL) sb->count = 0;
+        sb_append_char(sb, 'x');
+    }
+    BENCH_CLOBBER();
+}
+
+static void append_int(uint64 iters, void *ctx) {
+    String_builder *sb = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        if (sb->count >= FULL) sb->count = 0;
+        sb_append_int(sb, (int64)(i * 2654435761u));
+    }
+    BENCH_CLOBBER();
+}
+
+static void appendf(uint64 iters, void *ctx) {
+    String_builder *sb = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        if (sb->count >= FULL) sb->count = 0;
+        sb_appendf(sb, "%s=%d\n", "key", (int)i);
+    }
+    BENCH_CLOBBER();
+}
+
+int main(void) {
+    String_builder sb = {0};
+    // Grown once up front so the reallocs don't land in the first samples
+    for (int i = 0; i < FULL + 64; ++i) sb_append_char(&sb, 'x');
+    bench_print_header(stdout);
+
+    Bench_result r = bench_run("sb/append_16", append, &sb, &(Bench_options){ .bytes_per_iter = 16 });
+    bench_print(stdout, &r);
+    r = bench_run("sb/append_char", append_char, &sb, &(Bench_options){ .bytes_per_iter = 1 });
+    bench_print(stdout, &r);
+    r = bench_run("sb/append_int", append_int, &sb, NULL);
+    bench_print(stdout, &r);
+    r = bench_run("sb/appendf", appendf, &sb, NULL);
+    bench_print(stdout, &r);
+
+    sb_free(&sb);
+    return 0;
+}
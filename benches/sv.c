@@ -0,0 +1,60 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+static void count_char(uint64 iters, void *ctx) {
+    String_view *text = ctx;
+    for (uint64 i = 0; i < iters; ++i) BENCH_KEEP(sv_count_char(*text, '\n'));
+}
+
+static void split_lines(uint64 iters, void *ctx) {
+    String_view *text = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        String_view rest = *text;
+        while (rest.count > 0) {
+            String_view line = sv_lpop_until_char(&rest, '\n');
+            BENCH_KEEP(line.count);
+            sv_lremove(&rest, 1);
+        }
+    }
+}
+
+// `key = value` lines with an int value, trimmed
+static void parse_lines(uint64 iters, void *ctx) {
+    String_view *text = ctx;
+    for (uint64 i = 0; i < iters; ++i) {
+        int64 sum = 0;
+        String_view rest = *text;
+        while (rest.count > 0) {
+            String_view line = sv_lpop_until_char(&rest, '\n');
+            sv_lremove(&rest, 1);
+            String_view key = sv_lpop_until_char(&line, '=');
+            sv_lremove(&line, 1);
+            sv_trim(&key);
+            sv_trim(&line);
+            int count = 0;
+            sum += sv_to_int(line, &count, 10) + (int64)key.count;
+        }
+        BENCH_KEEP(sum);
+    }
+}
+
+int main(void) {
+    String_builder sb = {0};
+    Rng rng;
+    rng_seed(&rng, 1);
+    for (int i = 0; i < 16384; ++i) sb_appendf(&sb, "  key_%d = %lld\n", i, (long long)rng_range(&rng, -100000, 100000));
+    String_view text = { .data = sb.items, .count = sb.count };
+    Bench_options opts = { .bytes_per_iter = text.count };
+    bench_print_header(stdout);
+
+    Bench_result r = bench_run("sv/count_char", count_char, &text, &opts);
+    bench_print(stdout, &r);
+    r = bench_run("sv/split_lines", split_lines, &text, &opts);
+    bench_print(stdout, &r);
+    r = bench_run("sv/parse_key_int", parse_lines, &text, &opts);
+    bench_print(stdout, &r);
+
+    sb_free(&sb);
+    return 0;
+}
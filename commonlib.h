@@ -1,5 +1,15 @@
 #ifndef _COMMONLIB_H_
 #define _COMMONLIB_H_
+// NOTE: Strict ISO C modes (eg: -std=c11) hide the POSIX functions the implementation uses, so ask for them
+//       here; That only works if nothing was #included before this header.
+#if defined(COMMONLIB_IMPLEMENTATION) && defined(__STRICT_ANSI__) && !defined(_WIN32) && !defined(__APPLE__)
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE // glibc: the BSD extras too (d_type, DT_DIR, ...)
+#endif // _DEFAULT_SOURCE
+#endif // defined(COMMONLIB_IMPLEMENTATION) && defined(__STRICT_ANSI__) && !defined(_WIN32) && !defined(__APPLE__)
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdarg.h>
@@ -9,9 +19,17 @@
 #include <ctype.h>
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
 
 #define COMMONLIB_VERSION "v0.1.13"
 
+// SIMD
+// NOTE: Define C_NO_SIMD before including the header to force the scalar paths.
+#if !defined(C_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define C_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
 #if defined(_WIN32) || defined(_MSC_VER)
 // TODO: Name collisions with raylib
 // NOTE: Don't include unwanted files to speed up compilation
@@ -47,6 +65,16 @@
 #define arr_free   c_arr_free
 
 #define os_get_timedate c_os_get_timedate
+#define time_now_ns c_time_now_ns
+#define time_ticks c_time_ticks
+#define ticks_to_ns c_ticks_to_ns
+#define time_calibrate c_time_calibrate
+#define Stopwatch c_Stopwatch
+#define stopwatch_start c_stopwatch_start
+#define stopwatch_stop c_stopwatch_stop
+#define stopwatch_reset c_stopwatch_reset
+#define stopwatch_elapsed_ns c_stopwatch_elapsed_ns
+#define stopwatch_lap_ns c_stopwatch_lap_ns
 #define os_file_exists c_os_file_exists
 #define os_list_files c_os_list_files
 
@@ -54,9 +82,38 @@
 #define log_info c_log_info
 #define log_warning c_log_warning
 #define log_debug c_log_debug
+#define Log_level c_Log_level
+// NOTE: The C_LOG_* levels keep their prefix, LOG_INFO and friends would clash with <syslog.h>
+#define Log_module c_Log_module
+#define LOG_MODULE_INIT C_LOG_MODULE_INIT
+#define LOG_ENABLED C_LOG_ENABLED
+#define LOG_AT C_LOG_AT
+#define log_set_level c_log_set_level
+#define log_configure c_log_configure
+#define blog_open c_blog_open
+#define blog_close c_blog_close
+#define blog_decode c_blog_decode
+#define log_write c_log_write
+#define log_vwrite c_log_vwrite
+#define log_async_start c_log_async_start
+#define log_async_stop c_log_async_stop
+#define log_flush c_log_flush
+#define log_install_crash_handler c_log_install_crash_handler
+#define log_crash_flush c_log_crash_flush
 
 #define read_file c_read_file
 #define touch_file_if_doesnt_exist c_touch_file_if_doesnt_exist
+#define map_file c_map_file
+#define unmap_file c_unmap_file
+#define File_reader c_File_reader
+#define FILE_READER_DEFAULT_BUFFER_SIZE C_FILE_READER_DEFAULT_BUFFER_SIZE
+#define file_reader_open c_file_reader_open
+#define file_reader_next_line c_file_reader_next_line
+#define file_reader_next_record c_file_reader_next_record
+#define file_reader_close c_file_reader_close
+#define MAP_SEQUENTIAL C_MAP_SEQUENTIAL
+#define MAP_WILLNEED C_MAP_WILLNEED
+#define MAP_RANDOM C_MAP_RANDOM
 
 #define Arena c_Arena
 #define arena_make c_arena_make
@@ -71,17 +128,73 @@
 #define clampf c_clampf
 #define randomi c_randomi
 #define randomf c_randomf
+#define random_seed c_random_seed
+#define Rng c_Rng
+#define RNG_DEFAULT_SEED C_RNG_DEFAULT_SEED
+#define rng_seed c_rng_seed
+#define rng_next c_rng_next
+#define rng_jump c_rng_jump
+#define rng_long_jump c_rng_long_jump
+#define rng_below c_rng_below
+#define rng_range c_rng_range
+#define rng_float c_rng_float
+#define rng_float64 c_rng_float64
+#define rng_fill_u64 c_rng_fill_u64
+#define rng_fill_float c_rng_fill_float
+#define rng_fill_int c_rng_fill_int
+#define rng_thread c_rng_thread
+#define Simd_level c_Simd_level
+#define SIMD_LEVEL_SCALAR C_SIMD_LEVEL_SCALAR
+#define SIMD_LEVEL_SSE2 C_SIMD_LEVEL_SSE2
+#define SIMD_LEVEL_AVX2 C_SIMD_LEVEL_AVX2
+#define SIMD_LEVEL_AVX512 C_SIMD_LEVEL_AVX512
+#define SIMD_LEVEL_COUNT C_SIMD_LEVEL_COUNT
+#define simd_level c_simd_level
+#define simd_detected_level c_simd_detected_level
+#define simd_set_level c_simd_set_level
+#define simd_level_name c_simd_level_name
+#define f32_clamp c_f32_clamp
+#define f32_map c_f32_map
+#define f32_lerp c_f32_lerp
+#define f32_scale_add c_f32_scale_add
+#define f32_add c_f32_add
+#define f32_min c_f32_min
+#define f32_max c_f32_max
+#define f32_sum c_f32_sum
+#define f32_dot c_f32_dot
 #define mapf    c_mapf
 #define ease_in_sine c_ease_in_sine
 #define ease_out_sine c_ease_out_sine
 #define ease_in_out_sine c_ease_in_out_sine
 #define ease_in_bounce c_ease_in_bounce
 #define ease_out_bounce c_ease_out_bounce
+#define sin_fast c_sin_fast
+#define cos_fast c_cos_fast
+#define sin_fast_batch c_sin_fast_batch
+#define cos_fast_batch c_cos_fast_batch
+#define ease_in_sine_batch c_ease_in_sine_batch
+#define ease_out_sine_batch c_ease_out_sine_batch
+#define ease_in_out_sine_batch c_ease_in_out_sine_batch
+#define ease_in_bounce_batch c_ease_in_bounce_batch
+#define ease_out_bounce_batch c_ease_out_bounce_batch
 
 #define String_builder c_String_builder
 #define sb_append c_sb_append
 #define sb_append_char c_sb_append_char
 #define sb_append_null c_sb_append_null
+#define sb_reserve c_sb_reserve
+#define sb_append_sv c_sb_append_sv
+#define sb_appendf c_sb_appendf
+#define sb_vappendf c_sb_vappendf
+#define sb_append_int c_sb_append_int
+#define sb_append_uint c_sb_append_uint
+#define sb_append_float64 c_sb_append_float64
+#define sb_append_float32 c_sb_append_float32
+#define FMT_NUMBER_MAX_SIZE C_FMT_NUMBER_MAX_SIZE
+#define fmt_int c_fmt_int
+#define fmt_uint c_fmt_uint
+#define fmt_float64 c_fmt_float64
+#define fmt_float32 c_fmt_float32
 #define sb_free c_sb_free
 
 #define String_view c_String_view
@@ -121,9 +234,214 @@
 #define sv_equals c_sv_equals
 #define sv_get_part c_sv_get_part
 #define sv_lpop_arg c_sv_lpop_arg
+#define sv_count_char c_sv_count_char
 
 #define str_starts_with c_str_starts_with
 
+#define HEX_ENCODED_SIZE C_HEX_ENCODED_SIZE
+#define BASE64_ENCODED_SIZE C_BASE64_ENCODED_SIZE
+#define BASE64_DECODED_MAX_SIZE C_BASE64_DECODED_MAX_SIZE
+#define hex_encode c_hex_encode
+#define hex_decode c_hex_decode
+#define base64_encode c_base64_encode
+#define base64_decode c_base64_decode
+#define sb_append_hex c_sb_append_hex
+#define sb_append_hex_decoded c_sb_append_hex_decoded
+#define sb_append_base64 c_sb_append_base64
+#define sb_append_base64_decoded c_sb_append_base64_decoded
+
+#define Line_index c_Line_index
+#define line_index_build c_line_index_build
+#define line_index_count c_line_index_count
+#define line_index_get c_line_index_get
+#define line_index_find c_line_index_find
+#define line_index_chunk c_line_index_chunk
+#define line_index_free c_line_index_free
+
+#define Hash128 c_Hash128
+#define Hash_state c_Hash_state
+#define hash c_hash
+#define hash128 c_hash128
+#define sv_hash c_sv_hash
+#define sv_hash128 c_sv_hash128
+#define hash_init c_hash_init
+#define hash128_init c_hash128_init
+#define hash_update c_hash_update
+#define hash_final c_hash_final
+#define hash128_final c_hash128_final
+
+#define UTF8_REPLACEMENT_CHAR C_UTF8_REPLACEMENT_CHAR
+#define utf8_validate c_utf8_validate
+#define utf8_count_codepoints c_utf8_count_codepoints
+#define utf8_utf16_length c_utf8_utf16_length
+#define utf8_to_utf32 c_utf8_to_utf32
+#define utf8_to_utf16 c_utf8_to_utf16
+#define utf8_encode c_utf8_encode
+#define sv_lpop_codepoint c_sv_lpop_codepoint
+#define sv_to_wstr c_sv_to_wstr
+#define sb_append_codepoint c_sb_append_codepoint
+
+#define String_rope c_String_rope
+#define Rope_segment c_Rope_segment
+#define ROPE_DEFAULT_SEGMENT_SIZE C_ROPE_DEFAULT_SEGMENT_SIZE
+#define rope_make c_rope_make
+#define rope_append c_rope_append
+#define rope_append_sv c_rope_append_sv
+#define rope_appendf c_rope_appendf
+#define rope_flush c_rope_flush
+#define rope_to_sb c_rope_to_sb
+#define rope_free c_rope_free
+
+#define Thread c_Thread
+#define Thread_proc c_Thread_proc
+#define thread_create c_thread_create
+#define thread_join c_thread_join
+#define thread_yield c_thread_yield
+#define Mutex c_Mutex
+#define MUTEX_INIT C_MUTEX_INIT
+#define mutex_init c_mutex_init
+#define mutex_lock c_mutex_lock
+#define mutex_trylock c_mutex_trylock
+#define mutex_unlock c_mutex_unlock
+#define mutex_destroy c_mutex_destroy
+#define Cond c_Cond
+#define COND_INIT C_COND_INIT
+#define cond_init c_cond_init
+#define cond_wait c_cond_wait
+#define cond_signal c_cond_signal
+#define cond_broadcast c_cond_broadcast
+#define cond_destroy c_cond_destroy
+#define cpu_count c_cpu_count
+#define ATOMIC_LOAD C_ATOMIC_LOAD
+#define ATOMIC_STORE C_ATOMIC_STORE
+#define ATOMIC_FETCH_ADD C_ATOMIC_FETCH_ADD
+#define ATOMIC_EXCHANGE C_ATOMIC_EXCHANGE
+#define ATOMIC_CAS C_ATOMIC_CAS
+#define ATOMIC_FENCE C_ATOMIC_FENCE
+#define Job_proc c_Job_proc
+#define Job c_Job
+#define Wait_group c_Wait_group
+#define pool_start c_pool_start
+#define pool_stop c_pool_stop
+#define pool_worker_count c_pool_worker_count
+#define pool_submit c_pool_submit
+#define wait_group_add c_wait_group_add
+#define wait_group_done c_wait_group_done
+#define wait_group_wait c_wait_group_wait
+#define Range_proc c_Range_proc
+#define parallel_for c_parallel_for
+#define darr_parallel_for c_darr_parallel_for
+#define Reduce_proc c_Reduce_proc
+#define Combine_proc c_Combine_proc
+#define parallel_reduce c_parallel_reduce
+
+#define File_load c_File_load
+#define load_files c_load_files
+
+#define File_writer c_File_writer
+#define FILE_WRITER_DEFAULT_BUFFER_SIZE C_FILE_WRITER_DEFAULT_BUFFER_SIZE
+#define WRITE_ATOMIC C_WRITE_ATOMIC
+#define WRITE_DIRECT C_WRITE_DIRECT
+#define file_writer_open c_file_writer_open
+#define file_writer_write c_file_writer_write
+#define file_writer_write_sv c_file_writer_write_sv
+#define file_writer_write_sb c_file_writer_write_sb
+#define file_writer_writef c_file_writer_writef
+#define file_writer_flush c_file_writer_flush
+#define file_writer_close c_file_writer_close
+
+#define Dir_entry_type c_Dir_entry_type
+#define DIR_ENTRY_FILE C_DIR_ENTRY_FILE
+#define DIR_ENTRY_DIR C_DIR_ENTRY_DIR
+#define DIR_ENTRY_LINK C_DIR_ENTRY_LINK
+#define DIR_ENTRY_OTHER C_DIR_ENTRY_OTHER
+#define Dir_entry c_Dir_entry
+#define Dir_walk c_Dir_walk
+#define Dir_filter c_Dir_filter
+#define WALK_RECURSIVE C_WALK_RECURSIVE
+#define WALK_THREADED C_WALK_THREADED
+#define dir_walk c_dir_walk
+#define dir_entry_path c_dir_entry_path
+#define dir_entry_name c_dir_entry_name
+#define dir_walk_free c_dir_walk_free
+
+#define Watch c_Watch
+#define Watch_event c_Watch_event
+#define Watch_events c_Watch_events
+#define WATCH_CREATED C_WATCH_CREATED
+#define WATCH_MODIFIED C_WATCH_MODIFIED
+#define WATCH_DELETED C_WATCH_DELETED
+#define WATCH_MOVED C_WATCH_MOVED
+#define WATCH_OVERFLOW C_WATCH_OVERFLOW
+#define WATCH_RECURSIVE C_WATCH_RECURSIVE
+#define os_watch_init c_os_watch_init
+#define os_watch_add c_os_watch_add
+#define os_watch_poll c_os_watch_poll
+#define os_watch_close c_os_watch_close
+#define watch_event_path c_watch_event_path
+#define watch_events_free c_watch_events_free
+
+#define PROFILE_BEGIN C_PROFILE_BEGIN
+#define PROFILE_END C_PROFILE_END
+#define Profile_stat c_Profile_stat
+#define Profile_stats c_Profile_stats
+#define profile_begin c_profile_begin
+#define profile_end c_profile_end
+#define profile_write_trace c_profile_write_trace
+#define profile_summary c_profile_summary
+#define profile_print_summary c_profile_print_summary
+#define profile_reset c_profile_reset
+
+#define Bench_proc c_Bench_proc
+#define Bench_options c_Bench_options
+#define Bench_result c_Bench_result
+#define BENCH_KEEP C_BENCH_KEEP
+#define BENCH_CLOBBER C_BENCH_CLOBBER
+#define bench_run c_bench_run
+#define bench_print_header c_bench_print_header
+#define bench_print c_bench_print
+
+#define Alloc_site c_Alloc_site
+#define Alloc_sites c_Alloc_sites
+#define alloc_summary c_alloc_summary
+#define alloc_print_report c_alloc_print_report
+#define alloc_print_leaks c_alloc_print_leaks
+
+#define Mdarr_header c_Mdarr_header
+#define Mdarr_file c_Mdarr_file
+#define mdarr_header c_mdarr_header
+#define mdarr_open c_mdarr_open
+#define mdarr_reserve c_mdarr_reserve
+#define mdarr_append c_mdarr_append
+#define mdarr_sync c_mdarr_sync
+#define mdarr_close c_mdarr_close
+
+#define Rel_ptr c_Rel_ptr
+#define rel_ptr_set c_rel_ptr_set
+#define rel_ptr_get c_rel_ptr_get
+#define arena_offset c_arena_offset
+#define arena_at c_arena_at
+#define Arena_snapshot_header c_Arena_snapshot_header
+#define Arena_snapshot c_Arena_snapshot
+#define arena_save c_arena_save
+#define arena_snapshot_load c_arena_snapshot_load
+#define arena_snapshot_unload c_arena_snapshot_unload
+
+#define lz_compress_bound c_lz_compress_bound
+#define lz_compress_block c_lz_compress_block
+#define lz_decompress_block c_lz_decompress_block
+#define Lz_encoder c_Lz_encoder
+#define lz_encoder_begin c_lz_encoder_begin
+#define lz_encoder_write c_lz_encoder_write
+#define lz_encoder_end c_lz_encoder_end
+#define Lz_decoder c_Lz_decoder
+#define lz_decoder_begin c_lz_decoder_begin
+#define lz_decoder_feed c_lz_decoder_feed
+#define lz_decoder_done c_lz_decoder_done
+#define lz_decoder_free c_lz_decoder_free
+#define lz_compress c_lz_compress
+#define lz_decompress c_lz_decompress
+
 #define SET_FLAG C_SET_FLAG
 #define UNSET_FLAG C_UNSET_FLAG
 #define GET_FLAG C_GET_FLAG
@@ -137,6 +455,21 @@
 
 
 // Memory allocation
+// NOTE: Define COMMONLIB_TRACK_ALLOCS to send these through the allocation tracker (see c_alloc_print_report()).
+#ifdef COMMONLIB_TRACK_ALLOCS
+#if defined(C_MALLOC) || defined(C_CALLOC) || defined(C_FREE) || defined(C_REALLOC)
+#error "COMMONLIB_TRACK_ALLOCS takes over C_MALLOC, C_CALLOC, C_FREE and C_REALLOC"
+#endif // defined(C_MALLOC) || defined(C_CALLOC) || defined(C_FREE) || defined(C_REALLOC)
+#define C_MALLOC(size)       c_track_malloc((size), __FILE__, __LINE__)
+#define C_CALLOC(n, size)    c_track_calloc((n), (size), __FILE__, __LINE__)
+#define C_REALLOC(ptr, size) c_track_realloc((ptr), (size), __FILE__, __LINE__)
+#define C_FREE(ptr)          c_track_free(ptr)
+#endif // COMMONLIB_TRACK_ALLOCS
+void *c_track_malloc(size_t size, const char *file, int line);
+void *c_track_calloc(size_t n, size_t size, const char *file, int line);
+void *c_track_realloc(void *ptr, size_t size, const char *file, int line);
+void c_track_free(void *ptr);
+
 #ifndef C_MALLOC
 #define C_MALLOC malloc
 #endif
@@ -155,6 +488,9 @@
 #ifndef C_MEMMOVE
 #define C_MEMMOVE memmove
 #endif
+#ifndef C_MEMSET
+#define C_MEMSET memset
+#endif
 
 
 // typedefs
@@ -181,8 +517,8 @@ typedef const wchar* wstr;
 // Static variables
 
 // Macros
-#define C_MIN(a, b) a < b ? a : b
-#define C_MAX(a, b) a > b ? a : b
+#define C_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define C_MAX(a, b) ((a) > (b) ? (a) : (b))
 
 #if defined(_MSC_VER) && !defined(__clang__) && !defined(__INTEL_COMPILER)
 #define C_ASSERT(condition, msg) do {\
@@ -202,6 +538,12 @@ typedef const wchar* wstr;
 
 #define C_ARRAY_LEN(arr) (sizeof(arr) / sizeof(arr[0]))
 
+#if defined(__GNUC__) || defined(__clang__)
+#define C_PRINTF_LIKE(fmt_index, args_index) __attribute__((format(printf, fmt_index, args_index)))
+#else
+#define C_PRINTF_LIKE(fmt_index, args_index)
+#endif
+
 #define c_shift(xs, xsz) (assert(xsz > 0 && "Array is empty"), xsz--, *xs++)
 #define c_shift_args c_shift
 
@@ -209,10 +551,13 @@ typedef const wchar* wstr;
 // Math
 //
 #define C_PI 3.14159265359
+#define C_PI_F 3.14159265f
 int   c_clampi(int v, int min, int max);
 float c_clampf(float v, float min, float max);
-float c_randomf(float from, float to);
-int   c_randomi(int from, int to);
+// Random numbers from the calling thread's generator (see c_rng_thread()).
+float c_randomf(float from, float to); // [from, to), `to` itself never comes out
+int   c_randomi(int from, int to);     // [from, to), unbiased; `from` when the range is empty
+void  c_random_seed(uint64 seed);      // reseeds the calling thread's generator
 float c_mapf(float value, float from1, float to1, float from2, float to2);
 float c_ease_in_sine(float t);
 float c_ease_out_sine(float t);
@@ -220,12 +565,226 @@ float c_ease_in_out_sine(float t);
 float c_ease_in_bounce(float t);
 float c_ease_out_bounce(float t);
 
+// Cephes style sinf/cosf: Range reduction in 3 steps plus a degree 7 (sin) / 8 (cos) polynomial.
+// Max abs error is < 8e-8 (under 1 ulp near 1) for |x| <= 8192; Past that (and for NaN/inf) they're libm's sinf()/cosf().
+float c_sin_fast(float x);
+float c_cos_fast(float x);
+// 4 at a time with SSE2, bit for bit the same as going through c_sin_fast()/c_cos_fast() one by one.
+// The sine easings are within 6e-8 of the scalar (libm) ones. `in` and `out` may be the same array.
+void c_sin_fast_batch(const float *in, float *out, size_t n);
+void c_cos_fast_batch(const float *in, float *out, size_t n);
+void c_ease_in_sine_batch(const float *in, float *out, size_t n);
+void c_ease_out_sine_batch(const float *in, float *out, size_t n);
+void c_ease_in_out_sine_batch(const float *in, float *out, size_t n);
+void c_ease_in_bounce_batch(const float *in, float *out, size_t n);
+void c_ease_out_bounce_batch(const float *in, float *out, size_t n);
+
+// xoshiro256** generator; Not for crypto.
+// Streams that need to be independent (eg: one per thread) should start from the same seed and
+// be c_rng_jump()ed a different number of times, that way they're 2^128 numbers apart.
+typedef struct {
+    uint64 s[4];
+} c_Rng;
+
+#define C_RNG_DEFAULT_SEED 0x9E3779B97F4A7C15ull
+
+void   c_rng_seed(c_Rng *r, uint64 seed);
+uint64 c_rng_next(c_Rng *r);
+void   c_rng_jump(c_Rng *r);      // same as 2^128 c_rng_next() calls
+void   c_rng_long_jump(c_Rng *r); // same as 2^192 c_rng_next() calls
+uint64 c_rng_below(c_Rng *r, uint64 n);              // [0, n), unbiased; n > 0
+int64  c_rng_range(c_Rng *r, int64 from, int64 to);  // [from, to], unbiased
+float   c_rng_float(c_Rng *r);   // [0, 1)
+float64 c_rng_float64(c_Rng *r); // [0, 1)
+// Bulk versions; Floats are made from 2 streams at a time with SSE2.
+// NOTE: The second stream is `r` c_rng_long_jump()ed, so it never meets `r` or streams made with c_rng_jump().
+void c_rng_fill_u64(c_Rng *r, uint64 *out, size_t n);
+void c_rng_fill_float(c_Rng *r, float *out, size_t n, float from, float to); // [from, to), like c_randomf()
+void c_rng_fill_int(c_Rng *r, int32 *out, size_t n, int32 from, int32 to);   // [from, to]
+// The calling thread's generator; Seeded with C_RNG_DEFAULT_SEED and jumped once per thread that
+// came before it, so runs are reproducible as long as threads ask for it in the same order.
+c_Rng *c_rng_thread(void);
+
+//
+// Float kernels
+//
+
+// Array versions of the math helpers, run with the widest SIMD the CPU has (checked with CPUID once).
+// NOTE: `out` may be the same array as an input.
+// NOTE: AVX2/AVX-512 use FMA (lerp, map, scale_add, dot) and reductions add up in a different order
+//       per level, so those can differ in the last bits between levels; clamp, add, min and max can't.
+typedef enum {
+    C_SIMD_LEVEL_SCALAR,
+    C_SIMD_LEVEL_SSE2,
+    C_SIMD_LEVEL_AVX2,   // with FMA
+    C_SIMD_LEVEL_AVX512, // AVX-512F
+    C_SIMD_LEVEL_COUNT,
+} c_Simd_level;
+
+c_Simd_level c_simd_level(void);             // what the kernels currently run with
+c_Simd_level c_simd_detected_level(void);    // the best this CPU (and OS) supports
+void c_simd_set_level(c_Simd_level level);   // capped to c_simd_detected_level(); eg: to compare paths
+const char *c_simd_level_name(c_Simd_level level);
+
+void c_f32_clamp(const float32 *in, float32 *out, size_t n, float32 min, float32 max);
+// Same as c_mapf() on each element
+void c_f32_map(const float32 *in, float32 *out, size_t n, float32 from1, float32 to1, float32 from2, float32 to2);
+void c_f32_lerp(const float32 *a, const float32 *b, float32 *out, size_t n, float32 t); // a + (b - a)*t
+void c_f32_scale_add(const float32 *in, float32 *out, size_t n, float32 scale, float32 add); // in*scale + add
+void c_f32_add(const float32 *a, const float32 *b, float32 *out, size_t n);
+// NOTE: min/max of 0 elements are +INFINITY/-INFINITY; NaNs aren't handled
+float32 c_f32_min(const float32 *in, size_t n);
+float32 c_f32_max(const float32 *in, size_t n);
+float32 c_f32_sum(const float32 *in, size_t n);
+float32 c_f32_dot(const float32 *a, const float32 *b, size_t n);
+
 //
 // Struct pre-decls
 //
 
 typedef struct c_Arena c_Arena;
 typedef struct c_String_array c_String_array;
+typedef struct c_String_view c_String_view;
+typedef struct c_String_builder c_String_builder;
+
+//
+// Thread
+//
+
+#if defined(_WIN32)
+typedef HANDLE c_Thread;
+#else
+#include <pthread.h>
+typedef pthread_t c_Thread;
+#endif // defined(_WIN32)
+
+#if defined(_WIN32)
+typedef SRWLOCK c_Mutex;
+#define C_MUTEX_INIT SRWLOCK_INIT
+typedef CONDITION_VARIABLE c_Cond;
+#define C_COND_INIT CONDITION_VARIABLE_INIT
+#else
+typedef pthread_mutex_t c_Mutex;
+#define C_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+typedef pthread_cond_t c_Cond;
+#define C_COND_INIT PTHREAD_COND_INITIALIZER
+#endif // defined(_WIN32)
+
+typedef void *(*c_Thread_proc)(void *arg);
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define C_THREAD_LOCAL __declspec(thread)
+#else
+#define C_THREAD_LOCAL _Thread_local
+#endif // defined(_MSC_VER) && !defined(__clang__)
+
+bool c_thread_create(c_Thread *t, c_Thread_proc proc, void *arg);
+void c_thread_join(c_Thread t);
+// Lets another thread run on this cpu
+void c_thread_yield(void);
+// Number of online logical cpus (atleast 1)
+int  c_cpu_count(void);
+
+void c_mutex_init(c_Mutex *m);
+void c_mutex_lock(c_Mutex *m);
+// Gives back false instead of waiting if someone else holds it
+bool c_mutex_trylock(c_Mutex *m);
+void c_mutex_unlock(c_Mutex *m);
+void c_mutex_destroy(c_Mutex *m);
+
+void c_cond_init(c_Cond *c);
+// NOTE: Can wake up without a signal, so wait in a loop that checks the condition
+void c_cond_wait(c_Cond *c, c_Mutex *m);
+void c_cond_signal(c_Cond *c);
+void c_cond_broadcast(c_Cond *c);
+void c_cond_destroy(c_Cond *c);
+
+// Atomics
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// NOTE: The MSVC versions only work on 64-bit integers
+#define C_ATOMIC_LOAD(ptr)                   (_ReadWriteBarrier(), *(volatile __int64 *)(ptr))
+#define C_ATOMIC_STORE(ptr, val)             ((void)_InterlockedExchange64((volatile __int64 *)(ptr), (__int64)(val)))
+#define C_ATOMIC_FETCH_ADD(ptr, val)         _InterlockedExchangeAdd64((volatile __int64 *)(ptr), (__int64)(val))
+#define C_ATOMIC_EXCHANGE(ptr, val)          _InterlockedExchange64((volatile __int64 *)(ptr), (__int64)(val))
+#define C_ATOMIC_CAS(ptr, expected, desired) c_atomic_cas64((volatile __int64 *)(ptr), (__int64 *)(expected), (__int64)(desired))
+#define C_ATOMIC_FENCE()                     MemoryBarrier()
+static inline bool c_atomic_cas64(volatile __int64 *ptr, __int64 *expected, __int64 desired) {
+    __int64 prev = _InterlockedCompareExchange64(ptr, desired, *expected);
+    if (prev == *expected) return true;
+    *expected = prev;
+    return false;
+}
+#else
+#define C_ATOMIC_LOAD(ptr)                   __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define C_ATOMIC_STORE(ptr, val)             __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define C_ATOMIC_FETCH_ADD(ptr, val)         __atomic_fetch_add((ptr), (val), __ATOMIC_ACQ_REL)
+// Gives back the old value
+#define C_ATOMIC_EXCHANGE(ptr, val)          __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+// On failure `*expected` gets the current value
+#define C_ATOMIC_CAS(ptr, expected, desired) __atomic_compare_exchange_n((ptr), (expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+// Full (sequentially consistent) barrier
+#define C_ATOMIC_FENCE()                     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif // defined(_MSC_VER) && !defined(__clang__)
+
+//
+// Job pool
+//
+
+// One shared pool of worker threads, each with a work-stealing deque (Chase-Lev); Jobs pushed from
+// a worker go to its own deque and idle workers steal from the others, jobs from other threads go
+// through a shared queue. Workers waiting on a wait group run queued jobs instead of blocking, so it's
+// fine to wait from inside a job (that's how c_parallel_for() splits its work); Other threads sleep.
+// eg: ```C
+//     c_Wait_group wg = {0};
+//     c_Job jobs[2] = { { work, &a, &wg }, { work, &b, &wg } };
+//     c_pool_submit(&jobs[0]);
+//     c_pool_submit(&jobs[1]);
+//     c_wait_group_wait(&wg);
+//     ```
+typedef void (*c_Job_proc)(void *arg);
+
+typedef struct {
+    int64 pending;
+} c_Wait_group;
+
+typedef struct {
+    c_Job_proc proc;
+    void *arg;
+    c_Wait_group *wg; // may be NULL
+} c_Job;
+
+// Jobs per worker deque; Jobs pushed to a full deque run right away instead
+#define C_POOL_DEQUE_SIZE 4096
+
+// `n_workers` 0 means c_cpu_count().
+// NOTE: Started on first use if not started explicitly, and stopped at exit.
+bool c_pool_start(int n_workers);
+// NOTE: Wait for your jobs before stopping; Jobs still queued won't run.
+void c_pool_stop(void);
+int  c_pool_worker_count(void);
+// NOTE: `job` has to stay alive (and unchanged) until it ran; Adds 1 to job->wg.
+void c_pool_submit(c_Job *job);
+
+void c_wait_group_add(c_Wait_group *wg, int64 n);
+void c_wait_group_done(c_Wait_group *wg);
+void c_wait_group_wait(c_Wait_group *wg);
+
+// Calls `fn` on subranges of [0, count) in parallel and returns when all are done; Ranges are split in
+// halves until they're at most `grain` (0 picks one) items, idle workers steal the big halves first.
+typedef void (*c_Range_proc)(void *items, size_t begin, size_t end, void *ctx);
+void c_parallel_for(void *items, size_t count, size_t grain, c_Range_proc fn, void *ctx);
+#define c_darr_parallel_for(da, grain, fn, ctx) c_parallel_for((da).items, (da).count, (grain), (fn), (ctx))
+
+// Reduce in parallel: `map` folds items [begin, end) into `acc` (which starts as a copy of what `result`
+// holds on entry, so put the identity there), then the per-chunk results are `combine`d into `result`.
+// NOTE: Chunks only depend on `count` and `grain` and are combined in order, so the result is the same
+//       on any number of threads (even for floats).
+typedef void (*c_Reduce_proc)(void *items, size_t begin, size_t end, void *acc, void *ctx);
+typedef void (*c_Combine_proc)(void *acc, const void *other, void *ctx);
+#define C_PARALLEL_REDUCE_MAX_CHUNKS 1024
+void c_parallel_reduce(void *items, size_t count, size_t grain, c_Reduce_proc map, c_Combine_proc combine,
+                       void *result, size_t result_size, void *ctx);
 
 //
 // ## Data Structures
@@ -370,30 +929,165 @@ typedef struct c_String_array c_String_array;
 #include <sys/stat.h>
 #endif
 
-void c_os_get_timedate(c_Arena* a);
+// Local time as "YYYY-MM-DD HH:MM:SS", allocated from `a`.
+// NOTE: The formatting is only redone when the second changes.
+cstr c_os_get_timedate(c_Arena* a);
 bool c_os_file_exists(cstr filename);
+// Names of the regular files directly in `dir` (each one must be freed, as well as the array)
+// NOTE: Use c_dir_walk() to avoid the per-name allocations.
 c_String_array c_os_list_files(cstr dir);
 
+//
+// Time
+//
+
+// Nanoseconds from a monotonic clock (CLOCK_MONOTONIC / QueryPerformanceCounter); Only differences are meaningful.
+uint64 c_time_now_ns(void);
+// Cheap timestamp for hot paths: the TSC on x86 cpus with an invariant one, c_time_now_ns() elsewhere.
+// Use c_ticks_to_ns() on differences between them.
+uint64 c_time_ticks(void);
+uint64 c_ticks_to_ns(uint64 ticks);
+// Measures the TSC frequency against the monotonic clock (~10ms); Done on first use of c_ticks_to_ns() otherwise.
+void c_time_calibrate(void);
+
+typedef struct {
+    uint64 start;   // ticks
+    uint64 elapsed; // ticks, from the previous start/stop periods
+    bool running;
+} c_Stopwatch;
+
+void c_stopwatch_start(c_Stopwatch *sw);
+void c_stopwatch_stop(c_Stopwatch *sw);
+void c_stopwatch_reset(c_Stopwatch *sw);
+// Includes the running period if it's running
+uint64 c_stopwatch_elapsed_ns(const c_Stopwatch *sw);
+// Gives back the elapsed time and starts over
+uint64 c_stopwatch_lap_ns(c_Stopwatch *sw);
+
 //
 // Logging
 //
 
-#define c_log_error(fmt, ...) do {\
-		fprintf(stderr, "%s" fmt"\n", "[ERROR] ", ##__VA_ARGS__);\
-	} while (0)
-#define c_log_info(fmt, ...) do {\
-		fprintf(stdout, "%s" fmt"\n", "[INFO] ", ##__VA_ARGS__);\
-	} while (0)
-#define c_log_warning(fmt, ...) do {\
-		fprintf(stdout, "%s" fmt"\n", "[WARNING] ", ##__VA_ARGS__);\
-	} while (0)
+typedef enum {
+    C_LOG_DEBUG,
+    C_LOG_INFO,
+    C_LOG_WARNING,
+    C_LOG_ERROR, // goes to stderr, the rest to stdout
+    C_LOG_LEVEL_COUNT,
+    C_LOG_OFF = C_LOG_LEVEL_COUNT, // as a threshold
+} c_Log_level;
+
+// Runtime thresholds per module; A file picks its module by (re)defining C_LOG_MODULE:
+// eg: ```C
+//     static c_Log_module net_log = C_LOG_MODULE_INIT("net");
+//     #undef C_LOG_MODULE
+//     #define C_LOG_MODULE (&net_log)
+//     ...
+//     c_log_set_level("net", C_LOG_DEBUG);
+//     ```
+typedef struct {
+    const char *name;
+    int64 level;      // threshold set at runtime, -1 if none (C_LOG_DEFAULT_LEVEL)
+    int64 generation; // c_log_generation `level` was looked up at
+} c_Log_module;
+
+#define C_LOG_MODULE_INIT(name) { (name), -1, 0 }
+
+extern c_Log_module c_log_default_module;
+extern int64 c_log_generation;
+
+#ifndef C_LOG_MODULE
+#define C_LOG_MODULE (&c_log_default_module)
+#endif // C_LOG_MODULE
+
+// Threshold when nothing was set at runtime; c_log_debug() used to only exist with DEBUG
+// NOTE: c_log_debug() is always compiled now (and only filtered at runtime), so its arguments have to compile
+//       without DEBUG too; Code that used DEBUG-only variables or functions in them has to guard those calls itself.
+#ifndef C_LOG_DEFAULT_LEVEL
 #ifdef DEBUG
-#define c_log_debug(fmt, ...) do {\
-		fprintf(stdout, "%s"fmt"\n", "[DEBUG] ", ##__VA_ARGS__);\
-	} while (0)
+#define C_LOG_DEFAULT_LEVEL C_LOG_DEBUG
 #else
-#define c_log_debug(...)
+#define C_LOG_DEFAULT_LEVEL C_LOG_INFO
 #endif // DEBUG
+#endif // C_LOG_DEFAULT_LEVEL
+
+void c_log_module_refresh(c_Log_module *m);
+
+static inline int c_log_threshold(c_Log_module *m, int default_level) {
+    if (C_ATOMIC_LOAD(&m->generation) != C_ATOMIC_LOAD(&c_log_generation)) c_log_module_refresh(m);
+    return m->level >= 0 ? (int)m->level : default_level;
+}
+
+// NOTE: Checked before the log arguments are evaluated
+#define C_LOG_ENABLED(level) ((int)(level) >= c_log_threshold(C_LOG_MODULE, C_LOG_DEFAULT_LEVEL))
+
+// `module` NULL or "*" sets the threshold of every module that doesn't have its own.
+void c_log_set_level(cstr module, c_Log_level level);
+// Sets thresholds from a spec like "net=debug,db=off,*=warning" (eg: from an environment variable).
+bool c_log_configure(cstr spec);
+
+// Call site of a log macro; Parsed once so binary logging can store the arguments as is.
+#define C_BLOG_MAX_ARGS 16
+typedef struct {
+    const char *fmt;
+    c_Log_level level;
+    int64 id;        // 0 until the first binary write
+    int64 file_id;   // the binary log this site was last described in
+    uint8 arg_count;
+    uint8 args[C_BLOG_MAX_ARGS];
+} c_Log_site;
+
+#define C_LOG_AT(lvl, format, ...) do {\
+		if (C_LOG_ENABLED(lvl)) {\
+			static c_Log_site c_log_site_ = { .fmt = (format), .level = (lvl) };\
+			if (C_ATOMIC_LOAD(&c_blog_file_id) != 0) c_blog_write(&c_log_site_, ##__VA_ARGS__);\
+			else c_log_write((lvl), format, ##__VA_ARGS__);\
+		}\
+	} while (0)
+
+#define c_log_error(fmt, ...) C_LOG_AT(C_LOG_ERROR, "[ERROR] " fmt"\n", ##__VA_ARGS__)
+#define c_log_info(fmt, ...) C_LOG_AT(C_LOG_INFO, "[INFO] " fmt"\n", ##__VA_ARGS__)
+#define c_log_warning(fmt, ...) C_LOG_AT(C_LOG_WARNING, "[WARNING] " fmt"\n", ##__VA_ARGS__)
+#define c_log_debug(fmt, ...) C_LOG_AT(C_LOG_DEBUG, "[DEBUG] " fmt"\n", ##__VA_ARGS__)
+
+// What the macros above end up calling; Writes straight to stdout/stderr unless async logging is running.
+void c_log_write(c_Log_level level, const char *fmt, ...) C_PRINTF_LIKE(2, 3);
+void c_log_vwrite(c_Log_level level, const char *fmt, va_list args);
+
+// Binary logging: while a binary log is open, the log macros only store which call site it was and the raw
+// argument bytes (strings are copied); The text is rendered later with c_blog_decode().
+// NOTE: Runs on top of async logging (started if needed), so crash flushes only cover text logs.
+// NOTE: Supports every printf conversion except %n; Strings get cut to fit in C_BLOG_MAX_RECORD_SIZE.
+#define C_BLOG_MAX_RECORD_SIZE 1024
+extern int64 c_blog_file_id; // 0 while no binary log is open
+
+bool c_blog_open(cstr path);
+void c_blog_close(void);
+void c_blog_write(c_Log_site *site, ...);
+// Renders a binary log back to the text the log macros would have written.
+bool c_blog_decode(c_String_view data, c_String_builder *out);
+
+// Async logging: the calling thread only formats the message into its own lock-free ring,
+// and a background thread writes them out in big batches.
+// NOTE: Messages keep their order per thread, but not between threads.
+// NOTE: A thread whose ring is full blocks until the writer makes room, so logs are never dropped.
+// NOTE: A thread's ring is freed when the thread exits (or when it calls c_log_async_stop()).
+// NOTE: Anything written with printf() in the meantime can end up out of order with the logs.
+#ifndef C_LOG_RING_SIZE
+#define C_LOG_RING_SIZE (1 << 18) // bytes per thread, must be a power of 2
+#endif // C_LOG_RING_SIZE
+
+bool c_log_async_start(void);
+// Writes out everything that's left and goes back to synchronous logging; Also registered with atexit().
+void c_log_async_stop(void);
+// Blocks until everything logged so far is written
+void c_log_flush(void);
+// Installs handlers for SIGSEGV, SIGABRT, SIGBUS, SIGILL and SIGFPE that write out the queued logs before dying.
+void c_log_install_crash_handler(void);
+// For your own crash handlers; Only uses async-signal-safe calls.
+// NOTE: If the writer thread is in the middle of a batch (or the crash happened while logging) it writes the
+//       queued messages out anyway, so a few of them can come out twice.
+void c_log_crash_flush(void);
 //
 // File
 //
@@ -402,6 +1096,118 @@ c_String_array c_os_list_files(cstr dir);
 const char* c_read_file(const char* filename, int *file_size);
 void c_touch_file_if_doesnt_exist(cstr file);
 
+// Access pattern hints for c_map_file()
+#define C_MAP_SEQUENTIAL (1 << 0)
+#define C_MAP_WILLNEED   (1 << 1)
+#define C_MAP_RANDOM     (1 << 2)
+
+// Maps the whole file read-only without copying it; `data` is NULL on failure.
+// NOTE: The content is NOT NUL-terminated and '\r's are left as is.
+c_String_view c_map_file(cstr filename, int hints);
+void c_unmap_file(c_String_view sv);
+
+// Mapped Dynamic-Array: A Dynamic-Array whose items live in a file mapped read-write, so it can get bigger
+// than RAM and is still there when the file is opened again. It has the usual items/count/capacity plus a
+// `file` member, and only growing needs the c_mdarr_* macros; Indexing and loops work as with any darr.
+// eg: ```C
+//     typedef struct {
+//         float64 *items;
+//         size_t count;
+//         size_t capacity;
+//         c_Mdarr_file file;
+//     } Samples; // @mdarr
+//
+//     Samples s = {0};
+//     if (!c_mdarr_open(s, "samples.bin")) return 1;
+//     c_mdarr_append(s, 4.2);
+//     c_mdarr_close(s);
+//     ```
+// NOTE: The file starts with a C_MDARR_HEADER_SIZE header holding the item size and count, so it can't be
+//       opened with a different item type; Items are written as they are in memory (native endianness).
+// NOTE: c_mdarr_append() keeps the count in the file up to date; If you change `count` yourself,
+//       c_mdarr_sync() or c_mdarr_close() save it.
+#define C_MDARR_HEADER_SIZE 4096
+#define C_MDARR_MAGIC "CMDARR\0\0"
+#define C_MDARR_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32 version;
+    uint32 item_size;
+    uint64 count;
+} c_Mdarr_header;
+
+typedef struct {
+    void *base; // the header, then the items
+    size_t mapped_size;
+#if defined(_WIN32)
+    HANDLE handle;
+    HANDLE mapping;
+#else
+    int fd;
+#endif // defined(_WIN32)
+} c_Mdarr_file;
+
+#define c_mdarr_header(da) ((c_Mdarr_header *)(da).file.base)
+#define c_mdarr_items_(f) ((void *)((uint8 *)(f).base + C_MDARR_HEADER_SIZE))
+
+// Creates the file if it doesn't exist; Gives back false (and logs) if it can't be opened or mapped,
+// or if it isn't a mapped array of this item size.
+#define c_mdarr_open(da, path) \
+    (c_mdarr_open_impl(&(da).file, (path), sizeof(*(da).items), &(da).count, &(da).capacity) \
+        ? ((da).items = c_mdarr_items_((da).file), true) : false)
+// Grows the file (and the mapping) so at least `n` items fit; On failure `da` is left as it was.
+#define c_mdarr_reserve(da, n) \
+    (c_mdarr_reserve_impl(&(da).file, sizeof(*(da).items), &(da).capacity, (n)) \
+        ? ((da).items = c_mdarr_items_((da).file), true) : false)
+#define c_mdarr_append(da, elm) do {\
+        if ((da).count >= (da).capacity) {\
+            bool c_mdarr_grown_ = c_mdarr_reserve((da), (da).count + 1);\
+            C_ASSERT(c_mdarr_grown_, "Failed to grow the mapped array");\
+        }\
+        (da).items[(da).count++] = (elm);\
+        c_mdarr_header(da)->count = (da).count;\
+    } while (0)
+// Saves the count and flushes the changes to disk.
+#define c_mdarr_sync(da) c_mdarr_sync_impl(&(da).file, (da).count)
+// Saves the count, unmaps and closes; `da` is empty afterwards.
+#define c_mdarr_close(da) do {\
+        c_mdarr_close_impl(&(da).file, (da).count);\
+        (da).items = NULL;\
+        (da).count = 0;\
+        (da).capacity = 0;\
+    } while (0)
+
+bool c_mdarr_open_impl(c_Mdarr_file *f, cstr path, size_t item_size, size_t *count, size_t *capacity);
+bool c_mdarr_reserve_impl(c_Mdarr_file *f, size_t item_size, size_t *capacity, size_t n);
+bool c_mdarr_sync_impl(c_Mdarr_file *f, size_t count);
+void c_mdarr_close_impl(c_Mdarr_file *f, size_t count);
+
+// Streaming reader that hands out lines/records from a fixed, reusable buffer,
+// so files of any size can be processed in constant memory.
+// NOTE: The buffer only grows when a single line doesn't fit in it.
+// NOTE: Views returned by c_file_reader_next_*() are only valid until the next call.
+typedef struct {
+    FILE *f;
+    char *buff;
+    size_t capacity;
+    size_t start;   // start of the unconsumed data in buff
+    size_t scanned; // buff[start..scanned] is known to have no delimiter
+    size_t end;     // end of the data read into buff
+    bool eof;
+    bool failed;    // set if a read failed; next_*() returns false from then on
+} c_File_reader;
+
+#define C_FILE_READER_DEFAULT_BUFFER_SIZE (256*1024)
+
+// buffer_size of 0 uses C_FILE_READER_DEFAULT_BUFFER_SIZE
+bool c_file_reader_open(c_File_reader *r, cstr filename, size_t buffer_size);
+// Gives back the next line without the '\n' (or "\r\n"); false at the end of the file.
+bool c_file_reader_next_line(c_File_reader *r, c_String_view *line);
+// Gives back the next `delim` separated record without the delimiter; false at the end of the file.
+bool c_file_reader_next_record(c_File_reader *r, char delim, c_String_view *record);
+void c_file_reader_close(c_File_reader *r);
+
 //
 // ### Allocators ###
 //
@@ -451,16 +1257,18 @@ void c_arena_free(c_Arena* a);
 // String Builder
 //
 
-typedef struct {
+struct c_String_builder {
     char* items;
     size_t count;
     size_t capacity;
-} c_String_builder;
+};
 #define c_STRING_VIEW_INITIAL_CAPACITY c_DYNAMIC_ARRAY_INITIAL_CAPACITY
 
 void c_sb_append(c_String_builder* sb, char* data);
 void c_sb_append_char(c_String_builder* sb, char ch);
 void c_sb_append_null(c_String_builder *sb);
+// makes sure there is space for atleast `n` more bytes after sb->count
+void c_sb_reserve(c_String_builder *sb, size_t n);
 void c_sb_free(c_String_builder *sb);
 
 //
@@ -477,10 +1285,10 @@ struct c_String_array {
 // String view
 //
 
-typedef struct {
+struct c_String_view {
     char *data;
     size_t count;
-} c_String_view;
+};
 
 #define c_SV_FMT "%.*s"
 #define c_SV_ARG(sv) (int)(sv).count, (sv).data
@@ -513,6 +1321,7 @@ bool c_sv_is_hex_numbers(c_String_view sv);
 bool c_sv_equals(c_String_view sv1, c_String_view sv2);
 c_String_view c_sv_get_part(c_String_view sv, int from, int to);
 bool c_sv_lpop_arg(c_String_view *sv, c_String_view *out);
+size_t c_sv_count_char(c_String_view sv, char ch);
 
 //
 // String
@@ -520,504 +1329,3012 @@ bool c_sv_lpop_arg(c_String_view *sv, c_String_view *out);
 
 bool c_str_starts_with(const char *str, const char *suffix);
 
-#endif /* _COMMONLIB_H_ */
+//
+// Formatting
+//
 
-//////////////////////////////////////////////////
-#ifdef COMMONLIB_IMPLEMENTATION
-#include <string.h>
-#include <errno.h>
-#include <stdlib.h>
-#include <assert.h>
+void c_sb_append_sv(c_String_builder *sb, c_String_view sv);
+// Formats straight into the spare capacity of `sb`, growing and formatting again if it didn't fit.
+void c_sb_appendf(c_String_builder *sb, const char *fmt, ...) C_PRINTF_LIKE(2, 3);
+void c_sb_vappendf(c_String_builder *sb, const char *fmt, va_list args);
+void c_sb_append_int(c_String_builder *sb, int64 v);
+void c_sb_append_uint(c_String_builder *sb, uint64 v);
+// Digits that read back (strtod/strtof) to the same value, shortest for all but ~0.1% of values.
+// eg: 0.1, 1e+30, 100.0
+void c_sb_append_float64(c_String_builder *sb, float64 v);
+void c_sb_append_float32(c_String_builder *sb, float32 v);
+
+// Number formatting without printf; Each writes atmost C_FMT_NUMBER_MAX_SIZE chars (no NUL) and gives back the length.
+#define C_FMT_NUMBER_MAX_SIZE 32
+int c_fmt_int(int64 v, char *out);
+int c_fmt_uint(uint64 v, char *out);
+int c_fmt_float64(float64 v, char *out);
+int c_fmt_float32(float32 v, char *out);
 
-// My things implementation:
+//
+// Encoding (Hex, Base64)
+//
 
-// Global variables
+// NOTE: The encoders don't NUL-terminate `out`; Use these to size the buffers.
+#define C_HEX_ENCODED_SIZE(n)        ((n)*2)
+#define C_BASE64_ENCODED_SIZE(n)     ((((n) + 2) / 3) * 4)
+#define C_BASE64_DECODED_MAX_SIZE(n) (((n) / 4) * 3 + 2)
+
+// Returns the number of chars written to `out` (lowercase hex).
+size_t c_hex_encode(const void *data, size_t size, char *out);
+// Decodes and validates in the same pass; `out` needs atleast hex.count/2 bytes.
+// Returns false on odd length or a non-hex char, *out_size is the number of bytes decoded before that.
+bool c_hex_decode(c_String_view hex, void *out, size_t *out_size);
+// Standard alphabet with '=' padding.
+size_t c_base64_encode(const void *data, size_t size, char *out);
+// Accepts padded and unpadded input; `out` needs atleast C_BASE64_DECODED_MAX_SIZE(b64.count) bytes.
+bool c_base64_decode(c_String_view b64, void *out, size_t *out_size);
+void c_sb_append_hex(c_String_builder *sb, const void *data, size_t size);
+void c_sb_append_base64(c_String_builder *sb, const void *data, size_t size);
+// These leave `sb` untouched on invalid input.
+bool c_sb_append_hex_decoded(c_String_builder *sb, c_String_view hex);
+bool c_sb_append_base64_decoded(c_String_builder *sb, c_String_view b64);
 
 //
-// Math
+// Line index
 //
 
-int c_clampi(int v, int min, int max) {
-    v = v < min ? min : v;
-    v = v > max ? max : v;
-    return v;
-}
+// Offsets of the first char of every line in `text`, built in one pass.
+// NOTE: `text` is not copied, so it must outlive the index.
+typedef struct {
+    uint64 *items;
+    size_t count;
+    size_t capacity;
+    c_String_view text;
+} c_Line_index; // @darr
+
+c_Line_index c_line_index_build(c_String_view text);
+size_t c_line_index_count(const c_Line_index *li);
+// Gives back line `n` without the trailing '\n' (or "\r\n").
+c_String_view c_line_index_get(const c_Line_index *li, size_t n);
+// Gives back the line number of the line containing the byte at `offset`.
+size_t c_line_index_find(const c_Line_index *li, size_t offset);
+// Splits the lines into `n_chunks` chunks of (within one) the same number of lines.
+// NOTE: None of them are empty as long as there are at least `n_chunks` lines.
+c_String_view c_line_index_chunk(const c_Line_index *li, size_t chunk, size_t n_chunks);
+void c_line_index_free(c_Line_index *li);
 
-float c_clampf(float v, float min, float max) {
-    v = v < min ? min : v;
-    v = v > max ? max : v;
-    return v;
-}
+//
+// Hashing
+//
 
-float c_randomf(float from, float to) {
-	float r = (float)rand() / (float)RAND_MAX;
-	return from + (to - from) * r;
-}
+// Non-cryptographic 64-bit hash based on wyhash (final4).
+// NOTE: Reads are in host byte order, so don't compare hashes across big and little endian machines.
+uint64 c_hash(const void *data, size_t size, uint64 seed);
+uint64 c_sv_hash(c_String_view sv, uint64 seed);
 
-int c_randomi(int from, int to) {
-	return c_randomf((float)from, (float)to);
-}
+// Two independent 64-bit lanes, for content addressing where 64 bits is too collision prone.
+typedef struct {
+    uint64 lo;
+    uint64 hi;
+} c_Hash128;
 
-float c_mapf(float value, float from1, float to1, float from2, float to2) {
-    value /= (to1 - from1);
-    value *= (to2 - from2);
-    value += from2;
+c_Hash128 c_hash128(const void *data, size_t size, uint64 seed);
+c_Hash128 c_sv_hash128(c_String_view sv, uint64 seed);
 
-    return value;
-}
+// Streaming interface; Feeding the data in pieces gives the same hash as c_hash()/c_hash128() on all of it.
+typedef struct {
+    uint64 lanes[2][3];
+    uint64 seed;
+    uint64 size;
+    bool wide;
+    bool consumed_blocks;
+    // 16 bytes of already consumed data followed by upto 48 pending bytes
+    uint8 buff[16 + 48];
+    size_t pending;
+} c_Hash_state;
+
+void c_hash_init(c_Hash_state *h, uint64 seed);
+void c_hash128_init(c_Hash_state *h, uint64 seed);
+void c_hash_update(c_Hash_state *h, const void *data, size_t size);
+uint64 c_hash_final(const c_Hash_state *h);
+// `h` must have been initialized with c_hash128_init()
+c_Hash128 c_hash128_final(const c_Hash_state *h);
 
-float c_ease_in_sine(float t) {
-	return 1 - cosf((t * C_PI) / 2.f);
-}
+//
+// UTF-8
+//
 
-float c_ease_out_sine(float t) {
-	return sinf((t * C_PI) / 2);
-}
+#define C_UTF8_REPLACEMENT_CHAR 0xFFFD
+
+// Checks for truncated sequences, overlongs, surrogates and codepoints above U+10FFFF.
+// *error_offset (can be NULL) is set to the offset of the first invalid sequence.
+bool c_utf8_validate(c_String_view sv, size_t *error_offset);
+// NOTE: These two expect valid UTF-8.
+size_t c_utf8_count_codepoints(c_String_view sv);
+size_t c_utf8_utf16_length(c_String_view sv);
+// Transcoders validate as they go and return false on invalid UTF-8.
+// `out` needs c_utf8_count_codepoints(sv) and c_utf8_utf16_length(sv) slots respectively.
+bool c_utf8_to_utf32(c_String_view sv, uint32 *out, size_t *out_count);
+bool c_utf8_to_utf16(c_String_view sv, uint16 *out, size_t *out_count);
+// Writes `codepoint` as 1-4 bytes into `out` and gives back the number of bytes.
+int c_utf8_encode(uint32 codepoint, char out[4]);
+// Pops one codepoint off the front of `sv`; An invalid sequence gives back
+// C_UTF8_REPLACEMENT_CHAR and pops a single byte. Returns false when `sv` is empty.
+bool c_sv_lpop_codepoint(c_String_view *sv, uint32 *codepoint);
+// UTF-16 where wchar is 2 bytes (Windows), UTF-32 otherwise. NULL on invalid UTF-8.
+// (caller must be responsible for freeing the string!)
+wchar *c_sv_to_wstr(c_String_view sv);
+void c_sb_append_codepoint(c_String_builder *sb, uint32 codepoint);
 
-float c_ease_in_out_sine(float t) {
-	return -(cosf(C_PI * t) - 1) / 2;
-}
+//
+// String rope
+//
 
-float c_ease_out_bounce(float x) {
-	const float n1 = 7.5625;
-	const float d1 = 2.75;
-
-	if (x < 1 / d1) {
-		return n1 * x * x;
-	} else if (x < 2 / d1) {
-		return n1 * (x - 1.5 / d1) * x + 0.75;
-	} else if (x < 2.5 / d1) {
-		return n1 * (x - 2.25 / d1) * x + 0.9375;
-	} else {
-		return n1 * (x - 2.625 / d1) * x + 0.984375;
-	}
-}
+// A builder made of fixed size segments that never move, so growing it never copies what's already written.
+// With a valid `fd`, full segments are written out (writev) once `flush_threshold` bytes are buffered,
+// keeping the memory bounded while the output is still being generated.
+typedef struct {
+    char *data;
+    size_t count;
+} c_Rope_segment;
 
-float c_ease_in_bounce(float t) {
-	return 1 - c_ease_out_bounce(1 - t);
-}
+typedef struct {
+    c_Rope_segment *items;
+    size_t count;
+    size_t capacity;
+
+    char **free_segments;
+    size_t free_count;
+
+    size_t segment_size;
+    size_t flush_threshold;
+    int fd;           // -1 to only buffer in memory
+    size_t buffered;  // bytes currently in the segments
+    uint64 written;   // bytes written to `fd` so far
+    bool failed;      // a write to `fd` failed, everything after that is dropped
+} c_String_rope; // @darr
+
+#define C_ROPE_DEFAULT_SEGMENT_SIZE (64*1024)
+
+// pass 0 for segment_size/flush_threshold to get C_ROPE_DEFAULT_SEGMENT_SIZE and 16 segments
+c_String_rope c_rope_make(int fd, size_t segment_size, size_t flush_threshold);
+void c_rope_append(c_String_rope *r, const void *data, size_t size);
+void c_rope_append_sv(c_String_rope *r, c_String_view sv);
+void c_rope_appendf(c_String_rope *r, const char *fmt, ...) C_PRINTF_LIKE(2, 3);
+// Writes everything buffered (even the partially filled segment) to `fd`.
+bool c_rope_flush(c_String_rope *r);
+// Copies everything buffered into `sb` (for ropes without an fd).
+void c_rope_to_sb(const c_String_rope *r, c_String_builder *sb);
+// NOTE: Doesn't flush and doesn't close `fd`.
+void c_rope_free(c_String_rope *r);
 
 //
-// OS
+// Batch file loading
 //
 
-#if defined(_WIN32) || defined(__CYGWIN__)
-void c_os_get_timedate(c_Arena* a) {
-        (void)a;
-        C_ASSERT(false, "Unimplemented!");
-}
+typedef struct {
+    cstr path;
+    c_String_view content; // NUL-terminated, points into the arena passed to c_load_files()
+    int error;             // 0 if loaded, an errno value otherwise
+} c_File_load;
 
-bool c_os_file_exists(cstr filename) {
-    return PathFileExistsA(filename);
-}
+// Loads all the files concurrently on `n_threads` threads (<= 0 picks a count that suits I/O).
+// All the contents are put in a single allocation from `a`. Returns the number of files loaded.
+// NOTE: Unlike c_read_file(), contents are read in binary mode ('\r's are kept).
+size_t c_load_files(c_File_load *files, size_t count, c_Arena *a, int n_threads);
 
-c_String_array c_os_list_files(cstr dir) {
-    c_String_array res = {0};
-    C_ASSERT(false, "UNIMPLEMENTED!");
-    return res;
-}
+//
+// File writer
+//
 
-#elif defined(__linux__)
-#include <stdio.h>
-#include <stdlib.h>
-#include <dirent.h>
-#include <sys/stat.h>
-#include <string.h>
+// Write to a temp file next to `path` and only rename it over `path` on c_file_writer_close(),
+// so readers see either the old or the complete new file. The new file keeps the permissions of the one it replaces.
+// NOTE: On windows the attributes of the replaced file aren't carried over.
+#define C_WRITE_ATOMIC (1 << 0)
+// Bypass the page cache (O_DIRECT) for huge outputs; silently falls back where it isn't supported.
+// NOTE: glibc only defines O_DIRECT with _GNU_SOURCE defined before the first #include.
+#define C_WRITE_DIRECT (1 << 1)
 
-void c_os_get_timedate(c_Arena* a) {
-        (void)a;
-        C_ASSERT(false, "Unimplemented!");
-}
+#define C_FILE_WRITER_DEFAULT_BUFFER_SIZE (1024*1024)
+#define C_FILE_WRITER_ALIGNMENT 4096
 
-bool c_os_file_exists(cstr filename) {
-        struct stat buf;
-        return stat(filename, &buf) == 0;
-}
+typedef struct {
+    int fd;
+    char *buff;       // aligned to C_FILE_WRITER_ALIGNMENT
+    void *buff_mem;   // what was actually allocated for `buff`
+    size_t count;
+    size_t capacity;
+    int flags;
+    bool direct;      // O_DIRECT is currently on for `fd`
+    bool failed;      // a write failed; everything after that is dropped
+    uint64 written;   // bytes written to `fd` so far
+    char *path;
+    char *tmp_path;   // NULL unless C_WRITE_ATOMIC
+} c_File_writer;
+
+// buffer_size of 0 uses C_FILE_WRITER_DEFAULT_BUFFER_SIZE; The file is created/truncated.
+bool c_file_writer_open(c_File_writer *w, cstr path, int flags, size_t buffer_size);
+// Writes bigger than the buffer go straight to the file without being copied.
+bool c_file_writer_write(c_File_writer *w, const void *data, size_t size);
+bool c_file_writer_write_sv(c_File_writer *w, c_String_view sv);
+bool c_file_writer_write_sb(c_File_writer *w, const c_String_builder *sb);
+bool c_file_writer_writef(c_File_writer *w, const char *fmt, ...) C_PRINTF_LIKE(2, 3);
+bool c_file_writer_flush(c_File_writer *w);
+// Flushes and closes the file; With C_WRITE_ATOMIC also fsyncs and renames it over `path`.
+// Returns false if anything failed, in which case an atomic writer leaves `path` untouched.
+bool c_file_writer_close(c_File_writer *w);
 
-c_String_array c_os_list_files(cstr dir) {
-    c_String_array res = {0};
-    struct dirent *entry;
-    struct stat fileStat;
-    DIR *dp = opendir(dir);
+//
+// Directory walker
+//
 
-    // Check if the directory can be opened
-    if (dp == NULL) {
-        perror("opendir");
-        return res;
-    }
+typedef enum {
+    C_DIR_ENTRY_FILE,
+    C_DIR_ENTRY_DIR,
+    C_DIR_ENTRY_LINK,  // symlinks are reported, never followed
+    C_DIR_ENTRY_OTHER,
+} c_Dir_entry_type;
 
-    // Read entries from the directory
-    while ((entry = readdir(dp)) != NULL) {
-        // Get the file status
-        if (stat(entry->d_name, &fileStat) == -1) {
-            perror("stat");
-            continue;
-        }
-        
-        // Check if it is a regular file
-        if (S_ISREG(fileStat.st_mode)) {
-            char *item = strdup(entry->d_name);
-            c_darr_append(res, item);
-            // printf("%s\n", item);
-        }
-    }
+typedef struct {
+    size_t path_offset; // into c_Dir_walk.names; the path is NUL-terminated and relative to the walked dir (eg: "src/main.c")
+    uint32 name_offset; // where the last component starts in the path
+    c_Dir_entry_type type;
+} c_Dir_entry;
 
-    // Close the directory
-    closedir(dp);
+// All the paths live in one buffer, so a walk does no per-entry allocations.
+typedef struct {
+    c_Dir_entry *items;
+    size_t count;
+    size_t capacity;
+    c_String_builder names;
+} c_Dir_walk; // @darr
 
-    return res;
-}
-#endif
+// Return false to leave the entry out (a directory that is left out isn't walked either).
+// NOTE: With C_WALK_THREADED it is called from several threads at once, so it (and `user`) has to be thread-safe.
+typedef bool (*c_Dir_filter)(cstr path, cstr name, c_Dir_entry_type type, void *user);
 
-// simple and dirty way to have defering in C (not recommended to use!)
-#define defer(ret_val) \
-    result = ret_val;\
-    goto defer
+#define C_WALK_RECURSIVE (1 << 0)
+// Walks subdirectories on multiple threads (implies C_WALK_RECURSIVE); The entries come out in no particular order.
+// NOTE: Not implemented on windows yet, where it is just C_WALK_RECURSIVE on the calling thread.
+#define C_WALK_THREADED  (1 << 1)
 
-const char *c_read_file(const char* filename, int *file_size) {
-    FILE* f = fopen(filename, "r");
-    char* result = NULL;
+// Appends the entries in `dir` to `walk`; `filter` can be NULL. Returns false if `dir` can't be opened.
+// NOTE: Subdirectories that can't be opened (eg: no permission) are skipped.
+bool c_dir_walk(c_Dir_walk *walk, cstr dir, int flags, c_Dir_filter filter, void *user);
+cstr c_dir_entry_path(const c_Dir_walk *walk, const c_Dir_entry *e);
+cstr c_dir_entry_name(const c_Dir_walk *walk, const c_Dir_entry *e);
+void c_dir_walk_free(c_Dir_walk *walk);
 
-    if (f == NULL){
-        c_log_error("'%s': %s", filename, strerror(errno));
-        defer(NULL);
-    }
+//
+// File watcher
+//
 
-    if (fseek(f, 0, SEEK_END) < 0) {
-        c_log_error("'%s': %s", filename, strerror(errno));
-        defer(NULL);
-    }
+// What happened to a path; A path that changed more than once in a batch gets all the bits or-ed together.
+#define C_WATCH_CREATED  (1 << 0)
+#define C_WATCH_MODIFIED (1 << 1)
+#define C_WATCH_DELETED  (1 << 2)
+// Renamed; Comes with C_WATCH_DELETED on the old path and C_WATCH_CREATED on the new one.
+#define C_WATCH_MOVED    (1 << 3)
+// The kernel queue overflowed and events were lost; Rescan everything (the path is "").
+#define C_WATCH_OVERFLOW (1 << 4)
 
-    size_t fsize = ftell(f);
+// Also watch all the subdirectories, including ones created later
+#define C_WATCH_RECURSIVE (1 << 0)
 
-    if (fsize == (size_t)-1){
-        c_log_error("'%s': %s", filename, strerror(errno));
-        defer(NULL);
-    }
+typedef struct {
+    size_t path_offset; // into c_Watch_events.names
+    int events;         // C_WATCH_* bits
+    bool is_dir;
+} c_Watch_event;
 
-    result = C_MALLOC(sizeof(char)*(fsize+1));
+typedef struct {
+    c_Watch_event *items;
+    size_t count;
+    size_t capacity;
+    c_String_builder names;
+} c_Watch_events; // @darr
 
-    if (result == NULL){
-        c_log_error("'%s': %s", filename, strerror(errno));
-        defer(NULL);
-    }
+typedef struct {
+    int wd;             // the inotify watch descriptor
+    size_t path_offset; // into c_Watch.paths
+    bool recursive;
+    bool rearm;         // a file watched on its own, see c_os_watch_add()
+} c_Watch_target;
 
-    if (fseek(f, 0, SEEK_SET) < 0) {
-        c_log_error("'%s': %s", filename, strerror(errno));
-        defer(NULL);
-    }
+typedef struct {
+    c_Watch_target *items;
+    size_t count;
+    size_t capacity;
+} c_Watch_targets; // @darr
 
-    size_t read = fread((char*)result, sizeof(char), fsize, f);
+typedef struct {
+    int fd;                  // pollable, if you want to wait on it yourself
+    c_String_builder paths;  // every watched path, NUL-terminated
+    size_t paths_unused;     // bytes of `paths` no target points to anymore, compacted once it's half
+    c_Watch_targets targets; // sorted by wd
+    uint32 *table;           // path -> event index + 1, to coalesce events within a batch
+    size_t table_size;
+} c_Watch;
+
+// NOTE: Only implemented on Linux (inotify); Everywhere else these log an error and return false.
+bool c_os_watch_init(c_Watch *w);
+// `path` can be a file or a directory; Directories report changes to the files directly in them.
+// A file that is replaced (eg: an editor saving through a temp file and a rename) is watched again, which
+// shows up as C_WATCH_DELETED | C_WATCH_CREATED on its path; If nothing took its place the watch is gone.
+// Renamed subdirectories of a C_WATCH_RECURSIVE watch keep being reported under their new path; Ones moved
+// out of the watched tree stop being watched.
+bool c_os_watch_add(c_Watch *w, cstr path, int flags);
+// Waits atmost `timeout_ms` (-1 to wait forever, 0 to not wait) for changes and gives back
+// everything that is queued as one batch with one event per path. `events` is cleared first.
+bool c_os_watch_poll(c_Watch *w, c_Watch_events *events, int timeout_ms);
+void c_os_watch_close(c_Watch *w);
+cstr c_watch_event_path(const c_Watch_events *events, const c_Watch_event *e);
+void c_watch_events_free(c_Watch_events *events);
 
-    // Process the result to remove '\r' characters
-    char* cleaned_result = malloc(read + 1); // Allocate memory for cleaned result
-    if (cleaned_result == NULL) {
-        fprintf(stderr, "Memory allocation failed\n");
-        free(result);
-        return NULL;
-    }
+//
+// Profiler
+//
 
-    size_t j = 0; // Index for cleaned_result
-    for (size_t i = 0; i < read; i++) {
-        if (result[i] != '\r') { // Skip '\r' characters
-            cleaned_result[j++] = result[i];
-        }
-    }
-    cleaned_result[j] = '\0'; // Null-terminate the cleaned result
+// Define COMMONLIB_PROFILE to enable these, otherwise they compile to nothing.
+// NOTE: `name` must outlive the profiler (string literals are the way to go).
+// eg: ```C
+//     C_PROFILE_BEGIN("update");
+//         C_PROFILE_BEGIN("physics");
+//         ...
+//         C_PROFILE_END();
+//     C_PROFILE_END();
+//     ```
+#ifdef COMMONLIB_PROFILE
+#define C_PROFILE_BEGIN(name) c_profile_begin(name)
+#define C_PROFILE_END()       c_profile_end()
+#else
+#define C_PROFILE_BEGIN(name) ((void)0)
+#define C_PROFILE_END()       ((void)0)
+#endif // COMMONLIB_PROFILE
 
-    free(result); // Free the original result
-    *file_size = (int)j; // Update the file size without '\r'
-    return cleaned_result; // Return the cleaned result
+// Events per thread that can be recorded between two flushes; more than that are dropped.
+#ifndef C_PROFILE_RING_SIZE
+#define C_PROFILE_RING_SIZE (1 << 16)
+#endif // C_PROFILE_RING_SIZE
 
-    *file_size = (int)read;
+typedef struct {
+    const char *name;
+    uint64 calls;
+    uint64 total_ns; // NOTE: Recursive zones count the nested calls again
+    uint64 self_ns;  // total minus the time spent in nested zones
+} c_Profile_stat;
 
- defer:
-    if (f) fclose(f);
-    if (result == NULL) *file_size = -1;
-    return result;
-}
+typedef struct {
+    c_Profile_stat *items;
+    size_t count;
+    size_t capacity;
+} c_Profile_stats; // @darr
 
-void c_touch_file_if_doesnt_exist(cstr filename) {
-        if (c_os_file_exists(filename)) return;
-        FILE* file = fopen(filename, "w");
-        if (file) fclose(file);
-}
+void c_profile_begin(const char *name);
+void c_profile_end(void);
+
+// These collect everything recorded so far by all threads; Zones that haven't ended yet are left out.
+// Writes the Chrome trace_event JSON (open it in Perfetto or chrome://tracing).
+bool c_profile_write_trace(cstr path);
+// Gives back the stats per zone name, sorted by self time (highest first).
+void c_profile_summary(c_Profile_stats *stats);
+void c_profile_print_summary(FILE *stream);
+// Forgets everything collected so far
+void c_profile_reset(void);
 
 //
-// ### Allocators ###
+// Benchmarks
 //
 
-// c_Arena
+// `fn` should run the measured code `iters` times. The iteration count is doubled until a run is long
+// enough to time and then scaled to `sample_ns`, a few warmup samples are thrown away, and the rest are
+// timed with c_time_ticks().
+// eg: ```C
+//     void count_lines(uint64 iters, void *ctx) {
+//         c_String_view *sv = ctx;
+//         for (uint64 i = 0; i < iters; ++i) C_BENCH_KEEP(c_sv_count_char(*sv, '\n'));
+//     }
+//     ...
+//     c_Bench_result r = c_bench_run("sv/count_char", count_lines, &sv, &(c_Bench_options){ .bytes_per_iter = sv.count });
+//     c_bench_print(stdout, &r);
+//     ```
+typedef void (*c_Bench_proc)(uint64 iters, void *ctx);
 
-c_Arena c_arena_make(size_t size) {
-    c_Arena res = {0};
-    res.buff_size = size == 0 ? ARENA_BUFF_INITIAL_SIZE : size;
-    res.buff = C_MALLOC(res.buff_size);
-    res.ptr = res.buff;
+#define C_BENCH_SAMPLE_NS 2000000ull
+#define C_BENCH_WARMUP    3
+#define C_BENCH_SAMPLES   31
 
-    C_ASSERT(res.buff, "Malloc failed?");
+// Zero for the defaults above
+typedef struct {
+    uint64 bytes_per_iter; // 0 leaves out the throughput
+    uint64 sample_ns;      // how long one sample should take
+    int warmup;            // negative for none
+    int samples;
+} c_Bench_options;
 
-    return res;
-}
+// Times are per iteration
+typedef struct {
+    const char *name;
+    uint64 iters; // per sample
+    int samples;
+    float64 min_ns;
+    float64 median_ns;
+    float64 p99_ns;
+    float64 ticks;         // median in c_time_ticks() units (TSC reference cycles on x86)
+    float64 bytes_per_sec; // from the median
+} c_Bench_result;
+
+// Keeps the compiler from throwing away the computation of `value` (an integer or a pointer) and
+// from assuming what's in memory, respectively.
+#if defined(__GNUC__) || defined(__clang__)
+#define C_BENCH_KEEP(value) do { __typeof__(value) c_bench_kept_ = (value); __asm__ __volatile__("" : : "r,m"(c_bench_kept_) : "memory"); } while (0)
+#define C_BENCH_CLOBBER() __asm__ __volatile__("" : : : "memory")
+#else
+extern volatile uint64 c_bench_sink;
+#define C_BENCH_KEEP(value) do { c_bench_sink = (uint64)(size_t)(value); } while (0)
+#define C_BENCH_CLOBBER() _ReadWriteBarrier()
+#endif // defined(__GNUC__) || defined(__clang__)
+
+// `opts` can be NULL; `name` is kept in the result, not copied.
+c_Bench_result c_bench_run(const char *name, c_Bench_proc fn, void *ctx, const c_Bench_options *opts);
+// One tab-separated line per result so runs can be diffed against a baseline (see bench.sh);
+// The header line starts with a '#'.
+void c_bench_print_header(FILE *stream);
+void c_bench_print(FILE *stream, const c_Bench_result *r);
 
-void* c_arena_alloc(c_Arena* a, size_t size) {
-    C_ASSERT(a->buff, "Bro pass an initialized arena!");
+//
+// Allocation tracking
+//
 
-    void* res = a->ptr;
-    a->ptr = (uint8*)a->ptr + size;
+// With COMMONLIB_TRACK_ALLOCS defined, every C_MALLOC/C_CALLOC/C_REALLOC is recorded under the
+// __FILE__/__LINE__ it was called from (for c_darr_append() and the like that's where the macro was used),
+// and leaks are printed to stderr at exit.
+// NOTE: Only what went through those macros is seen; Pointers the tracker doesn't know are freed as is,
+//       and tracked ones freed with plain free() just show up as leaks.
+typedef struct {
+    const char *file;
+    int line;
+    uint64 live_bytes;
+    uint64 peak_bytes; // most live at once
+    uint64 live_count;
+    uint64 total_count; // reallocs count again
+    uint64 total_bytes;
+} c_Alloc_site;
 
-    bool free_block_found = false;
+typedef struct {
+    c_Alloc_site *items;
+    size_t count;
+    size_t capacity;
+} c_Alloc_sites; // @darr
 
-    // TODO: Check if there is a free block that can fit this
-    for (size_t i = 0; i < a->free_blocks.count; ++i) {
-        c_Mem_block free_block = a->free_blocks.items[i];
+// Gives back the stats per call site, sorted by peak bytes (highest first).
+void c_alloc_summary(c_Alloc_sites *sites);
+void c_alloc_print_report(FILE *stream);
+// Prints the sites that still have live allocations and gives back how many there are.
+uint64 c_alloc_print_leaks(FILE *stream);
 
-        if (free_block.size >= size) {
-            res = free_block.mem;
+//
+// Arena snapshots
+//
 
-            size_t diff = free_block.size - size;
+// Self-relative pointer: the distance from where it's stored to what it points at (0 for NULL), so it stays
+// right when the memory holding both moves (a c_Arena that grew, a snapshot mapped somewhere else).
+// NOTE: Can't point at itself.
+typedef int64 c_Rel_ptr;
 
-            c_darr_remove_unordered(a->free_blocks, i);
+static inline void c_rel_ptr_set(c_Rel_ptr *rp, const void *target) {
+    *rp = target ? (int64)((const uint8 *)target - (const uint8 *)rp) : 0;
+}
 
-            if (diff > 0) {
-                c_Mem_block residue_block = {
-                    .mem = (uint8 *)free_block.mem + size,
-                    .size = diff,
-                };
+static inline void *c_rel_ptr_get(const c_Rel_ptr *rp) {
+    return *rp ? (void *)((const uint8 *)rp + *rp) : NULL;
+}
 
-                c_darr_append(a->free_blocks, residue_block);
-            }
+// c_arena_alloc() can move the whole buffer when it grows, so hold on to offsets while building.
+// NOTE: It doesn't align either, round sizes up yourself to keep c_Rel_ptrs 8-byte aligned.
+#define c_arena_offset(a, p) ((size_t)((uint8 *)(p) - (uint8 *)(a)->buff))
+#define c_arena_at(a, offset) ((void *)((uint8 *)(a)->buff + (offset)))
 
-            free_block_found = true;
-            break;
-        }
-    }
+// A snapshot is the used part of an arena behind a header, written with C_WRITE_ATOMIC and mapped back
+// as is by c_arena_snapshot_load(): nothing is copied or fixed up, so everything in it that points at
+// something else in it has to be a c_Rel_ptr (or an offset).
+// NOTE: Snapshots are read-only once loaded, and only load on machines with the same endianness and
+//       struct layout.
+#define C_ARENA_SNAPSHOT_MAGIC "CARENA\0\0"
+#define C_ARENA_SNAPSHOT_VERSION 1
+#define C_ARENA_SNAPSHOT_HEADER_SIZE 64 // the data after it stays 64-byte aligned in the mapping
 
+typedef struct {
+    char magic[8];
+    uint32 version;
+    uint32 header_size;
+    uint64 size;     // bytes of data after the header
+    uint64 root;     // offset of the root in the data, UINT64_MAX for none
+    uint64 checksum; // c_hash() of the data
+} c_Arena_snapshot_header;
 
-    if (!free_block_found) {
-        size_t diff = (size_t)((uint8*)a->ptr - (uint8*)a->buff);
-        if (diff > a->buff_size) {
-            c_log_info("c_Arena resized from %zu to %zu", a->buff_size, a->buff_size*2);
-            a->buff_size *= 2;
-            a->buff = C_REALLOC(a->buff, a->buff_size);
-            a->ptr = (uint8*)a->buff + diff;
-            res = a->ptr;
-            // TODO: Do we need to do this?
-            a->ptr = (uint8*)a->ptr + size;
-        }
-        /* C_ASSERT((size_t)((uint8*)a->ptr - (uint8*)a->buff) <= a->buff_size); */
-    }
+typedef struct {
+    c_String_view file; // the whole mapping
+    void *data;         // where the arena's buffer starts
+    size_t size;
+    void *root;
+} c_Arena_snapshot;
 
-    c_Mem_block block = {
-        .mem = res,
-        .size = size,
-    };
+// `root` (NULL or something in `a`) is what c_arena_snapshot_load() hands back as the way in.
+bool c_arena_save(const c_Arena *a, const void *root, cstr path);
+// Checking the checksum reads everything, so skip `verify` for files you trust to keep loading instant.
+bool c_arena_snapshot_load(c_Arena_snapshot *s, cstr path, bool verify);
+void c_arena_snapshot_unload(c_Arena_snapshot *s);
 
-    c_darr_append(a->alloced_blocks, block);
+//
+// Compression
+//
 
-    return res;
-}
+// LZ4-style compression: greedy matching with a small hash table, byte-aligned output, no entropy coding;
+// It compresses at hundreds of MB/s and decompresses at GB/s.
+// Blocks use the LZ4 block format, so other LZ4 implementations can read them (and the other way around).
+
+// Worst case compressed size of `size` bytes (incompressible data grows a little).
+#define c_lz_compress_bound(size) ((size) + (size) / 255 + 16)
+// Gives back the compressed size, 0 if it doesn't fit in `dst_capacity`.
+size_t c_lz_compress_block(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+// Gives back the decompressed size, -1 if the data is corrupted or doesn't fit in `dst_capacity`.
+// NOTE: Safe on any input; It never reads or writes out of the given buffers.
+int64 c_lz_decompress_block(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+// Frames hold any amount of data: "CLZ\x01", the block size (uint32), then for each block its size (uint32,
+// the high bit set for blocks stored as is) and its data, a 0 size and the c_hash() of the content (uint64).
+// Numbers are little-endian; Blocks are compressed on their own.
+#define C_LZ_FRAME_MAGIC "CLZ\x01"
+#define C_LZ_BLOCK_SIZE (256 * 1024)
+#define C_LZ_MAX_BLOCK_SIZE (64 * 1024 * 1024) // for the decoder, so a bad header can't ask for anything
 
-void c_arena_dealloc(c_Arena *a, void *mem) {
-    C_ASSERT(a->buff, "Bro pass an initialized arena!");
+typedef struct {
+    c_String_builder *out;
+    char *block; // input waiting for a whole block
+    size_t block_count;
+    c_Hash_state hash;
+} c_Lz_encoder;
+
+// Each of these appends to `out`, so it can be written out (and emptied) between calls.
+void c_lz_encoder_begin(c_Lz_encoder *e, c_String_builder *out);
+void c_lz_encoder_write(c_Lz_encoder *e, c_String_view data);
+// Compresses what's left and finishes the frame.
+void c_lz_encoder_end(c_Lz_encoder *e);
 
-    for (size_t i = 0; i < a->alloced_blocks.count; ++i) {
-        c_Mem_block block = a->alloced_blocks.items[i];
+typedef struct {
+    c_String_builder pending; // input that isn't a whole block yet
+    size_t block_size;
+    c_Hash_state hash;
+    int state;
+} c_Lz_decoder;
+
+void c_lz_decoder_begin(c_Lz_decoder *d);
+// Feed the frame in pieces of any size; Decompressed data is appended to `out` a block at a time.
+// Gives back false (and logs) if the frame is corrupted, the decoder is useless after that.
+bool c_lz_decoder_feed(c_Lz_decoder *d, c_String_view in, c_String_builder *out);
+// Whether the whole frame came in and the checksum matched
+bool c_lz_decoder_done(const c_Lz_decoder *d);
+void c_lz_decoder_free(c_Lz_decoder *d);
+
+// One whole frame, appended to `out`
+void c_lz_compress(c_String_view src, c_String_builder *out);
+bool c_lz_decompress(c_String_view src, c_String_builder *out);
 
-        if (block.mem == mem) {
-            c_darr_append(a->free_blocks, block);
-            c_darr_remove_unordered(a->alloced_blocks, i);
-            return;
-        }
+#endif /* _COMMONLIB_H_ */
+
+//////////////////////////////////////////////////
+#ifdef COMMONLIB_IMPLEMENTATION
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <assert.h>
+
+// My things implementation:
+
+// Global variables
+
+// Bit helpers
+// NOTE: `x` must not be 0
+static inline int c_ctz32(uint32 x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, x);
+    return (int)idx;
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n++;
     }
+    return n;
+#endif
 }
 
-void c_arena_reset(c_Arena* a) {
-    a->ptr = a->buff;
+// NOTE: `x` must not be 0
+static inline int c_ctz64(uint64 x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return (int)idx;
+#else
+    uint32 lo = (uint32)x;
+    return lo ? c_ctz32(lo) : 32 + c_ctz32((uint32)(x >> 32));
+#endif
 }
 
-void c_arena_free(c_Arena* a) {
-    C_FREE(a->buff);
+static inline int c_popcount32(uint32 x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    return (int)((((x + (x >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#endif
 }
 
 //
-// String Builder
+// Thread
 //
 
-void c_sb_append(c_String_builder* sb, char* data) {
-	if (sb->items == NULL) {
-		sb->capacity = c_STRING_VIEW_INITIAL_CAPACITY;
-		sb->count = 0;
-		sb->items = C_MALLOC(sizeof(char) * sb->capacity);
-	}
-    size_t data_size = strlen(data);
-    if (sb->count + data_size + 1 > sb->capacity) {
-        sb->capacity *= 2;
-        sb->items = C_REALLOC(sb->items, sb->capacity);
-    }
-
-    // void *memcpy(void dest[restrict .n], const void src[restrict .n],
-    C_MEMCPY((void *)((uintptr_t)sb->items + (uintptr_t)sb->count), data, data_size);
-    sb->count += data_size;
+#if defined(_WIN32)
+typedef struct {
+    c_Thread_proc proc;
+    void *arg;
+} c_Thread_start;
+
+static DWORD WINAPI c_thread_trampoline(LPVOID param) {
+    c_Thread_start start = *(c_Thread_start *)param;
+    C_FREE(param);
+    start.proc(start.arg);
+    return 0;
 }
 
-void c_sb_append_char(c_String_builder* sb, char ch) {
-	if (sb->items == NULL) {
-		sb->capacity = c_STRING_VIEW_INITIAL_CAPACITY;
-		sb->count = 0;
-		sb->items = C_MALLOC(sizeof(char) * sb->capacity);
-	}
-    if (sb->count + 1 > sb->capacity) {
-        sb->capacity *= 2;
-        sb->items = C_REALLOC(sb->items, sb->capacity);
+bool c_thread_create(c_Thread *t, c_Thread_proc proc, void *arg) {
+    c_Thread_start *start = C_MALLOC(sizeof(*start));
+    C_ASSERT(start != NULL, "Buy more RAM bruh");
+    start->proc = proc;
+    start->arg = arg;
+    *t = CreateThread(NULL, 0, c_thread_trampoline, start, 0, NULL);
+    if (*t == NULL) {
+        c_log_error("Failed to create thread (error %lu)", GetLastError());
+        C_FREE(start);
+        return false;
     }
-
-	sb->items[sb->count++] = ch;
+    return true;
 }
 
-void c_sb_append_null(c_String_builder *sb) {
-	c_sb_append_char(sb, '\0');
+void c_thread_join(c_Thread t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
 }
 
-void c_sb_free(c_String_builder *sb) {
-	if (sb->items) {
-		C_FREE(sb->items);
-		sb->items = NULL;
-	}
+void c_thread_yield(void) {
+    SwitchToThread();
 }
 
-//
-// String view
-//
+int c_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
 
-void c_sv_print_dumb(c_String_view sv){
-    for (size_t i = 0; i < (size_t)sv.count; ++i){
-        putc(*(sv.data+i), stdout);
+void c_mutex_init(c_Mutex *m)    { InitializeSRWLock(m); }
+void c_mutex_lock(c_Mutex *m)    { AcquireSRWLockExclusive(m); }
+bool c_mutex_trylock(c_Mutex *m) { return TryAcquireSRWLockExclusive(m) != 0; }
+void c_mutex_unlock(c_Mutex *m)  { ReleaseSRWLockExclusive(m); }
+void c_mutex_destroy(c_Mutex *m) { (void)m; }
+
+void c_cond_init(c_Cond *c)                { InitializeConditionVariable(c); }
+void c_cond_wait(c_Cond *c, c_Mutex *m)    { SleepConditionVariableSRW(c, m, INFINITE, 0); }
+void c_cond_signal(c_Cond *c)              { WakeConditionVariable(c); }
+void c_cond_broadcast(c_Cond *c)           { WakeAllConditionVariable(c); }
+void c_cond_destroy(c_Cond *c)             { (void)c; }
+#else
+#include <unistd.h>
+#include <sched.h>
+
+bool c_thread_create(c_Thread *t, c_Thread_proc proc, void *arg) {
+    int err = pthread_create(t, NULL, proc, arg);
+    if (err != 0) {
+        c_log_error("Failed to create thread: %s", strerror(err));
+        return false;
     }
+    return true;
 }
 
-c_String_view c_sv_from_cstr(const char* cstr){
-    return (c_String_view){
-        .data = (char *)cstr,
-        .count = strlen(cstr),
-    };
+void c_thread_join(c_Thread t) {
+    pthread_join(t, NULL);
 }
 
-c_String_view c_sv_lpop(c_String_view* sv, uint32 n) {
-    c_String_view res = {0};
-    if (sv->count < n) return res;
-    res.data = sv->data;
-    res.count = n;
+void c_thread_yield(void) {
+    sched_yield();
+}
 
-    sv->data += n;
-    sv->count -= n;
+int c_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
 
-    return res;
+void c_mutex_init(c_Mutex *m)    { pthread_mutex_init(m, NULL); }
+void c_mutex_lock(c_Mutex *m)    { pthread_mutex_lock(m); }
+bool c_mutex_trylock(c_Mutex *m) { return pthread_mutex_trylock(m) == 0; }
+void c_mutex_unlock(c_Mutex *m)  { pthread_mutex_unlock(m); }
+void c_mutex_destroy(c_Mutex *m) { pthread_mutex_destroy(m); }
+
+void c_cond_init(c_Cond *c)                { pthread_cond_init(c, NULL); }
+void c_cond_wait(c_Cond *c, c_Mutex *m)    { pthread_cond_wait(c, m); }
+void c_cond_signal(c_Cond *c)              { pthread_cond_signal(c); }
+void c_cond_broadcast(c_Cond *c)           { pthread_cond_broadcast(c); }
+void c_cond_destroy(c_Cond *c)             { pthread_cond_destroy(c); }
+#endif // defined(_WIN32)
+
+//
+// Job pool
+//
+
+// Chase-Lev deque (the C11 version from Le et al. 2013), fixed size.
+// Only the owner pushes and takes at the bottom; anyone steals from the top.
+typedef struct {
+    int64 top;
+    char pad0[64 - sizeof(int64)]; // keep thieves and the owner off each other's cache line
+    int64 bottom;
+    char pad1[64 - sizeof(int64)];
+    c_Job *jobs[C_POOL_DEQUE_SIZE];
+} c_Job_deque;
+
+#define C_JOB_ABORT ((c_Job *)(uintptr_t)1) // lost a race, try again
+
+static bool c_job_deque_push(c_Job_deque *d, c_Job *job) {
+    int64 b = d->bottom;
+    int64 t = C_ATOMIC_LOAD(&d->top);
+    if (b - t >= C_POOL_DEQUE_SIZE) return false;
+    C_ATOMIC_STORE(&d->jobs[b & (C_POOL_DEQUE_SIZE - 1)], job);
+    C_ATOMIC_STORE(&d->bottom, b + 1);
+    return true;
 }
 
-c_String_view c_sv_lpop_until_predicate(c_String_view* sv, int(*predicate)(int)){
-    const char* old_sv_data = sv->data;
-    while (sv->count > 0 && !predicate(*sv->data)){
-        sv->data++;
-        sv->count--;
+static c_Job *c_job_deque_take(c_Job_deque *d) {
+    int64 b = d->bottom - 1;
+    C_ATOMIC_STORE(&d->bottom, b);
+    C_ATOMIC_FENCE();
+    int64 t = C_ATOMIC_LOAD(&d->top);
+    if (t > b) {
+        C_ATOMIC_STORE(&d->bottom, b + 1);
+        return NULL;
     }
+    c_Job *job = C_ATOMIC_LOAD(&d->jobs[b & (C_POOL_DEQUE_SIZE - 1)]);
+    if (t == b) {
+        // Last one; race the thieves for it
+        if (!C_ATOMIC_CAS(&d->top, &t, t + 1)) job = NULL;
+        C_ATOMIC_STORE(&d->bottom, b + 1);
+    }
+    return job;
+}
 
-    return (c_String_view){
-        .data = sv->data - (sv->data - old_sv_data),
-        .count = (sv->data - old_sv_data),
-    };
+static c_Job *c_job_deque_steal(c_Job_deque *d) {
+    int64 t = C_ATOMIC_LOAD(&d->top);
+    C_ATOMIC_FENCE();
+    int64 b = C_ATOMIC_LOAD(&d->bottom);
+    if (t >= b) return NULL;
+    c_Job *job = C_ATOMIC_LOAD(&d->jobs[t & (C_POOL_DEQUE_SIZE - 1)]);
+    if (!C_ATOMIC_CAS(&d->top, &t, t + 1)) return C_JOB_ABORT;
+    return job;
 }
 
-c_String_view c_sv_lpop_until_string(c_String_view* sv, const char *string) {
-    size_t string_len = strlen(string);
+typedef struct {
+    c_Job **items;
+    size_t count;
+    size_t capacity;
+    size_t head; // jobs before this already got taken
+} c_Job_queue; // @darr
+
+static struct {
+    c_Mutex lock;         // guards the rest of the struct (except the deques) and the worker startup
+    c_Cond wake;
+    c_Thread *threads;
+    c_Job_deque *deques;
+    int64 started;
+    int64 worker_count;
+    int64 stopping;
+    int64 sleepers;
+    int64 epoch;          // bumped on every submit so sleepers don't miss work
+    int64 waiters;        // threads that aren't workers sleeping in c_wait_group_wait()
+    c_Cond done;
+    int64 queued;         // jobs in `queue`
+    c_Job_queue queue;    // jobs from threads that aren't workers
+    bool atexit_registered;
+} c_pool = { .lock = C_MUTEX_INIT, .wake = C_COND_INIT, .done = C_COND_INIT };
+
+static C_THREAD_LOCAL int c_pool_worker_index = -1;
+
+static void c_job_run(c_Job *job) {
+    c_Wait_group *wg = job->wg; // `job` may be gone once wg is done
+    job->proc(job->arg);
+    if (wg) c_wait_group_done(wg);
+}
 
-    char *old_sv_data = sv->data;
+// Any job that can run: own deque, then the shared queue, then steal from a random worker onwards
+static c_Job *c_pool_find_job(void) {
+    int self = c_pool_worker_index;
+    int64 n = C_ATOMIC_LOAD(&c_pool.worker_count);
+    if (self >= 0) {
+        c_Job *job = c_job_deque_take(&c_pool.deques[self]);
+        if (job) return job;
+    }
 
-    while (sv->count > string_len) {
-        bool matched = true;
-        for (size_t i = 0; i < string_len; ++i) {
-            if (sv->data[i] != string[i]) matched = false;
+    if (C_ATOMIC_LOAD(&c_pool.queued) > 0) {
+        c_Job *job = NULL;
+        c_mutex_lock(&c_pool.lock);
+        if (c_pool.queue.head < c_pool.queue.count) {
+            job = c_pool.queue.items[c_pool.queue.head++];
+            C_ATOMIC_FETCH_ADD(&c_pool.queued, (int64)-1);
+            if (c_pool.queue.head == c_pool.queue.count) c_pool.queue.head = c_pool.queue.count = 0;
         }
-        if (matched) break;
-        sv->data++;
-        sv->count--;
+        c_mutex_unlock(&c_pool.lock);
+        if (job) return job;
     }
 
-    return (c_String_view) {
-        .data = old_sv_data,
-        .count = (sv->data - old_sv_data),
-    };
+    if (n == 0) return NULL;
+    int64 start = (int64)c_rng_below(c_rng_thread(), (uint64)n);
+    for (int attempts = 0; attempts < 2; ++attempts) {
+        bool aborted = false;
+        for (int64 i = 0; i < n; ++i) {
+            int64 victim = (start + i) % n;
+            if (victim == self) continue;
+            c_Job *job = c_job_deque_steal(&c_pool.deques[victim]);
+            if (job == C_JOB_ABORT) aborted = true;
+            else if (job) return job;
+        }
+        if (!aborted) break;
+    }
+    return NULL;
 }
 
-c_String_view c_sv_rpop_until_predicate(c_String_view* sv, int(*predicate)(int)){
-    size_t old_sv_count = sv->count;
-    while (sv->count > 0 && !predicate(*(sv->data+sv->count-1))){
-        sv->count--;
+static void *c_pool_worker_main(void *arg) {
+    c_pool_worker_index = (int)(intptr_t)arg;
+    while (!C_ATOMIC_LOAD(&c_pool.stopping)) {
+        int64 epoch = C_ATOMIC_LOAD(&c_pool.epoch);
+        c_Job *job = NULL;
+        // Spin a little before going to sleep, jobs tend to come in bursts
+        for (int spins = 0; spins < 64 && job == NULL; ++spins) {
+            job = c_pool_find_job();
+            if (job == NULL) c_thread_yield();
+        }
+        if (job) {
+            c_job_run(job);
+            continue;
+        }
+
+        // NOTE: Sleepers goes up before epoch is checked, and submit bumps epoch before checking sleepers,
+        //       so one of the two always sees the other
+        c_mutex_lock(&c_pool.lock);
+        C_ATOMIC_FETCH_ADD(&c_pool.sleepers, (int64)1);
+        C_ATOMIC_FENCE();
+        while (C_ATOMIC_LOAD(&c_pool.epoch) == epoch && !C_ATOMIC_LOAD(&c_pool.stopping)) {
+            c_cond_wait(&c_pool.wake, &c_pool.lock);
+        }
+        C_ATOMIC_FETCH_ADD(&c_pool.sleepers, (int64)-1);
+        c_mutex_unlock(&c_pool.lock);
     }
+    return NULL;
+}
 
-    return (c_String_view){
-        .data = sv->data + sv->count,
-        .count = old_sv_count - sv->count,
-    };
+static void c_pool_stop_at_exit(void) {
+    c_pool_stop();
 }
 
-c_String_view c_sv_lpop_until_char(c_String_view* sv, char ch){
-    const char* old_sv_data = sv->data;
-    while (sv->count > 0 && *sv->data != ch){
-        sv->data++;
-        sv->count--;
+bool c_pool_start(int n_workers) {
+    c_mutex_lock(&c_pool.lock);
+    if (c_pool.started) {
+        c_mutex_unlock(&c_pool.lock);
+        return true;
     }
-
-    return (c_String_view){
-        .data = sv->data - (sv->data - old_sv_data),
-        .count = (sv->data - old_sv_data),
-    };
+    if (n_workers <= 0) n_workers = c_cpu_count();
+
+    c_pool.stopping = 0;
+    c_pool.threads = C_MALLOC(sizeof(*c_pool.threads) * (size_t)n_workers);
+    c_pool.deques = C_MALLOC(sizeof(*c_pool.deques) * (size_t)n_workers);
+    C_ASSERT(c_pool.threads != NULL && c_pool.deques != NULL, "Buy more RAM bruh");
+    C_MEMSET(c_pool.deques, 0, sizeof(*c_pool.deques) * (size_t)n_workers);
+    // NOTE: Workers look at worker_count, so it's set before any of them starts
+    C_ATOMIC_STORE(&c_pool.worker_count, (int64)n_workers);
+
+    int started = 0;
+    for (; started < n_workers; ++started) {
+        if (!c_thread_create(&c_pool.threads[started], c_pool_worker_main, (void *)(intptr_t)started)) break;
+    }
+    if (started < n_workers) {
+        // Nothing was submitted yet, so nothing can be in the deques of the ones that didn't start
+        C_ATOMIC_STORE(&c_pool.worker_count, (int64)started);
+    }
+    // NOTE: Without workers, submitted jobs run right away on the submitting thread
+    if (!c_pool.atexit_registered) {
+        atexit(c_pool_stop_at_exit);
+        c_pool.atexit_registered = true;
+    }
+    C_ATOMIC_STORE(&c_pool.started, (int64)1);
+    c_mutex_unlock(&c_pool.lock);
+    return started == n_workers;
 }
 
-c_String_view c_sv_rpop_until_char(c_String_view* sv, char ch){
-    size_t old_sv_count = sv->count;
-    while (sv->count > 0 && *(sv->data+sv->count-1) != ch){
-        sv->count--;
-    }
+void c_pool_stop(void) {
+    c_mutex_lock(&c_pool.lock);
+    int64 n = c_pool.worker_count;
+    C_ATOMIC_STORE(&c_pool.stopping, (int64)1);
+    c_cond_broadcast(&c_pool.wake);
+    c_mutex_unlock(&c_pool.lock);
+
+    for (int64 i = 0; i < n; ++i) c_thread_join(c_pool.threads[i]);
+
+    c_mutex_lock(&c_pool.lock);
+    C_FREE(c_pool.threads);
+    C_FREE(c_pool.deques);
+    c_pool.threads = NULL;
+    c_pool.deques = NULL;
+    C_ATOMIC_STORE(&c_pool.worker_count, (int64)0);
+    C_ATOMIC_STORE(&c_pool.started, (int64)0);
+    c_darr_free(c_pool.queue);
+    c_pool.queue = (c_Job_queue){0};
+    C_ATOMIC_STORE(&c_pool.queued, (int64)0);
+    c_mutex_unlock(&c_pool.lock);
+}
 
-    return (c_String_view){
-        .data = sv->data + sv->count,
-        .count = old_sv_count - sv->count,
-    };
+int c_pool_worker_count(void) {
+    return (int)C_ATOMIC_LOAD(&c_pool.worker_count);
 }
 
-void c_sv_lremove(c_String_view* sv, size_t n){
-    if (n > sv->count) n = sv->count;
+void c_pool_submit(c_Job *job) {
+    if (!C_ATOMIC_LOAD(&c_pool.started)) c_pool_start(0);
+    if (job->wg) c_wait_group_add(job->wg, 1);
+
+    int self = c_pool_worker_index;
+    if (C_ATOMIC_LOAD(&c_pool.worker_count) == 0) {
+        c_job_run(job);
+        return;
+    } else if (self >= 0) {
+        if (!c_job_deque_push(&c_pool.deques[self], job)) {
+            c_job_run(job);
+            return;
+        }
+    } else {
+        c_mutex_lock(&c_pool.lock);
+        c_darr_append(c_pool.queue, job);
+        C_ATOMIC_FETCH_ADD(&c_pool.queued, (int64)1);
+        c_mutex_unlock(&c_pool.lock);
+    }
 
-    sv->data += n;
-    sv->count -= n;
+    C_ATOMIC_FETCH_ADD(&c_pool.epoch, (int64)1);
+    C_ATOMIC_FENCE();
+    if (C_ATOMIC_LOAD(&c_pool.sleepers) > 0) {
+        c_mutex_lock(&c_pool.lock);
+        c_cond_signal(&c_pool.wake);
+        c_mutex_unlock(&c_pool.lock);
+    }
 }
 
-void c_sv_rremove(c_String_view* sv, size_t n){
-    if (n > sv->count)
-        sv->count = 0;
-    else
-        sv->count -= n;
+void c_wait_group_add(c_Wait_group *wg, int64 n) {
+    C_ATOMIC_FETCH_ADD(&wg->pending, n);
 }
 
-void c_sv_lremove_until_char(c_String_view* sv, char ch){
-    while (sv->count > 0 && *sv->data != ch){
-        sv->data++;
-        sv->count--;
+void c_wait_group_done(c_Wait_group *wg) {
+    // NOTE: `wg` can be gone as soon as pending hits 0, so only c_pool is touched after that
+    if (C_ATOMIC_FETCH_ADD(&wg->pending, (int64)-1) != 1) return;
+    C_ATOMIC_FENCE();
+    if (C_ATOMIC_LOAD(&c_pool.waiters) > 0) {
+        c_mutex_lock(&c_pool.lock);
+        c_cond_broadcast(&c_pool.done);
+        c_mutex_unlock(&c_pool.lock);
     }
 }
 
-void c_sv_rremove_until_char(c_String_view* sv, char ch){
-    while (sv->count > 0 && *(sv->data+sv->count-1) != ch){
-        sv->count--;
+void c_wait_group_wait(c_Wait_group *wg) {
+    if (c_pool_worker_index >= 0) {
+        while (C_ATOMIC_LOAD(&wg->pending) > 0) {
+            c_Job *job = c_pool_find_job();
+            if (job) c_job_run(job);
+            else c_thread_yield();
+        }
+        return;
     }
-}
 
-void c_sv_lremove_until_char_after(c_String_view* sv, char ch){
-    while (sv->count > 0 && *(sv->data-1) != ch){
-        sv->data++;
-        sv->count--;
-    }
+    // NOTE: Not helping here on purpose; Jobs run from an outside thread would split through the
+    //       shared FIFO queue and could nest without bound
+    c_mutex_lock(&c_pool.lock);
+    C_ATOMIC_FETCH_ADD(&c_pool.waiters, (int64)1);
+    C_ATOMIC_FENCE();
+    while (C_ATOMIC_LOAD(&wg->pending) > 0) c_cond_wait(&c_pool.done, &c_pool.lock);
+    C_ATOMIC_FETCH_ADD(&c_pool.waiters, (int64)-1);
+    c_mutex_unlock(&c_pool.lock);
+}
+
+typedef struct {
+    void *items;
+    size_t grain;
+    c_Range_proc fn;
+    void *ctx;
+} c_Parallel_for;
+
+typedef struct {
+    c_Parallel_for *pf;
+    size_t begin, end;
+} c_Range_job;
+
+static void c_parallel_for_range(c_Parallel_for *pf, size_t begin, size_t end);
+
+static void c_range_job_run(void *arg) {
+    c_Range_job *r = arg;
+    c_parallel_for_range(r->pf, r->begin, r->end);
+}
+
+// Fork-join: hand out the right half and go on with the left one, so jobs live on the stack
+static void c_parallel_for_range(c_Parallel_for *pf, size_t begin, size_t end) {
+    if (end - begin <= pf->grain) {
+        pf->fn(pf->items, begin, end, pf->ctx);
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    c_Wait_group wg = {0};
+    c_Range_job right = { pf, mid, end };
+    c_Job job = { c_range_job_run, &right, &wg };
+    c_pool_submit(&job);
+    c_parallel_for_range(pf, begin, mid);
+    // Most of the time nobody stole it and this just runs it
+    c_wait_group_wait(&wg);
+}
+
+void c_parallel_for(void *items, size_t count, size_t grain, c_Range_proc fn, void *ctx) {
+    if (count == 0) return;
+    if (!C_ATOMIC_LOAD(&c_pool.started)) c_pool_start(0);
+    if (grain == 0) {
+        // About 8 ranges per thread so there's something to steal when they finish unevenly
+        size_t ranges = (size_t)c_pool_worker_count() * 8 + 1;
+        grain = (count + ranges - 1) / ranges;
+    }
+    if (count <= grain || c_pool_worker_count() <= 1) {
+        fn(items, 0, count, ctx);
+        return;
+    }
+    c_Parallel_for pf = { items, grain, fn, ctx };
+    c_Range_job all = { &pf, 0, count };
+    if (c_pool_worker_index >= 0) {
+        c_range_job_run(&all);
+    } else {
+        // Split on a worker so the halves go through its deque rather than the shared queue
+        c_Wait_group wg = {0};
+        c_Job job = { c_range_job_run, &all, &wg };
+        c_pool_submit(&job);
+        c_wait_group_wait(&wg);
+    }
+}
+
+typedef struct {
+    void *items;
+    size_t count;
+    size_t chunk;
+    c_Reduce_proc map;
+    const void *identity;
+    char *accs;
+    size_t result_size;
+    void *ctx;
+} c_Parallel_reduce;
+
+static void c_parallel_reduce_chunks(void *items, size_t begin, size_t end, void *ctx) {
+    (void)items;
+    c_Parallel_reduce *pr = ctx;
+    for (size_t i = begin; i < end; ++i) {
+        void *acc = pr->accs + i*pr->result_size;
+        C_MEMCPY(acc, pr->identity, pr->result_size);
+        size_t first = i*pr->chunk;
+        size_t last = first + pr->chunk < pr->count ? first + pr->chunk : pr->count;
+        pr->map(pr->items, first, last, acc, pr->ctx);
+    }
+}
+
+void c_parallel_reduce(void *items, size_t count, size_t grain, c_Reduce_proc map, c_Combine_proc combine,
+                       void *result, size_t result_size, void *ctx) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks > C_PARALLEL_REDUCE_MAX_CHUNKS) chunks = C_PARALLEL_REDUCE_MAX_CHUNKS;
+    size_t chunk = (count + chunks - 1) / chunks;
+    chunks = (count + chunk - 1) / chunk;
+
+    c_Parallel_reduce pr = {
+        .items = items, .count = count, .chunk = chunk, .map = map,
+        .identity = result, .result_size = result_size, .ctx = ctx,
+    };
+    // The identity stays in `result` until every chunk copied it
+    pr.accs = C_MALLOC(chunks * result_size);
+    C_ASSERT(pr.accs != NULL, "Buy more RAM bruh");
+    c_parallel_for(NULL, chunks, 1, c_parallel_reduce_chunks, &pr);
+
+    C_MEMCPY(result, pr.accs, result_size);
+    for (size_t i = 1; i < chunks; ++i) combine(result, pr.accs + i*result_size, ctx);
+    C_FREE(pr.accs);
+}
+
+//
+// Math
+//
+
+int c_clampi(int v, int min, int max) {
+    v = v < min ? min : v;
+    v = v > max ? max : v;
+    return v;
+}
+
+float c_clampf(float v, float min, float max) {
+    v = v < min ? min : v;
+    v = v > max ? max : v;
+    return v;
+}
+
+float c_randomf(float from, float to) {
+	float v = from + (to - from) * c_rng_float(c_rng_thread());
+	// NOTE: Rounding can land right on `to`
+	float limit = nextafterf(to, from);
+	return c_clampf(v, C_MIN(from, limit), C_MAX(from, limit));
+}
+
+int c_randomi(int from, int to) {
+	if (to <= from) return from;
+	return (int)c_rng_range(c_rng_thread(), from, (int64)to - 1);
+}
+
+void c_random_seed(uint64 seed) {
+    c_rng_seed(c_rng_thread(), seed);
+}
+
+static inline uint64 c_rotl64(uint64 x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// splitmix64, so any seed (even 0) gives a well mixed state
+void c_rng_seed(c_Rng *r, uint64 seed) {
+    for (int i = 0; i < 4; ++i) {
+        uint64 z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        r->s[i] = z ^ (z >> 31);
+    }
+}
+
+uint64 c_rng_next(c_Rng *r) {
+    uint64 *s = r->s;
+    uint64 result = c_rotl64(s[1] * 5, 7) * 9;
+    uint64 t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = c_rotl64(s[3], 45);
+    return result;
+}
+
+static void c_rng_jump_by(c_Rng *r, const uint64 jump[4]) {
+    uint64 s[4] = {0};
+    for (int i = 0; i < 4; ++i) {
+        for (int b = 0; b < 64; ++b) {
+            if (jump[i] & ((uint64)1 << b)) {
+                s[0] ^= r->s[0];
+                s[1] ^= r->s[1];
+                s[2] ^= r->s[2];
+                s[3] ^= r->s[3];
+            }
+            c_rng_next(r);
+        }
+    }
+    C_MEMCPY(r->s, s, sizeof(s));
+}
+
+void c_rng_jump(c_Rng *r) {
+    static const uint64 jump[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+    c_rng_jump_by(r, jump);
+}
+
+void c_rng_long_jump(c_Rng *r) {
+    static const uint64 jump[4] = { 0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull };
+    c_rng_jump_by(r, jump);
+}
+
+// High 64 bits of a * b
+static inline uint64 c_mul64_hi(uint64 a, uint64 b, uint64 *lo) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 c_uint128; // no -Wpedantic warning
+    c_uint128 m = (c_uint128)a * b;
+    *lo = (uint64)m;
+    return (uint64)(m >> 64);
+#else
+    uint64 a_lo = (uint32)a, a_hi = a >> 32, b_lo = (uint32)b, b_hi = b >> 32;
+    uint64 ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    uint64 mid = (ll >> 32) + (uint32)lh + (uint32)hl;
+    *lo = (mid << 32) | (uint32)ll;
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+// Lemire's multiply-shift with rejection; Only divides on the rare rejection path
+uint64 c_rng_below(c_Rng *r, uint64 n) {
+    C_ASSERT(n > 0, "c_rng_below() needs n > 0");
+    uint64 lo;
+    uint64 hi = c_mul64_hi(c_rng_next(r), n, &lo);
+    if (lo < n) {
+        uint64 threshold = (0 - n) % n;
+        while (lo < threshold) hi = c_mul64_hi(c_rng_next(r), n, &lo);
+    }
+    return hi;
+}
+
+int64 c_rng_range(c_Rng *r, int64 from, int64 to) {
+    C_ASSERT(from <= to, "c_rng_range() needs from <= to");
+    uint64 span = (uint64)to - (uint64)from + 1;
+    uint64 v = span == 0 ? c_rng_next(r) : c_rng_below(r, span); // span 0: the whole int64 range
+    return (int64)((uint64)from + v);
+}
+
+float c_rng_float(c_Rng *r) {
+    return (float)(c_rng_next(r) >> 40) * (1.0f / 16777216.0f);
+}
+
+float64 c_rng_float64(c_Rng *r) {
+    return (float64)(c_rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#ifdef C_SIMD_SSE2
+static inline __m128i c_rng_rotl_x2(__m128i x, int k) {
+    return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k));
+}
+
+// Two c_rng_next()s at once, lane 0 from `s` and lane 1 from the long jumped copy.
+// NOTE: SSE2 has no 64 bit multiply, but *5 and *9 are just a shift and an add
+static inline __m128i c_rng_next_x2(__m128i s[4]) {
+    __m128i x = _mm_add_epi64(_mm_slli_epi64(s[1], 2), s[1]);
+    x = c_rng_rotl_x2(x, 7);
+    __m128i result = _mm_add_epi64(_mm_slli_epi64(x, 3), x);
+
+    __m128i t = _mm_slli_epi64(s[1], 17);
+    s[2] = _mm_xor_si128(s[2], s[0]);
+    s[3] = _mm_xor_si128(s[3], s[1]);
+    s[1] = _mm_xor_si128(s[1], s[2]);
+    s[0] = _mm_xor_si128(s[0], s[3]);
+    s[2] = _mm_xor_si128(s[2], t);
+    s[3] = c_rng_rotl_x2(s[3], 45);
+    return result;
+}
+
+static void c_rng_load_x2(c_Rng *r, __m128i s[4]) {
+    c_Rng other = *r;
+    c_rng_long_jump(&other);
+    for (int i = 0; i < 4; ++i) s[i] = _mm_set_epi64x((long long)other.s[i], (long long)r->s[i]);
+}
+
+static void c_rng_store_x2(c_Rng *r, __m128i s[4]) {
+    uint64 lanes[2];
+    for (int i = 0; i < 4; ++i) {
+        _mm_storeu_si128((__m128i *)lanes, s[i]);
+        r->s[i] = lanes[0];
+    }
+}
+
+// Below this the long jump costs more than it saves
+#define C_RNG_SIMD_MIN_COUNT 256
+#endif // C_SIMD_SSE2
+
+// NOTE: Scalar on purpose; Emulating the 64 bit multiplies in SSE2 is no faster than the plain loop
+void c_rng_fill_u64(c_Rng *r, uint64 *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = c_rng_next(r);
+}
+
+void c_rng_fill_float(c_Rng *r, float *out, size_t n, float from, float to) {
+    float scale = (to - from) * (1.0f / 16777216.0f);
+    // NOTE: Rounding can land right on `to`, so everything is clamped to the float before it
+    float limit = nextafterf(to, from);
+    float lo = C_MIN(from, limit), hi = C_MAX(from, limit);
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    if (n >= C_RNG_SIMD_MIN_COUNT) {
+        // Each 64 bit output makes 2 floats from the top 24 bits of its 32 bit halves
+        __m128i s[4];
+        c_rng_load_x2(r, s);
+        __m128 vscale = _mm_set1_ps(scale), vfrom = _mm_set1_ps(from);
+        __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+        for (; i + 4 <= n; i += 4) {
+            __m128i bits = _mm_srli_epi32(c_rng_next_x2(s), 8);
+            __m128 f = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(bits), vscale), vfrom);
+            _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(f, vlo), vhi));
+        }
+        c_rng_store_x2(r, s);
+    }
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = c_clampf(from + (float)(c_rng_next(r) >> 40) * scale, lo, hi);
+}
+
+void c_rng_fill_int(c_Rng *r, int32 *out, size_t n, int32 from, int32 to) {
+    C_ASSERT(from <= to, "c_rng_fill_int() needs from <= to");
+    uint64 span = (uint64)((int64)to - (int64)from) + 1;
+    uint64 threshold = (((uint64)1 << 32) - span) % span; // 2^32 % span
+
+    // Raw numbers in chunks, then Lemire's multiply-shift on 32 bit halves
+    uint64 raw[512];
+    size_t i = 0;
+    while (i < n) {
+        size_t chunk = (n - i + 1) / 2;
+        if (chunk > C_ARRAY_LEN(raw)) chunk = C_ARRAY_LEN(raw);
+        c_rng_fill_u64(r, raw, chunk);
+        for (size_t j = 0; j < chunk*2 && i < n; ++j) {
+            uint64 m = (raw[j/2] >> (j & 1 ? 32 : 0) & 0xFFFFFFFFull) * span;
+            while ((m & 0xFFFFFFFFull) < threshold) m = (c_rng_next(r) >> 32) * span;
+            out[i++] = (int32)((int64)from + (int64)(m >> 32));
+        }
+    }
+}
+
+c_Rng *c_rng_thread(void) {
+    // What the next thread starts from; Each thread takes it and jumps it once for the one after,
+    // so the N-th thread doesn't have to do N jumps.
+    static c_Mutex next_lock = C_MUTEX_INIT;
+    static c_Rng next;
+    static bool next_seeded = false;
+    static C_THREAD_LOCAL c_Rng rng;
+    static C_THREAD_LOCAL bool seeded = false;
+    if (!seeded) {
+        c_mutex_lock(&next_lock);
+        if (!next_seeded) {
+            c_rng_seed(&next, C_RNG_DEFAULT_SEED);
+            next_seeded = true;
+        }
+        rng = next;
+        c_rng_jump(&next);
+        c_mutex_unlock(&next_lock);
+        seeded = true;
+    }
+    return &rng;
+}
+
+float c_mapf(float value, float from1, float to1, float from2, float to2) {
+    value -= from1;
+    value /= (to1 - from1);
+    value *= (to2 - from2);
+    value += from2;
+
+    return value;
+}
+
+float c_ease_in_sine(float t) {
+	return 1.f - cosf(t * (C_PI_F / 2.f));
+}
+
+float c_ease_out_sine(float t) {
+	return sinf(t * (C_PI_F / 2.f));
+}
+
+float c_ease_in_out_sine(float t) {
+	return (1.f - cosf(C_PI_F * t)) / 2.f;
+}
+
+// 4 parabolas; Which one is picked by adding up the steps `x` is past, so there are no branches
+#define C_BOUNCE_N1 7.5625f
+#define C_BOUNCE_STEP1 (1.f / 2.75f)
+#define C_BOUNCE_STEP2 (2.f / 2.75f)
+#define C_BOUNCE_STEP3 (2.5f / 2.75f)
+#define C_BOUNCE_CENTER1 (1.5f / 2.75f)
+#define C_BOUNCE_CENTER2 ((2.25f - 1.5f) / 2.75f)    // added to center 1
+#define C_BOUNCE_CENTER3 ((2.625f - 2.25f) / 2.75f)  // added to center 2
+#define C_BOUNCE_LIFT1 0.75f
+#define C_BOUNCE_LIFT2 (0.9375f - 0.75f)
+#define C_BOUNCE_LIFT3 (0.984375f - 0.9375f)
+
+float c_ease_out_bounce(float x) {
+    float past1 = (float)(x >= C_BOUNCE_STEP1);
+    float past2 = (float)(x >= C_BOUNCE_STEP2);
+    float past3 = (float)(x >= C_BOUNCE_STEP3);
+    float d = x - (past1*C_BOUNCE_CENTER1 + past2*C_BOUNCE_CENTER2 + past3*C_BOUNCE_CENTER3);
+    return C_BOUNCE_N1*d*d + (past1*C_BOUNCE_LIFT1 + past2*C_BOUNCE_LIFT2 + past3*C_BOUNCE_LIFT3);
+}
+
+float c_ease_in_bounce(float t) {
+	return 1.f - c_ease_out_bounce(1.f - t);
+}
+
+// Cephes sinf/cosf constants; pi/4 is split in 3 so x - j*pi/4 doesn't lose bits
+#define C_TRIG_FOPI 1.27323954473516f  // 4/pi
+#define C_TRIG_DP1 0.78515625f
+#define C_TRIG_DP2 2.4187564849853515625e-4f
+#define C_TRIG_DP3 3.77489497744594108e-8f
+#define C_TRIG_SIN_P0 -1.9515295891e-4f
+#define C_TRIG_SIN_P1 8.3321608736e-3f
+#define C_TRIG_SIN_P2 -1.6666654611e-1f
+#define C_TRIG_COS_P0 2.443315711809948e-5f
+#define C_TRIG_COS_P1 -1.388731625493765e-3f
+#define C_TRIG_COS_P2 4.166664568298827e-2f
+
+// Past this the reduction runs out of bits (and the octant out of int range), so libm takes over
+#define C_TRIG_FAST_MAX 8192.f
+
+// `octant` is the (even) multiple of pi/4 |x| got reduced by; `r` is what's left in [-pi/4, pi/4]
+// NOTE: Only for |x| <= C_TRIG_FAST_MAX
+static inline float c_trig_reduce(float ax, int *octant) {
+    int j = (int)(ax * C_TRIG_FOPI);
+    j = (j + 1) & ~1;
+    *octant = j;
+    float y = (float)j;
+    return ((ax - y*C_TRIG_DP1) - y*C_TRIG_DP2) - y*C_TRIG_DP3;
+}
+
+static inline float c_trig_sin_poly(float r, float z) {
+    return ((C_TRIG_SIN_P0*z + C_TRIG_SIN_P1)*z + C_TRIG_SIN_P2)*z*r + r;
+}
+
+static inline float c_trig_cos_poly(float z) {
+    return ((C_TRIG_COS_P0*z + C_TRIG_COS_P1)*z + C_TRIG_COS_P2)*z*z - 0.5f*z + 1.f;
+}
+
+float c_sin_fast(float x) {
+    // NOTE: Written so NaN goes this way too
+    if (!(fabsf(x) <= C_TRIG_FAST_MAX)) return sinf(x);
+    int j;
+    float r = c_trig_reduce(fabsf(x), &j);
+    float z = r*r;
+    float v = (j & 2) ? c_trig_cos_poly(z) : c_trig_sin_poly(r, z);
+    bool negative = ((j & 4) != 0) != (x < 0.f);
+    return negative ? -v : v;
+}
+
+float c_cos_fast(float x) {
+    if (!(fabsf(x) <= C_TRIG_FAST_MAX)) return cosf(x);
+    int j;
+    float r = c_trig_reduce(fabsf(x), &j);
+    float z = r*r;
+    float v = (j & 2) ? c_trig_sin_poly(r, z) : c_trig_cos_poly(z);
+    bool negative = (((j + 2) & 4) != 0);
+    return negative ? -v : v;
+}
+
+#ifdef C_SIMD_SSE2
+// c_sin_fast()/c_cos_fast() on 4 floats; Both polynomials are computed and the right one is masked in
+static inline __m128 c_sincos_x4(__m128 x, bool cosine) {
+    const __m128 sign_bit = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u));
+    __m128 ax = _mm_andnot_ps(sign_bit, x);
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(ax, _mm_set1_ps(C_TRIG_FOPI)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+    __m128 r = _mm_sub_ps(ax, _mm_mul_ps(y, _mm_set1_ps(C_TRIG_DP1)));
+    r = _mm_sub_ps(r, _mm_mul_ps(y, _mm_set1_ps(C_TRIG_DP2)));
+    r = _mm_sub_ps(r, _mm_mul_ps(y, _mm_set1_ps(C_TRIG_DP3)));
+    __m128 z = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(C_TRIG_SIN_P0), z), _mm_set1_ps(C_TRIG_SIN_P1));
+    s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(C_TRIG_SIN_P2));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), r), r);
+
+    __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(C_TRIG_COS_P0), z), _mm_set1_ps(C_TRIG_COS_P1));
+    c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(C_TRIG_COS_P2));
+    c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+    c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.f));
+
+    __m128 sign;
+    __m128 use_cos_poly = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+    if (cosine) {
+        use_cos_poly = _mm_xor_ps(use_cos_poly, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+        sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(j, _mm_set1_epi32(2)), 29));
+    } else {
+        sign = _mm_xor_ps(_mm_castsi128_ps(_mm_slli_epi32(j, 29)), _mm_and_ps(x, sign_bit));
+    }
+    sign = _mm_and_ps(sign, sign_bit);
+
+    __m128 v = _mm_or_ps(_mm_and_ps(use_cos_poly, c), _mm_andnot_ps(use_cos_poly, s));
+    v = _mm_xor_ps(v, sign);
+
+    // Out of range (or NaN) lanes went through garbage octants; Redo them like the scalar versions do
+    __m128 outside = _mm_cmpnle_ps(ax, _mm_set1_ps(C_TRIG_FAST_MAX));
+    if (_mm_movemask_ps(outside)) {
+        float lanes[4], in[4];
+        _mm_storeu_ps(lanes, v);
+        _mm_storeu_ps(in, x);
+        int mask = _mm_movemask_ps(outside);
+        for (int i = 0; i < 4; ++i) {
+            if (mask & (1 << i)) lanes[i] = cosine ? cosf(in[i]) : sinf(in[i]);
+        }
+        v = _mm_loadu_ps(lanes);
+    }
+    return v;
+}
+
+static inline __m128 c_ease_out_bounce_x4(__m128 x) {
+    __m128 past1 = _mm_cmpge_ps(x, _mm_set1_ps(C_BOUNCE_STEP1));
+    __m128 past2 = _mm_cmpge_ps(x, _mm_set1_ps(C_BOUNCE_STEP2));
+    __m128 past3 = _mm_cmpge_ps(x, _mm_set1_ps(C_BOUNCE_STEP3));
+    __m128 center = _mm_add_ps(_mm_add_ps(
+        _mm_and_ps(past1, _mm_set1_ps(C_BOUNCE_CENTER1)),
+        _mm_and_ps(past2, _mm_set1_ps(C_BOUNCE_CENTER2))),
+        _mm_and_ps(past3, _mm_set1_ps(C_BOUNCE_CENTER3)));
+    __m128 lift = _mm_add_ps(_mm_add_ps(
+        _mm_and_ps(past1, _mm_set1_ps(C_BOUNCE_LIFT1)),
+        _mm_and_ps(past2, _mm_set1_ps(C_BOUNCE_LIFT2))),
+        _mm_and_ps(past3, _mm_set1_ps(C_BOUNCE_LIFT3)));
+    __m128 d = _mm_sub_ps(x, center);
+    return _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(C_BOUNCE_N1), d), d), lift);
+}
+#endif // C_SIMD_SSE2
+
+void c_sin_fast_batch(const float *in, float *out, size_t n) {
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, c_sincos_x4(_mm_loadu_ps(in + i), false));
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = c_sin_fast(in[i]);
+}
+
+void c_cos_fast_batch(const float *in, float *out, size_t n) {
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, c_sincos_x4(_mm_loadu_ps(in + i), true));
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = c_cos_fast(in[i]);
+}
+
+void c_ease_in_sine_batch(const float *in, float *out, size_t n) {
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    const __m128 half_pi = _mm_set1_ps(C_PI_F / 2.f), one = _mm_set1_ps(1.f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 c = c_sincos_x4(_mm_mul_ps(_mm_loadu_ps(in + i), half_pi), true);
+        _mm_storeu_ps(out + i, _mm_sub_ps(one, c));
+    }
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = 1.f - c_cos_fast(in[i] * (C_PI_F / 2.f));
+}
+
+void c_ease_out_sine_batch(const float *in, float *out, size_t n) {
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    const __m128 half_pi = _mm_set1_ps(C_PI_F / 2.f);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, c_sincos_x4(_mm_mul_ps(_mm_loadu_ps(in + i), half_pi), false));
+    }
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = c_sin_fast(in[i] * (C_PI_F / 2.f));
+}
+
+void c_ease_in_out_sine_batch(const float *in, float *out, size_t n) {
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    const __m128 pi = _mm_set1_ps(C_PI_F), one = _mm_set1_ps(1.f), half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 c = c_sincos_x4(_mm_mul_ps(_mm_loadu_ps(in + i), pi), true);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_sub_ps(one, c), half));
+    }
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = (1.f - c_cos_fast(C_PI_F * in[i])) * 0.5f;
+}
+
+void c_ease_out_bounce_batch(const float *in, float *out, size_t n) {
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, c_ease_out_bounce_x4(_mm_loadu_ps(in + i)));
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = c_ease_out_bounce(in[i]);
+}
+
+void c_ease_in_bounce_batch(const float *in, float *out, size_t n) {
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    const __m128 one = _mm_set1_ps(1.f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = c_ease_out_bounce_x4(_mm_sub_ps(one, _mm_loadu_ps(in + i)));
+        _mm_storeu_ps(out + i, _mm_sub_ps(one, v));
+    }
+#endif // C_SIMD_SSE2
+    for (; i < n; ++i) out[i] = c_ease_in_bounce(in[i]);
+}
+
+//
+// Float kernels
+//
+
+#if !defined(C_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && defined(C_SIMD_SSE2)
+#define C_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define C_TARGET(isa)
+#else
+// Lets the AVX kernels live next to the baseline code without building everything with -mavx2
+#define C_TARGET(isa) __attribute__((target(isa)))
+#endif // defined(_MSC_VER) && !defined(__clang__)
+#endif // x86
+
+typedef struct {
+    void (*clamp)(const float32 *in, float32 *out, size_t n, float32 min, float32 max);
+    void (*scale_add)(const float32 *in, float32 *out, size_t n, float32 scale, float32 add);
+    void (*lerp)(const float32 *a, const float32 *b, float32 *out, size_t n, float32 t);
+    void (*add)(const float32 *a, const float32 *b, float32 *out, size_t n);
+    float32 (*min)(const float32 *in, size_t n);
+    float32 (*max)(const float32 *in, size_t n);
+    float32 (*sum)(const float32 *in, size_t n);
+    float32 (*dot)(const float32 *a, const float32 *b, size_t n);
+} c_F32_kernels;
+
+// Scalar; Also the tails of the SIMD ones
+
+static inline float32 c_f32_clamp1(float32 v, float32 min, float32 max) {
+    v = v < min ? min : v;
+    return v > max ? max : v;
+}
+
+static void c_f32_clamp_scalar(const float32 *in, float32 *out, size_t n, float32 min, float32 max) {
+    for (size_t i = 0; i < n; ++i) out[i] = c_f32_clamp1(in[i], min, max);
+}
+
+static void c_f32_scale_add_scalar(const float32 *in, float32 *out, size_t n, float32 scale, float32 add) {
+    for (size_t i = 0; i < n; ++i) out[i] = in[i]*scale + add;
+}
+
+static void c_f32_lerp_scalar(const float32 *a, const float32 *b, float32 *out, size_t n, float32 t) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] + (b[i] - a[i])*t;
+}
+
+static void c_f32_add_scalar(const float32 *a, const float32 *b, float32 *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+static float32 c_f32_min_scalar(const float32 *in, size_t n) {
+    float32 m = INFINITY;
+    for (size_t i = 0; i < n; ++i) m = in[i] < m ? in[i] : m;
+    return m;
+}
+
+static float32 c_f32_max_scalar(const float32 *in, size_t n) {
+    float32 m = -INFINITY;
+    for (size_t i = 0; i < n; ++i) m = in[i] > m ? in[i] : m;
+    return m;
+}
+
+static float32 c_f32_sum_scalar(const float32 *in, size_t n) {
+    float32 s = 0.f;
+    for (size_t i = 0; i < n; ++i) s += in[i];
+    return s;
+}
+
+static float32 c_f32_dot_scalar(const float32 *a, const float32 *b, size_t n) {
+    float32 s = 0.f;
+    for (size_t i = 0; i < n; ++i) s += a[i]*b[i];
+    return s;
+}
+
+#ifdef C_KERNELS_X86
+// SSE2
+// NOTE: Reductions keep 4 accumulators going so they aren't bound by the latency of a single add
+
+static void c_f32_clamp_sse2(const float32 *in, float32 *out, size_t n, float32 min, float32 max) {
+    __m128 lo = _mm_set1_ps(min), hi = _mm_set1_ps(max);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi));
+    c_f32_clamp_scalar(in + i, out + i, n - i, min, max);
+}
+
+static void c_f32_scale_add_sse2(const float32 *in, float32 *out, size_t n, float32 scale, float32 add) {
+    __m128 s = _mm_set1_ps(scale), a = _mm_set1_ps(add);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i), s), a));
+    c_f32_scale_add_scalar(in + i, out + i, n - i, scale, add);
+}
+
+static void c_f32_lerp_sse2(const float32 *a, const float32 *b, float32 *out, size_t n, float32 t) {
+    __m128 vt = _mm_set1_ps(t);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), vt)));
+    }
+    c_f32_lerp_scalar(a + i, b + i, out + i, n - i, t);
+}
+
+static void c_f32_add_sse2(const float32 *a, const float32 *b, float32 *out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    c_f32_add_scalar(a + i, b + i, out + i, n - i);
+}
+
+static inline float32 c_hsum_sse2(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+static float32 c_f32_min_sse2(const float32 *in, size_t n) {
+    __m128 m0 = _mm_set1_ps(INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        m0 = _mm_min_ps(m0, _mm_loadu_ps(in + i));
+        m1 = _mm_min_ps(m1, _mm_loadu_ps(in + i + 4));
+    }
+    m0 = _mm_min_ps(m0, m1);
+    m0 = _mm_min_ps(m0, _mm_movehl_ps(m0, m0));
+    m0 = _mm_min_ss(m0, _mm_shuffle_ps(m0, m0, 1));
+    float32 tail = c_f32_min_scalar(in + i, n - i);
+    float32 m = _mm_cvtss_f32(m0);
+    return tail < m ? tail : m;
+}
+
+static float32 c_f32_max_sse2(const float32 *in, size_t n) {
+    __m128 m0 = _mm_set1_ps(-INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        m0 = _mm_max_ps(m0, _mm_loadu_ps(in + i));
+        m1 = _mm_max_ps(m1, _mm_loadu_ps(in + i + 4));
+    }
+    m0 = _mm_max_ps(m0, m1);
+    m0 = _mm_max_ps(m0, _mm_movehl_ps(m0, m0));
+    m0 = _mm_max_ss(m0, _mm_shuffle_ps(m0, m0, 1));
+    float32 tail = c_f32_max_scalar(in + i, n - i);
+    float32 m = _mm_cvtss_f32(m0);
+    return tail > m ? tail : m;
+}
+
+static float32 c_f32_sum_sse2(const float32 *in, size_t n) {
+    __m128 s0 = _mm_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm_add_ps(s0, _mm_loadu_ps(in + i));
+        s1 = _mm_add_ps(s1, _mm_loadu_ps(in + i + 4));
+        s2 = _mm_add_ps(s2, _mm_loadu_ps(in + i + 8));
+        s3 = _mm_add_ps(s3, _mm_loadu_ps(in + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) s0 = _mm_add_ps(s0, _mm_loadu_ps(in + i));
+    s0 = _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3));
+    return c_hsum_sse2(s0) + c_f32_sum_scalar(in + i, n - i);
+}
+
+static float32 c_f32_dot_sse2(const float32 *a, const float32 *b, size_t n) {
+    __m128 s0 = _mm_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+        s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4) s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    s0 = _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3));
+    return c_hsum_sse2(s0) + c_f32_dot_scalar(a + i, b + i, n - i);
+}
+
+// AVX2
+
+C_TARGET("avx2,fma") static void c_f32_clamp_avx2(const float32 *in, float32 *out, size_t n, float32 min, float32 max) {
+    __m256 lo = _mm256_set1_ps(min), hi = _mm256_set1_ps(max);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), lo), hi));
+    c_f32_clamp_scalar(in + i, out + i, n - i, min, max);
+}
+
+C_TARGET("avx2,fma") static void c_f32_scale_add_avx2(const float32 *in, float32 *out, size_t n, float32 scale, float32 add) {
+    __m256 s = _mm256_set1_ps(scale), a = _mm256_set1_ps(add);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_fmadd_ps(_mm256_loadu_ps(in + i), s, a));
+    c_f32_scale_add_scalar(in + i, out + i, n - i, scale, add);
+}
+
+C_TARGET("avx2,fma") static void c_f32_lerp_avx2(const float32 *a, const float32 *b, float32 *out, size_t n, float32 t) {
+    __m256 vt = _mm256_set1_ps(t);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), va), vt, va));
+    }
+    c_f32_lerp_scalar(a + i, b + i, out + i, n - i, t);
+}
+
+C_TARGET("avx2,fma") static void c_f32_add_avx2(const float32 *a, const float32 *b, float32 *out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    c_f32_add_scalar(a + i, b + i, out + i, n - i);
+}
+
+C_TARGET("avx2,fma") static float32 c_f32_min_avx2(const float32 *in, size_t n) {
+    __m256 m0 = _mm256_set1_ps(INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        m0 = _mm256_min_ps(m0, _mm256_loadu_ps(in + i));
+        m1 = _mm256_min_ps(m1, _mm256_loadu_ps(in + i + 8));
+    }
+    m0 = _mm256_min_ps(m0, m1);
+    __m128 m = _mm_min_ps(_mm256_castps256_ps128(m0), _mm256_extractf128_ps(m0, 1));
+    m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+    float32 tail = c_f32_min_scalar(in + i, n - i);
+    float32 v = _mm_cvtss_f32(m);
+    return tail < v ? tail : v;
+}
+
+C_TARGET("avx2,fma") static float32 c_f32_max_avx2(const float32 *in, size_t n) {
+    __m256 m0 = _mm256_set1_ps(-INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        m0 = _mm256_max_ps(m0, _mm256_loadu_ps(in + i));
+        m1 = _mm256_max_ps(m1, _mm256_loadu_ps(in + i + 8));
+    }
+    m0 = _mm256_max_ps(m0, m1);
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(m0), _mm256_extractf128_ps(m0, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    float32 tail = c_f32_max_scalar(in + i, n - i);
+    float32 v = _mm_cvtss_f32(m);
+    return tail > v ? tail : v;
+}
+
+C_TARGET("avx2,fma") static inline float32 c_hsum_avx2(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+C_TARGET("avx2,fma") static float32 c_f32_sum_avx2(const float32 *in, size_t n) {
+    __m256 s0 = _mm256_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm256_add_ps(s0, _mm256_loadu_ps(in + i));
+        s1 = _mm256_add_ps(s1, _mm256_loadu_ps(in + i + 8));
+        s2 = _mm256_add_ps(s2, _mm256_loadu_ps(in + i + 16));
+        s3 = _mm256_add_ps(s3, _mm256_loadu_ps(in + i + 24));
+    }
+    for (; i + 8 <= n; i += 8) s0 = _mm256_add_ps(s0, _mm256_loadu_ps(in + i));
+    s0 = _mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3));
+    return c_hsum_avx2(s0) + c_f32_sum_scalar(in + i, n - i);
+}
+
+C_TARGET("avx2,fma") static float32 c_f32_dot_avx2(const float32 *a, const float32 *b, size_t n) {
+    __m256 s0 = _mm256_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+        s2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), s2);
+        s3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), s3);
+    }
+    for (; i + 8 <= n; i += 8) s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+    s0 = _mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3));
+    return c_hsum_avx2(s0) + c_f32_dot_scalar(a + i, b + i, n - i);
+}
+
+// AVX-512
+
+C_TARGET("avx512f") static void c_f32_clamp_avx512(const float32 *in, float32 *out, size_t n, float32 min, float32 max) {
+    __m512 lo = _mm512_set1_ps(min), hi = _mm512_set1_ps(max);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(in + i), lo), hi));
+    c_f32_clamp_scalar(in + i, out + i, n - i, min, max);
+}
+
+C_TARGET("avx512f") static void c_f32_scale_add_avx512(const float32 *in, float32 *out, size_t n, float32 scale, float32 add) {
+    __m512 s = _mm512_set1_ps(scale), a = _mm512_set1_ps(add);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_fmadd_ps(_mm512_loadu_ps(in + i), s, a));
+    c_f32_scale_add_scalar(in + i, out + i, n - i, scale, add);
+}
+
+C_TARGET("avx512f") static void c_f32_lerp_avx512(const float32 *a, const float32 *b, float32 *out, size_t n, float32 t) {
+    __m512 vt = _mm512_set1_ps(t);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_loadu_ps(a + i);
+        _mm512_storeu_ps(out + i, _mm512_fmadd_ps(_mm512_sub_ps(_mm512_loadu_ps(b + i), va), vt, va));
+    }
+    c_f32_lerp_scalar(a + i, b + i, out + i, n - i, t);
+}
+
+C_TARGET("avx512f") static void c_f32_add_avx512(const float32 *a, const float32 *b, float32 *out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    c_f32_add_scalar(a + i, b + i, out + i, n - i);
+}
+
+C_TARGET("avx512f") static float32 c_f32_min_avx512(const float32 *in, size_t n) {
+    __m512 m0 = _mm512_set1_ps(INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        m0 = _mm512_min_ps(m0, _mm512_loadu_ps(in + i));
+        m1 = _mm512_min_ps(m1, _mm512_loadu_ps(in + i + 16));
+    }
+    float32 v = _mm512_reduce_min_ps(_mm512_min_ps(m0, m1));
+    float32 tail = c_f32_min_scalar(in + i, n - i);
+    return tail < v ? tail : v;
+}
+
+C_TARGET("avx512f") static float32 c_f32_max_avx512(const float32 *in, size_t n) {
+    __m512 m0 = _mm512_set1_ps(-INFINITY), m1 = m0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        m0 = _mm512_max_ps(m0, _mm512_loadu_ps(in + i));
+        m1 = _mm512_max_ps(m1, _mm512_loadu_ps(in + i + 16));
+    }
+    float32 v = _mm512_reduce_max_ps(_mm512_max_ps(m0, m1));
+    float32 tail = c_f32_max_scalar(in + i, n - i);
+    return tail > v ? tail : v;
+}
+
+C_TARGET("avx512f") static float32 c_f32_sum_avx512(const float32 *in, size_t n) {
+    __m512 s0 = _mm512_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        s0 = _mm512_add_ps(s0, _mm512_loadu_ps(in + i));
+        s1 = _mm512_add_ps(s1, _mm512_loadu_ps(in + i + 16));
+        s2 = _mm512_add_ps(s2, _mm512_loadu_ps(in + i + 32));
+        s3 = _mm512_add_ps(s3, _mm512_loadu_ps(in + i + 48));
+    }
+    for (; i + 16 <= n; i += 16) s0 = _mm512_add_ps(s0, _mm512_loadu_ps(in + i));
+    s0 = _mm512_add_ps(_mm512_add_ps(s0, s1), _mm512_add_ps(s2, s3));
+    return _mm512_reduce_add_ps(s0) + c_f32_sum_scalar(in + i, n - i);
+}
+
+C_TARGET("avx512f") static float32 c_f32_dot_avx512(const float32 *a, const float32 *b, size_t n) {
+    __m512 s0 = _mm512_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), s1);
+        s2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32), s2);
+        s3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48), s3);
+    }
+    for (; i + 16 <= n; i += 16) s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), s0);
+    s0 = _mm512_add_ps(_mm512_add_ps(s0, s1), _mm512_add_ps(s2, s3));
+    return _mm512_reduce_add_ps(s0) + c_f32_dot_scalar(a + i, b + i, n - i);
+}
+#endif // C_KERNELS_X86
+
+#define C_F32_KERNELS(isa) {\
+        c_f32_clamp_##isa, c_f32_scale_add_##isa, c_f32_lerp_##isa, c_f32_add_##isa,\
+        c_f32_min_##isa, c_f32_max_##isa, c_f32_sum_##isa, c_f32_dot_##isa,\
+    }
+
+static const c_F32_kernels c_f32_kernels[C_SIMD_LEVEL_COUNT] = {
+    [C_SIMD_LEVEL_SCALAR] = C_F32_KERNELS(scalar),
+#ifdef C_KERNELS_X86
+    [C_SIMD_LEVEL_SSE2]   = C_F32_KERNELS(sse2),
+    [C_SIMD_LEVEL_AVX2]   = C_F32_KERNELS(avx2),
+    [C_SIMD_LEVEL_AVX512] = C_F32_KERNELS(avx512),
+#else
+    [C_SIMD_LEVEL_SSE2]   = C_F32_KERNELS(scalar),
+    [C_SIMD_LEVEL_AVX2]   = C_F32_KERNELS(scalar),
+    [C_SIMD_LEVEL_AVX512] = C_F32_KERNELS(scalar),
+#endif // C_KERNELS_X86
+};
+
+static int64 c_simd_detected = -1; // NOTE: 64-bit for the MSVC C_ATOMIC_*
+static int64 c_simd_active = -1;
+
+c_Simd_level c_simd_detected_level(void) {
+    int64 level = C_ATOMIC_LOAD(&c_simd_detected);
+    if (level >= 0) return (c_Simd_level)level;
+
+    level = C_SIMD_LEVEL_SCALAR;
+#if defined(C_KERNELS_X86)
+    level = C_SIMD_LEVEL_SSE2;
+#if defined(_MSC_VER) && !defined(__clang__)
+    // AVX state has to be enabled by the OS too (XCR0), not just be there in the CPU
+    int regs[4];
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0, fma = (regs[2] & (1 << 12)) != 0;
+    uint64 xcr0 = osxsave ? _xgetbv(0) : 0;
+    __cpuidex(regs, 7, 0);
+    if (fma && (regs[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6) level = C_SIMD_LEVEL_AVX2;
+    if ((regs[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6) level = C_SIMD_LEVEL_AVX512;
+#else
+    // NOTE: These check that the OS saves the AVX state too
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) level = C_SIMD_LEVEL_AVX2;
+    if (__builtin_cpu_supports("avx512f")) level = C_SIMD_LEVEL_AVX512;
+#endif // defined(_MSC_VER) && !defined(__clang__)
+#endif // defined(C_KERNELS_X86)
+    C_ATOMIC_STORE(&c_simd_detected, level);
+    return (c_Simd_level)level;
+}
+
+c_Simd_level c_simd_level(void) {
+    int64 level = C_ATOMIC_LOAD(&c_simd_active);
+    if (level >= 0) return (c_Simd_level)level;
+    level = c_simd_detected_level();
+    C_ATOMIC_STORE(&c_simd_active, level);
+    return (c_Simd_level)level;
+}
+
+void c_simd_set_level(c_Simd_level level) {
+    c_Simd_level detected = c_simd_detected_level();
+    C_ATOMIC_STORE(&c_simd_active, (int64)(level < detected ? level : detected));
+}
+
+const char *c_simd_level_name(c_Simd_level level) {
+    switch (level) {
+        case C_SIMD_LEVEL_SCALAR: return "scalar";
+        case C_SIMD_LEVEL_SSE2:   return "SSE2";
+        case C_SIMD_LEVEL_AVX2:   return "AVX2";
+        case C_SIMD_LEVEL_AVX512: return "AVX-512";
+        default:                  return "unknown";
+    }
+}
+
+void c_f32_clamp(const float32 *in, float32 *out, size_t n, float32 min, float32 max) {
+    c_f32_kernels[c_simd_level()].clamp(in, out, n, min, max);
+}
+
+void c_f32_map(const float32 *in, float32 *out, size_t n, float32 from1, float32 to1, float32 from2, float32 to2) {
+    // NOTE: Folded into one multiply-add, so it can be off from c_mapf() in the last bits
+    float32 scale = (to2 - from2) / (to1 - from1);
+    c_f32_kernels[c_simd_level()].scale_add(in, out, n, scale, from2 - from1*scale);
+}
+
+void c_f32_lerp(const float32 *a, const float32 *b, float32 *out, size_t n, float32 t) {
+    c_f32_kernels[c_simd_level()].lerp(a, b, out, n, t);
+}
+
+void c_f32_scale_add(const float32 *in, float32 *out, size_t n, float32 scale, float32 add) {
+    c_f32_kernels[c_simd_level()].scale_add(in, out, n, scale, add);
+}
+
+void c_f32_add(const float32 *a, const float32 *b, float32 *out, size_t n) {
+    c_f32_kernels[c_simd_level()].add(a, b, out, n);
+}
+
+float32 c_f32_min(const float32 *in, size_t n) {
+    return c_f32_kernels[c_simd_level()].min(in, n);
+}
+
+float32 c_f32_max(const float32 *in, size_t n) {
+    return c_f32_kernels[c_simd_level()].max(in, n);
+}
+
+float32 c_f32_sum(const float32 *in, size_t n) {
+    return c_f32_kernels[c_simd_level()].sum(in, n);
+}
+
+float32 c_f32_dot(const float32 *a, const float32 *b, size_t n) {
+    return c_f32_kernels[c_simd_level()].dot(a, b, n);
+}
+
+//
+// OS
+//
+
+#include <time.h>
+
+cstr c_os_get_timedate(c_Arena* a) {
+    static C_THREAD_LOCAL time_t cached_sec = (time_t)-1;
+    static C_THREAD_LOCAL char cached[32];
+
+    time_t now = time(NULL);
+    if (now != cached_sec) {
+        struct tm tm;
+#if defined(_WIN32)
+        localtime_s(&tm, &now);
+#else
+        localtime_r(&now, &tm);
+#endif // defined(_WIN32)
+        strftime(cached, sizeof(cached), "%Y-%m-%d %H:%M:%S", &tm);
+        cached_sec = now;
+    }
+
+    size_t len = strlen(cached);
+    char *res = c_arena_alloc(a, len + 1);
+    C_MEMCPY(res, cached, len + 1);
+    return res;
+}
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+
+bool c_os_file_exists(cstr filename) {
+    return PathFileExistsA(filename);
+}
+
+#elif defined(__linux__)
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <string.h>
+
+bool c_os_file_exists(cstr filename) {
+        struct stat buf;
+        return stat(filename, &buf) == 0;
+}
+
+#endif
+
+c_String_array c_os_list_files(cstr dir) {
+    c_String_array res = {0};
+    c_Dir_walk walk = {0};
+    if (!c_dir_walk(&walk, dir, 0, NULL, NULL)) return res;
+
+    for (size_t i = 0; i < walk.count; ++i) {
+        if (walk.items[i].type != C_DIR_ENTRY_FILE) continue;
+        cstr name = c_dir_entry_name(&walk, &walk.items[i]);
+        size_t len = strlen(name);
+        char *item = C_MALLOC(len + 1);
+        C_ASSERT(item != NULL, "Buy more RAM bruh");
+        C_MEMCPY(item, name, len + 1);
+        c_darr_append(res, item);
+    }
+
+    c_dir_walk_free(&walk);
+    return res;
+}
+
+//
+// Time
+//
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define C_HAS_TSC
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif // defined(_MSC_VER) && !defined(__clang__)
+#endif // x86
+
+uint64 c_time_now_ns(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER freq = {0};
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    // Split to not overflow
+    uint64 sec = (uint64)now.QuadPart / (uint64)freq.QuadPart;
+    uint64 rem = (uint64)now.QuadPart % (uint64)freq.QuadPart;
+    return sec*1000000000ull + rem*1000000000ull / (uint64)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64)ts.tv_sec*1000000000ull + (uint64)ts.tv_nsec;
+#endif // defined(_WIN32)
+}
+
+enum {
+    C_TSC_UNKNOWN,
+    C_TSC_USABLE,
+    C_TSC_UNUSABLE, // ticks are c_time_now_ns()
+};
+static int64 c_tsc_state = C_TSC_UNKNOWN; // NOTE: 64-bit for the MSVC C_ATOMIC_*
+// The float64 bits, so it can go through C_ATOMIC_*; 0 until calibrated
+static int64 c_ns_per_tick_bits = 0;
+static c_Mutex c_time_calibrate_lock = C_MUTEX_INIT;
+
+static void c_tsc_detect(void) {
+    int64 state = C_TSC_UNUSABLE;
+#if defined(C_HAS_TSC)
+    // CPUID.80000007H:EDX[8] is the invariant TSC bit (constant rate, keeps going in deep sleep states)
+    uint32 edx = 0;
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if ((uint32)regs[0] >= 0x80000007) {
+        __cpuid(regs, 0x80000007);
+        edx = (uint32)regs[3];
+    }
+#else
+    uint32 eax, ebx, ecx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) edx = 0;
+#endif // defined(_MSC_VER) && !defined(__clang__)
+    if (edx & (1u << 8)) state = C_TSC_USABLE;
+#endif // defined(C_HAS_TSC)
+    C_ATOMIC_STORE(&c_tsc_state, state);
+}
+
+uint64 c_time_ticks(void) {
+    int64 state = C_ATOMIC_LOAD(&c_tsc_state);
+    if (state == C_TSC_UNKNOWN) {
+        c_tsc_detect();
+        state = C_ATOMIC_LOAD(&c_tsc_state);
+    }
+#if defined(C_HAS_TSC)
+    if (state == C_TSC_USABLE) return __rdtsc();
+#endif // defined(C_HAS_TSC)
+    return c_time_now_ns();
+}
+
+// NOTE: Call with c_time_calibrate_lock held
+static void c_time_calibrate_locked(void) {
+    float64 ns_per_tick = 1.0;
+    if (C_ATOMIC_LOAD(&c_tsc_state) == C_TSC_UNKNOWN) c_tsc_detect();
+    if (C_ATOMIC_LOAD(&c_tsc_state) == C_TSC_USABLE) {
+        uint64 ns_start = c_time_now_ns();
+        uint64 ticks_start = c_time_ticks();
+        uint64 ns_end;
+        do {
+            ns_end = c_time_now_ns();
+        } while (ns_end - ns_start < 10000000ull);
+        uint64 ticks_end = c_time_ticks();
+        ns_per_tick = (float64)(ns_end - ns_start) / (float64)(ticks_end - ticks_start);
+    }
+
+    int64 bits;
+    C_MEMCPY(&bits, &ns_per_tick, sizeof(bits));
+    C_ATOMIC_STORE(&c_ns_per_tick_bits, bits);
+}
+
+void c_time_calibrate(void) {
+    c_mutex_lock(&c_time_calibrate_lock);
+    c_time_calibrate_locked();
+    c_mutex_unlock(&c_time_calibrate_lock);
+}
+
+uint64 c_ticks_to_ns(uint64 ticks) {
+    int64 bits = C_ATOMIC_LOAD(&c_ns_per_tick_bits);
+    if (bits == 0) {
+        // Only the first caller spends the ~10ms, the others wait for its result
+        c_mutex_lock(&c_time_calibrate_lock);
+        bits = C_ATOMIC_LOAD(&c_ns_per_tick_bits);
+        if (bits == 0) {
+            c_time_calibrate_locked();
+            bits = C_ATOMIC_LOAD(&c_ns_per_tick_bits);
+        }
+        c_mutex_unlock(&c_time_calibrate_lock);
+    }
+    float64 ns_per_tick;
+    C_MEMCPY(&ns_per_tick, &bits, sizeof(ns_per_tick));
+    return (uint64)((float64)ticks * ns_per_tick);
+}
+
+void c_stopwatch_start(c_Stopwatch *sw) {
+    if (sw->running) return;
+    sw->start = c_time_ticks();
+    sw->running = true;
+}
+
+void c_stopwatch_stop(c_Stopwatch *sw) {
+    if (!sw->running) return;
+    sw->elapsed += c_time_ticks() - sw->start;
+    sw->running = false;
+}
+
+void c_stopwatch_reset(c_Stopwatch *sw) {
+    sw->start = 0;
+    sw->elapsed = 0;
+    sw->running = false;
+}
+
+uint64 c_stopwatch_elapsed_ns(const c_Stopwatch *sw) {
+    uint64 ticks = sw->elapsed;
+    if (sw->running) ticks += c_time_ticks() - sw->start;
+    return c_ticks_to_ns(ticks);
+}
+
+uint64 c_stopwatch_lap_ns(c_Stopwatch *sw) {
+    uint64 now = c_time_ticks();
+    uint64 ticks = sw->elapsed + (sw->running ? now - sw->start : 0);
+    sw->elapsed = 0;
+    sw->start = now;
+    sw->running = true;
+    return c_ticks_to_ns(ticks);
+}
+
+// simple and dirty way to have defering in C (not recommended to use!)
+#define defer(ret_val) \
+    result = ret_val;\
+    goto defer
+
+const char *c_read_file(const char* filename, int *file_size) {
+    FILE* f = fopen(filename, "rb");
+    char* result = NULL;
+
+    if (f == NULL){
+        c_log_error("'%s': %s", filename, strerror(errno));
+        defer(NULL);
+    }
+
+    if (fseek(f, 0, SEEK_END) < 0) {
+        c_log_error("'%s': %s", filename, strerror(errno));
+        defer(NULL);
+    }
+
+    size_t fsize = ftell(f);
+
+    if (fsize == (size_t)-1){
+        c_log_error("'%s': %s", filename, strerror(errno));
+        defer(NULL);
+    }
+
+    result = C_MALLOC(sizeof(char)*(fsize+1));
+
+    if (result == NULL){
+        c_log_error("'%s': %s", filename, strerror(errno));
+        defer(NULL);
+    }
+
+    if (fseek(f, 0, SEEK_SET) < 0) {
+        c_log_error("'%s': %s", filename, strerror(errno));
+        C_FREE(result);
+        defer(NULL);
+    }
+
+    size_t read = fread((char*)result, sizeof(char), fsize, f);
+
+    // Remove '\r' characters in place, starting from the first one
+    size_t j = read;
+    char *cr = memchr(result, '\r', read);
+    if (cr != NULL) {
+        j = (size_t)(cr - result);
+        for (size_t i = j; i < read; i++) {
+            if (result[i] != '\r') result[j++] = result[i];
+        }
+    }
+    result[j] = '\0';
+
+    *file_size = (int)j; // the file size without '\r'
+
+ defer:
+    if (f) fclose(f);
+    if (result == NULL) *file_size = -1;
+    return result;
+}
+
+void c_touch_file_if_doesnt_exist(cstr filename) {
+        if (c_os_file_exists(filename)) return;
+        FILE* file = fopen(filename, "w");
+        if (file) fclose(file);
+}
+
+#if defined(_WIN32)
+c_String_view c_map_file(cstr filename, int hints) {
+    c_String_view res = {0};
+
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              (hints & C_MAP_SEQUENTIAL) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        c_log_error("'%s': Failed to open file (error %lu)", filename, GetLastError());
+        return res;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        c_log_error("'%s': Failed to get the file size (error %lu)", filename, GetLastError());
+        CloseHandle(file);
+        return res;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        res.data = (char *)"";
+        return res;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        c_log_error("'%s': Failed to map file (error %lu)", filename, GetLastError());
+        return res;
+    }
+
+    res.data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (res.data == NULL) {
+        c_log_error("'%s': Failed to map file (error %lu)", filename, GetLastError());
+        return res;
+    }
+    res.count = (size_t)size.QuadPart;
+    return res;
+}
+
+void c_unmap_file(c_String_view sv) {
+    if (sv.data == NULL || sv.count == 0) return;
+    UnmapViewOfFile(sv.data);
+}
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+c_String_view c_map_file(cstr filename, int hints) {
+    c_String_view res = {0};
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        c_log_error("'%s': %s", filename, strerror(errno));
+        return res;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        c_log_error("'%s': %s", filename, strerror(errno));
+        close(fd);
+        return res;
+    }
+
+    // mmap() doesn't like empty mappings
+    if (st.st_size == 0) {
+        close(fd);
+        res.data = (char *)"";
+        return res;
+    }
+
+    void *mem = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // NOTE: The mapping keeps its own reference to the file
+    close(fd);
+    if (mem == MAP_FAILED) {
+        c_log_error("'%s': %s", filename, strerror(errno));
+        return res;
+    }
+
+    // NOTE: posix_madvise() instead of madvise(), the MADV_* are not declared in strict ISO C modes
+#ifdef POSIX_MADV_SEQUENTIAL
+    if (hints & C_MAP_SEQUENTIAL) posix_madvise(mem, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    if (hints & C_MAP_RANDOM)     posix_madvise(mem, (size_t)st.st_size, POSIX_MADV_RANDOM);
+    if (hints & C_MAP_WILLNEED)   posix_madvise(mem, (size_t)st.st_size, POSIX_MADV_WILLNEED);
+#else
+    (void)hints;
+#endif // POSIX_MADV_SEQUENTIAL
+
+    res.data = mem;
+    res.count = (size_t)st.st_size;
+    return res;
+}
+
+void c_unmap_file(c_String_view sv) {
+    if (sv.data == NULL || sv.count == 0) return;
+    munmap(sv.data, sv.count);
+}
+#endif // _WIN32
+
+// c_Mdarr
+
+#if defined(_WIN32)
+static bool c_mdarr_file_open(c_Mdarr_file *f, cstr path, uint64 *size) {
+    f->handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f->handle == INVALID_HANDLE_VALUE) {
+        c_log_error("'%s': Failed to open file (error %lu)", path, GetLastError());
+        return false;
+    }
+    LARGE_INTEGER s;
+    if (!GetFileSizeEx(f->handle, &s)) {
+        c_log_error("'%s': Failed to get the file size (error %lu)", path, GetLastError());
+        CloseHandle(f->handle);
+        return false;
+    }
+    *size = (uint64)s.QuadPart;
+    return true;
+}
+
+static void c_mdarr_file_close(c_Mdarr_file *f) {
+    if (f->base) UnmapViewOfFile(f->base);
+    if (f->mapping) CloseHandle(f->mapping);
+    CloseHandle(f->handle);
+}
+
+// NOTE: Mapping more than the file size makes the file that big
+// NOTE: The old mapping is only released once the new one is in place, so it stays usable on failure.
+static bool c_mdarr_map(c_Mdarr_file *f, size_t size) {
+    HANDLE mapping = CreateFileMappingA(f->handle, NULL, PAGE_READWRITE, (DWORD)((uint64)size >> 32), (DWORD)size, NULL);
+    if (mapping == NULL) {
+        c_log_error("Failed to map the array file (error %lu)", GetLastError());
+        return false;
+    }
+    void *base = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (base == NULL) {
+        c_log_error("Failed to map the array file (error %lu)", GetLastError());
+        CloseHandle(mapping);
+        return false;
+    }
+
+    if (f->base) UnmapViewOfFile(f->base);
+    if (f->mapping) CloseHandle(f->mapping);
+    f->mapping = mapping;
+    f->base = base;
+    f->mapped_size = size;
+    return true;
+}
+
+static bool c_mdarr_flush(c_Mdarr_file *f) {
+    return FlushViewOfFile(f->base, f->mapped_size) && FlushFileBuffers(f->handle);
+}
+#else
+static bool c_mdarr_file_open(c_Mdarr_file *f, cstr path, uint64 *size) {
+    f->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (f->fd < 0) {
+        c_log_error("'%s': %s", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(f->fd, &st) < 0) {
+        c_log_error("'%s': %s", path, strerror(errno));
+        close(f->fd);
+        return false;
+    }
+    *size = (uint64)st.st_size;
+    return true;
+}
+
+static void c_mdarr_file_close(c_Mdarr_file *f) {
+    if (f->base) munmap(f->base, f->mapped_size);
+    close(f->fd);
+}
+
+// NOTE: The old mapping is only released once the new one is in place, so it stays usable on failure.
+static bool c_mdarr_map(c_Mdarr_file *f, size_t size) {
+    if (ftruncate(f->fd, (off_t)size) < 0) {
+        c_log_error("Failed to grow the array file: %s", strerror(errno));
+        return false;
+    }
+
+    void *mem;
+#if defined(MREMAP_MAYMOVE)
+    // NOTE: glibc only has mremap() with _GNU_SOURCE defined before the first #include.
+    if (f->base) mem = mremap(f->base, f->mapped_size, size, MREMAP_MAYMOVE);
+    else mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, f->fd, 0);
+#else
+    // Both views are of the same MAP_SHARED file, so nothing written through the old one is lost
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, f->fd, 0);
+    if (mem != MAP_FAILED && f->base) munmap(f->base, f->mapped_size);
+#endif // defined(MREMAP_MAYMOVE)
+    if (mem == MAP_FAILED) {
+        c_log_error("Failed to map the array file: %s", strerror(errno));
+        return false;
+    }
+    f->base = mem;
+    f->mapped_size = size;
+    return true;
+}
+
+static bool c_mdarr_flush(c_Mdarr_file *f) {
+    return msync(f->base, f->mapped_size, MS_SYNC) == 0;
+}
+#endif // defined(_WIN32)
+
+bool c_mdarr_open_impl(c_Mdarr_file *f, cstr path, size_t item_size, size_t *count, size_t *capacity) {
+    C_ASSERT(item_size > 0 && item_size <= UINT32_MAX, "Bad item size");
+    C_MEMSET(f, 0, sizeof(*f));
+    *count = 0;
+    *capacity = 0;
+
+    uint64 size = 0;
+    if (!c_mdarr_file_open(f, path, &size)) return false;
+
+    bool fresh = size == 0;
+    if (fresh) {
+        // Room for a page of items (or one big one) to start with
+        size_t first = item_size < 4096 ? 4096 / item_size * item_size : item_size;
+        size = C_MDARR_HEADER_SIZE + first;
+    } else if (size < C_MDARR_HEADER_SIZE) {
+        c_log_error("'%s': Not a mapped array (too small)", path);
+        c_mdarr_file_close(f);
+        return false;
+    }
+    if (!c_mdarr_map(f, (size_t)size)) {
+        c_mdarr_file_close(f);
+        return false;
+    }
+
+    c_Mdarr_header *h = f->base;
+    if (!fresh) {
+        // The file got its size but never its header (the first map failed or we died in between), so start over
+        static const c_Mdarr_header zero = {0};
+        fresh = memcmp(h, &zero, sizeof(zero)) == 0;
+    }
+    if (fresh) {
+        h->version = C_MDARR_VERSION;
+        h->item_size = (uint32)item_size;
+        h->count = 0;
+        C_MEMCPY(h->magic, C_MDARR_MAGIC, sizeof(h->magic));
+    } else {
+        cstr why = NULL;
+        if (memcmp(h->magic, C_MDARR_MAGIC, sizeof(h->magic)) != 0) why = "not a mapped array";
+        else if (h->version != C_MDARR_VERSION) why = "unsupported version";
+        else if (h->item_size != item_size) why = "the item size doesn't match";
+        else if (h->count > (size - C_MDARR_HEADER_SIZE) / item_size) why = "the count doesn't fit in the file";
+        if (why) {
+            c_log_error("'%s': %s", path, why);
+            c_mdarr_file_close(f);
+            return false;
+        }
+    }
+
+    *count = (size_t)h->count;
+    *capacity = (size_t)((size - C_MDARR_HEADER_SIZE) / item_size);
+    return true;
+}
+
+bool c_mdarr_reserve_impl(c_Mdarr_file *f, size_t item_size, size_t *capacity, size_t n) {
+    if (n <= *capacity) return true;
+    size_t new_capacity = *capacity * 2 > n ? *capacity * 2 : n;
+    if (!c_mdarr_map(f, C_MDARR_HEADER_SIZE + new_capacity * item_size)) return false;
+    *capacity = new_capacity;
+    return true;
+}
+
+bool c_mdarr_sync_impl(c_Mdarr_file *f, size_t count) {
+    ((c_Mdarr_header *)f->base)->count = count;
+    if (!c_mdarr_flush(f)) {
+        c_log_error("Failed to flush the array file");
+        return false;
+    }
+    return true;
+}
+
+void c_mdarr_close_impl(c_Mdarr_file *f, size_t count) {
+    if (f->base) ((c_Mdarr_header *)f->base)->count = count;
+    c_mdarr_file_close(f);
+    C_MEMSET(f, 0, sizeof(*f));
+}
+
+bool c_file_reader_open(c_File_reader *r, cstr filename, size_t buffer_size) {
+    C_MEMSET(r, 0, sizeof(*r));
+    if (buffer_size == 0) buffer_size = C_FILE_READER_DEFAULT_BUFFER_SIZE;
+
+    r->f = fopen(filename, "rb");
+    if (r->f == NULL) {
+        c_log_error("'%s': %s", filename, strerror(errno));
+        return false;
+    }
+    // We do our own buffering; this makes fread() go straight into our buffer.
+    setvbuf(r->f, NULL, _IONBF, 0);
+    // NOTE: Only a hint; Skipped where <fcntl.h> doesn't declare it (eg: strict ISO C modes)
+#if defined(__linux__) && defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fileno(r->f), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // defined(__linux__) && defined(POSIX_FADV_SEQUENTIAL)
+
+    r->buff = C_MALLOC(buffer_size);
+    C_ASSERT(r->buff != NULL, "Buy more RAM bruh");
+    r->capacity = buffer_size;
+    return true;
+}
+
+// Moves the leftover partial record to the front of the buffer and reads more after it.
+static bool c_file_reader_fill(c_File_reader *r) {
+    if (r->start > 0) {
+        size_t leftover = r->end - r->start;
+        memmove(r->buff, r->buff + r->start, leftover);
+        r->scanned -= r->start;
+        r->end = leftover;
+        r->start = 0;
+    }
+
+    if (r->end == r->capacity) {
+        r->capacity *= 2;
+        r->buff = C_REALLOC(r->buff, r->capacity);
+        C_ASSERT(r->buff != NULL, "Buy more RAM bruh");
+    }
+
+    size_t n = fread(r->buff + r->end, 1, r->capacity - r->end, r->f);
+    if (n == 0) {
+        if (ferror(r->f)) {
+            c_log_error("Failed to read file: %s", strerror(errno));
+            r->failed = true;
+        }
+        r->eof = true;
+        return false;
+    }
+    r->end += n;
+    return true;
+}
+
+static bool c_file_reader_next(c_File_reader *r, char delim, bool strip_cr, c_String_view *out) {
+    if (r->failed) return false;
+
+    for (;;) {
+        char *found = memchr(r->buff + r->scanned, delim, r->end - r->scanned);
+        if (found != NULL) {
+            out->data = r->buff + r->start;
+            out->count = (size_t)(found - out->data);
+            r->start = r->scanned = (size_t)(found - r->buff) + 1;
+            break;
+        }
+        r->scanned = r->end;
+
+        if (r->eof || !c_file_reader_fill(r)) {
+            if (r->failed || r->start == r->end) return false;
+            // Last record without a trailing delimiter
+            out->data = r->buff + r->start;
+            out->count = r->end - r->start;
+            r->start = r->scanned = r->end;
+            break;
+        }
+    }
+
+    if (strip_cr && out->count > 0 && out->data[out->count-1] == '\r') out->count--;
+    return true;
+}
+
+bool c_file_reader_next_line(c_File_reader *r, c_String_view *line) {
+    return c_file_reader_next(r, '\n', true, line);
+}
+
+bool c_file_reader_next_record(c_File_reader *r, char delim, c_String_view *record) {
+    return c_file_reader_next(r, delim, false, record);
+}
+
+void c_file_reader_close(c_File_reader *r) {
+    if (r->f) fclose(r->f);
+    C_FREE(r->buff);
+    C_MEMSET(r, 0, sizeof(*r));
+}
+
+//
+// ### Allocators ###
+//
+
+// c_Arena
+
+c_Arena c_arena_make(size_t size) {
+    c_Arena res = {0};
+    res.buff_size = size == 0 ? ARENA_BUFF_INITIAL_SIZE : size;
+    res.buff = C_MALLOC(res.buff_size);
+    res.ptr = res.buff;
+
+    C_ASSERT(res.buff, "Malloc failed?");
+
+    return res;
+}
+
+void* c_arena_alloc(c_Arena* a, size_t size) {
+    C_ASSERT(a->buff, "Bro pass an initialized arena!");
+
+    void* res = a->ptr;
+    a->ptr = (uint8*)a->ptr + size;
+
+    bool free_block_found = false;
+
+    // TODO: Check if there is a free block that can fit this
+    for (size_t i = 0; i < a->free_blocks.count; ++i) {
+        c_Mem_block free_block = a->free_blocks.items[i];
+
+        if (free_block.size >= size) {
+            res = free_block.mem;
+
+            size_t diff = free_block.size - size;
+
+            c_darr_remove_unordered(a->free_blocks, i);
+
+            if (diff > 0) {
+                c_Mem_block residue_block = {
+                    .mem = (uint8 *)free_block.mem + size,
+                    .size = diff,
+                };
+
+                c_darr_append(a->free_blocks, residue_block);
+            }
+
+            free_block_found = true;
+            break;
+        }
+    }
+
+
+    if (!free_block_found) {
+        size_t diff = (size_t)((uint8*)a->ptr - (uint8*)a->buff);
+        if (diff > a->buff_size) {
+            uint64 new_size = a->buff_size*2;
+            // NOTE: A single doubling isn't enough for allocations bigger than the whole buffer
+            while (new_size < diff) new_size *= 2;
+            c_log_info("c_Arena resized from %zu to %zu", (size_t)a->buff_size, (size_t)new_size);
+            a->buff_size = new_size;
+            a->buff = C_REALLOC(a->buff, a->buff_size);
+            C_ASSERT(a->buff != NULL, "Buy more RAM bruh");
+            a->ptr = (uint8*)a->buff + diff;
+            // NOTE: `diff` is the end of this allocation, not the start
+            res = (uint8*)a->ptr - size;
+        }
+        /* C_ASSERT((size_t)((uint8*)a->ptr - (uint8*)a->buff) <= a->buff_size); */
+    }
+
+    c_Mem_block block = {
+        .mem = res,
+        .size = size,
+    };
+
+    c_darr_append(a->alloced_blocks, block);
+
+    return res;
+}
+
+void c_arena_dealloc(c_Arena *a, void *mem) {
+    C_ASSERT(a->buff, "Bro pass an initialized arena!");
+
+    for (size_t i = 0; i < a->alloced_blocks.count; ++i) {
+        c_Mem_block block = a->alloced_blocks.items[i];
+
+        if (block.mem == mem) {
+            c_darr_append(a->free_blocks, block);
+            c_darr_remove_unordered(a->alloced_blocks, i);
+            return;
+        }
+    }
+}
+
+void c_arena_reset(c_Arena* a) {
+    a->ptr = a->buff;
+    // NOTE: Blocks from before the reset would hand out memory that's in use again
+    a->alloced_blocks.count = 0;
+    a->free_blocks.count = 0;
+}
+
+void c_arena_free(c_Arena* a) {
+    C_FREE(a->buff);
+    c_darr_free(a->alloced_blocks);
+    c_darr_free(a->free_blocks);
+}
+
+//
+// String Builder
+//
+
+void c_sb_append(c_String_builder* sb, char* data) {
+    size_t data_size = strlen(data);
+    // NOTE: Growing by a single doubling used to overflow on appends bigger than the capacity
+    c_sb_reserve(sb, data_size);
+
+    C_MEMCPY(sb->items + sb->count, data, data_size);
+    sb->count += data_size;
+}
+
+void c_sb_append_char(c_String_builder* sb, char ch) {
+    c_sb_reserve(sb, 1);
+	sb->items[sb->count++] = ch;
+}
+
+void c_sb_append_null(c_String_builder *sb) {
+	c_sb_append_char(sb, '\0');
+}
+
+void c_sb_reserve(c_String_builder *sb, size_t n) {
+    if (sb->items == NULL) {
+        sb->count = 0;
+        sb->capacity = 0;
+    }
+    size_t needed = sb->count + n;
+    C_ASSERT(needed >= sb->count, "String builder size overflow");
+    if (sb->items != NULL && needed <= sb->capacity) return;
+
+    size_t new_capacity = sb->capacity == 0 ? c_STRING_VIEW_INITIAL_CAPACITY : sb->capacity;
+    while (new_capacity < needed) new_capacity *= 2;
+
+    sb->items = C_REALLOC(sb->items, new_capacity);
+    C_ASSERT(sb->items != NULL, "Buy more RAM bruh");
+    sb->capacity = new_capacity;
+}
+
+void c_sb_free(c_String_builder *sb) {
+	if (sb->items) {
+		C_FREE(sb->items);
+		sb->items = NULL;
+	}
+}
+
+//
+// String view
+//
+
+void c_sv_print_dumb(c_String_view sv){
+    for (size_t i = 0; i < (size_t)sv.count; ++i){
+        putc(*(sv.data+i), stdout);
+    }
+}
+
+c_String_view c_sv_from_cstr(const char* cstr){
+    return (c_String_view){
+        .data = (char *)cstr,
+        .count = strlen(cstr),
+    };
+}
+
+c_String_view c_sv_lpop(c_String_view* sv, uint32 n) {
+    c_String_view res = {0};
+    if (sv->count < n) return res;
+    res.data = sv->data;
+    res.count = n;
+
+    sv->data += n;
+    sv->count -= n;
+
+    return res;
+}
+
+c_String_view c_sv_lpop_until_predicate(c_String_view* sv, int(*predicate)(int)){
+    const char* old_sv_data = sv->data;
+    while (sv->count > 0 && !predicate(*sv->data)){
+        sv->data++;
+        sv->count--;
+    }
+
+    return (c_String_view){
+        .data = sv->data - (sv->data - old_sv_data),
+        .count = (sv->data - old_sv_data),
+    };
+}
+
+c_String_view c_sv_lpop_until_string(c_String_view* sv, const char *string) {
+    size_t string_len = strlen(string);
+
+    char *old_sv_data = sv->data;
+
+    while (sv->count > string_len) {
+        bool matched = true;
+        for (size_t i = 0; i < string_len; ++i) {
+            if (sv->data[i] != string[i]) matched = false;
+        }
+        if (matched) break;
+        sv->data++;
+        sv->count--;
+    }
+
+    return (c_String_view) {
+        .data = old_sv_data,
+        .count = (sv->data - old_sv_data),
+    };
+}
+
+c_String_view c_sv_rpop_until_predicate(c_String_view* sv, int(*predicate)(int)){
+    size_t old_sv_count = sv->count;
+    while (sv->count > 0 && !predicate(*(sv->data+sv->count-1))){
+        sv->count--;
+    }
+
+    return (c_String_view){
+        .data = sv->data + sv->count,
+        .count = old_sv_count - sv->count,
+    };
+}
+
+c_String_view c_sv_lpop_until_char(c_String_view* sv, char ch){
+    const char* old_sv_data = sv->data;
+    while (sv->count > 0 && *sv->data != ch){
+        sv->data++;
+        sv->count--;
+    }
+
+    return (c_String_view){
+        .data = sv->data - (sv->data - old_sv_data),
+        .count = (sv->data - old_sv_data),
+    };
+}
+
+c_String_view c_sv_rpop_until_char(c_String_view* sv, char ch){
+    size_t old_sv_count = sv->count;
+    while (sv->count > 0 && *(sv->data+sv->count-1) != ch){
+        sv->count--;
+    }
+
+    return (c_String_view){
+        .data = sv->data + sv->count,
+        .count = old_sv_count - sv->count,
+    };
+}
+
+void c_sv_lremove(c_String_view* sv, size_t n){
+    if (n > sv->count) n = sv->count;
+
+    sv->data += n;
+    sv->count -= n;
+}
+
+void c_sv_rremove(c_String_view* sv, size_t n){
+    if (n > sv->count)
+        sv->count = 0;
+    else
+        sv->count -= n;
+}
+
+void c_sv_lremove_until_char(c_String_view* sv, char ch){
+    while (sv->count > 0 && *sv->data != ch){
+        sv->data++;
+        sv->count--;
+    }
+}
+
+void c_sv_rremove_until_char(c_String_view* sv, char ch){
+    while (sv->count > 0 && *(sv->data+sv->count-1) != ch){
+        sv->count--;
+    }
+}
+
+void c_sv_lremove_until_char_after(c_String_view* sv, char ch){
+    while (sv->count > 0 && *(sv->data-1) != ch){
+        sv->data++;
+        sv->count--;
+    }
 }
 
 void c_sv_rremove_until_char_after(c_String_view* sv, char ch){
@@ -1026,195 +4343,4687 @@ void c_sv_rremove_until_char_after(c_String_view* sv, char ch){
     }
 }
 
-void c_sv_ltrim(c_String_view* sv){
-    while (sv->count > 0 && isspace(*sv->data)){
-        sv->data++;
-        sv->count--;
+// NOTE: isspace() depends on the locale and is UB for negative chars (any non-ASCII UTF-8 byte)
+static inline bool c_is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+void c_sv_ltrim(c_String_view* sv){
+    while (sv->count > 0 && c_is_space(*sv->data)){
+        sv->data++;
+        sv->count--;
+    }
+}
+
+void c_sv_rtrim(c_String_view* sv){
+    while (sv->count > 0 && c_is_space(*(sv->data+sv->count-1))){
+        sv->count--;
+    }
+}
+
+void c_sv_trim(c_String_view* sv){
+    c_sv_ltrim(sv);
+    c_sv_rtrim(sv);
+}
+
+char* c_sv_to_cstr(c_String_view sv){
+    char* res = (char*)C_MALLOC(sizeof(char)*(sv.count + 1));
+    if (res == NULL) {
+        C_ASSERT(false, "Buy more RAM bruh");
+    }
+    C_MEMCPY(res, sv.data, sv.count);
+    res[sv.count] = '\0';
+    return res;
+}
+
+int64 c_sv_to_int(c_String_view sv, int *count_out, int base) {
+    char *str = c_sv_to_cstr(sv);
+
+    char *endptr = NULL;
+
+    int64 res = strtol(str, &endptr, base);
+
+    if (endptr == str) {
+        *count_out = -1;
+        return res;
+    }
+
+    *count_out = (int)(endptr - str);
+
+    C_FREE(str);
+    return res;
+}
+
+uint64 c_sv_to_uint(c_String_view sv, int *count, int base) {
+    char* str = c_sv_to_cstr(sv);
+
+    char *endptr = NULL;
+    uint64 res = strtoul(str, &endptr, base);
+
+    if (endptr == str) {
+        *count = -1;
+        return res;
+    }
+
+    *count = (int)(endptr - str);
+
+    C_FREE(str);
+    return res;
+}
+
+float64 c_sv_to_float(c_String_view sv, int *count) {
+    char* str = c_sv_to_cstr(sv);
+
+    char *endptr = NULL;
+    float64 res = strtod(str, &endptr);
+
+    if (endptr == str) {
+        *count = -1;
+        return res;
+    }
+
+    *count = (int)(endptr - str);
+
+    C_FREE(str);
+    return res;
+}
+
+bool c_sv_contains_char(c_String_view sv, char ch){
+    for (size_t i = 0; i < sv.count; ++i){
+        if (sv.data[i] == ch) return true;
+    }
+    return false;
+}
+
+// Holds (value + 1) for every hex digit, 0 means not a hex digit.
+static const uint8 c_hex_values[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,
+    ['5'] = 6,  ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+};
+
+bool c_sv_is_hex_numbers(c_String_view sv) {
+    if (sv.count == 0) return false;
+    for (size_t i = 0; i < sv.count; ++i) {
+        if (c_hex_values[(uint8)sv.data[i]] == 0) return false;
+    }
+    return true;
+}
+
+bool c_sv_equals(c_String_view sv1, c_String_view sv2) {
+    if (sv1.count != sv2.count) return false;
+    for (size_t i = 0; i < sv1.count; ++i) {
+        if (sv1.data[i] != sv2.data[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+c_String_view c_sv_get_part(c_String_view sv, int from, int to) {
+    from = c_clampi(from, 0, sv.count);
+    to   = c_clampi(to, from, sv.count);
+
+    c_String_view range = {
+        .data = (char*)(sv.data + from),
+        .count = (size_t)(to - from),
+    };
+
+    return range;
+}
+
+bool c_sv_lpop_arg(c_String_view *sv, c_String_view *out) {
+    c_sv_trim(sv);
+    if (sv->count == 0) return false;
+
+    // If starts with a quote, consume until matching quote (allowing backslash escapes).
+    char start = sv->data[0];
+    if (start == '"' || start == '\'') {
+        // skip opening quote
+        sv->data++;
+        sv->count--;
+        const char *start_ptr = sv->data;
+        size_t out_count = 0;
+
+        while (sv->count > 0) {
+            char c = *sv->data;
+            if (c == '\\' && sv->count > 1) {
+                // skip backslash, take next char literally
+                sv->data++;
+                sv->count--;
+                sv->data++; sv->count--;
+                out_count += 1;
+                continue;
+            }
+            if (c == start) {
+                // closing quote found; advance past it and finish
+                sv->data++;
+                sv->count--;
+                break;
+            }
+            sv->data++;
+            sv->count--;
+            out_count++;
+        }
+
+        *out = (c_String_view){ .data = (char*)start_ptr, .count = out_count };
+        return true;
+    }
+
+    // Unquoted: pop until next space
+    const char *start_ptr = sv->data;
+    while (sv->count > 0 && *sv->data != ' ') {
+        sv->data++;
+        sv->count--;
+    }
+    *out = (c_String_view){ .data = (char*)start_ptr, .count = (size_t)(sv->data - start_ptr) };
+    return true;
+}
+
+size_t c_sv_count_char(c_String_view sv, char ch) {
+    size_t count = 0;
+    size_t i = 0;
+
+#ifdef C_SIMD_SSE2
+    __m128i needle = _mm_set1_epi8(ch);
+    for (; i + 16 <= sv.count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(sv.data + i));
+        count += c_popcount32((uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+    }
+#endif // C_SIMD_SSE2
+
+    for (; i < sv.count; ++i) {
+        count += sv.data[i] == ch;
+    }
+    return count;
+}
+
+//
+// String
+//
+
+bool c_str_starts_with(const char *str, const char *suffix) {
+    if (str == NULL) return false;
+    while (*str != 0 && *suffix != 0) {
+        if (*suffix++ != *str++) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//
+// Encoding (Hex, Base64)
+//
+
+static const char c_hex_chars[] = "0123456789abcdef";
+
+#ifdef C_SIMD_SSE2
+// 0..15 -> '0'..'9', 'a'..'f'
+static inline __m128i c_hex_nibbles_to_ascii(__m128i n) {
+    __m128i letter = _mm_cmpgt_epi8(n, _mm_set1_epi8(9));
+    __m128i res = _mm_add_epi8(n, _mm_set1_epi8('0'));
+    return _mm_add_epi8(res, _mm_and_si128(letter, _mm_set1_epi8('a' - '0' - 10)));
+}
+
+// '0'..'9', 'a'..'f', 'A'..'F' -> 0..15; `valid` gets 0xFF for every hex char.
+static inline __m128i c_hex_ascii_to_nibbles(__m128i c, __m128i *valid) {
+    __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(d, _mm_set1_epi8(-1)), _mm_cmplt_epi8(d, _mm_set1_epi8(10)));
+    __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(l, _mm_set1_epi8(-1)), _mm_cmplt_epi8(l, _mm_set1_epi8(6)));
+    *valid = _mm_or_si128(is_digit, is_letter);
+    return _mm_or_si128(_mm_and_si128(d, is_digit),
+                        _mm_and_si128(_mm_add_epi8(l, _mm_set1_epi8(10)), is_letter));
+}
+
+// 16 nibbles (hi, lo, hi, lo, ...) -> 8 bytes in the low half of each 16-bit lane
+static inline __m128i c_hex_pack_nibbles(__m128i n) {
+    __m128i packed = _mm_or_si128(_mm_slli_epi16(n, 4), _mm_srli_epi16(n, 8));
+    return _mm_and_si128(packed, _mm_set1_epi16(0x00FF));
+}
+#endif // C_SIMD_SSE2
+
+size_t c_hex_encode(const void *data, size_t size, char *out) {
+    const uint8 *in = (const uint8 *)data;
+    size_t i = 0;
+
+#ifdef C_SIMD_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+        __m128i lo = _mm_and_si128(bytes, _mm_set1_epi8(0x0F));
+        hi = c_hex_nibbles_to_ascii(hi);
+        lo = c_hex_nibbles_to_ascii(lo);
+        _mm_storeu_si128((__m128i *)(out + i*2),      _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(out + i*2 + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#endif // C_SIMD_SSE2
+
+    for (; i < size; ++i) {
+        out[i*2]     = c_hex_chars[in[i] >> 4];
+        out[i*2 + 1] = c_hex_chars[in[i] & 0x0F];
+    }
+
+    return size*2;
+}
+
+bool c_hex_decode(c_String_view hex, void *out, size_t *out_size) {
+    uint8 *o = (uint8 *)out;
+    const uint8 *in = (const uint8 *)hex.data;
+    size_t n = hex.count / 2;
+    size_t i = 0;
+
+#ifdef C_SIMD_SSE2
+    for (; i + 16 <= n; i += 16) {
+        __m128i valid_a, valid_b;
+        __m128i a = c_hex_ascii_to_nibbles(_mm_loadu_si128((const __m128i *)(in + i*2)), &valid_a);
+        __m128i b = c_hex_ascii_to_nibbles(_mm_loadu_si128((const __m128i *)(in + i*2 + 16)), &valid_b);
+        // Let the scalar loop find the exact offending char
+        if (_mm_movemask_epi8(_mm_and_si128(valid_a, valid_b)) != 0xFFFF) break;
+        _mm_storeu_si128((__m128i *)(o + i), _mm_packus_epi16(c_hex_pack_nibbles(a), c_hex_pack_nibbles(b)));
+    }
+#endif // C_SIMD_SSE2
+
+    for (; i < n; ++i) {
+        uint8 hi = c_hex_values[in[i*2]];
+        uint8 lo = c_hex_values[in[i*2 + 1]];
+        if (hi == 0 || lo == 0) {
+            if (out_size) *out_size = i;
+            return false;
+        }
+        o[i] = (uint8)(((hi - 1) << 4) | (lo - 1));
+    }
+
+    if (out_size) *out_size = n;
+    return hex.count % 2 == 0;
+}
+
+static const char c_base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Holds (value + 1) for every base64 char, 0 means not a base64 char.
+static const uint8 c_base64_values[256] = {
+    ['A'] = 1,  ['B'] = 2,  ['C'] = 3,  ['D'] = 4,  ['E'] = 5,  ['F'] = 6,  ['G'] = 7,  ['H'] = 8,
+    ['I'] = 9,  ['J'] = 10, ['K'] = 11, ['L'] = 12, ['M'] = 13, ['N'] = 14, ['O'] = 15, ['P'] = 16,
+    ['Q'] = 17, ['R'] = 18, ['S'] = 19, ['T'] = 20, ['U'] = 21, ['V'] = 22, ['W'] = 23, ['X'] = 24,
+    ['Y'] = 25, ['Z'] = 26, ['a'] = 27, ['b'] = 28, ['c'] = 29, ['d'] = 30, ['e'] = 31, ['f'] = 32,
+    ['g'] = 33, ['h'] = 34, ['i'] = 35, ['j'] = 36, ['k'] = 37, ['l'] = 38, ['m'] = 39, ['n'] = 40,
+    ['o'] = 41, ['p'] = 42, ['q'] = 43, ['r'] = 44, ['s'] = 45, ['t'] = 46, ['u'] = 47, ['v'] = 48,
+    ['w'] = 49, ['x'] = 50, ['y'] = 51, ['z'] = 52, ['0'] = 53, ['1'] = 54, ['2'] = 55, ['3'] = 56,
+    ['4'] = 57, ['5'] = 58, ['6'] = 59, ['7'] = 60, ['8'] = 61, ['9'] = 62, ['+'] = 63, ['/'] = 64,
+};
+
+size_t c_base64_encode(const void *data, size_t size, char *out) {
+    const uint8 *in = (const uint8 *)data;
+    char *o = out;
+    size_t i = 0;
+
+    for (; i + 3 <= size; i += 3) {
+        uint32 v = ((uint32)in[i] << 16) | ((uint32)in[i+1] << 8) | in[i+2];
+        o[0] = c_base64_chars[(v >> 18) & 0x3F];
+        o[1] = c_base64_chars[(v >> 12) & 0x3F];
+        o[2] = c_base64_chars[(v >> 6) & 0x3F];
+        o[3] = c_base64_chars[v & 0x3F];
+        o += 4;
+    }
+
+    size_t rem = size - i;
+    if (rem > 0) {
+        uint32 v = (uint32)in[i] << 16;
+        if (rem == 2) v |= (uint32)in[i+1] << 8;
+        o[0] = c_base64_chars[(v >> 18) & 0x3F];
+        o[1] = c_base64_chars[(v >> 12) & 0x3F];
+        o[2] = rem == 2 ? c_base64_chars[(v >> 6) & 0x3F] : '=';
+        o[3] = '=';
+        o += 4;
+    }
+
+    return (size_t)(o - out);
+}
+
+bool c_base64_decode(c_String_view b64, void *out, size_t *out_size) {
+    const uint8 *in = (const uint8 *)b64.data;
+    uint8 *o = (uint8 *)out;
+    size_t n = b64.count;
+
+    if (n % 4 == 0 && n > 0 && in[n-1] == '=') {
+        n--;
+        if (in[n-1] == '=') n--;
+    }
+    if (n % 4 == 1) {
+        if (out_size) *out_size = 0;
+        return false;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32 a = c_base64_values[in[i]], b = c_base64_values[in[i+1]];
+        uint32 c = c_base64_values[in[i+2]], d = c_base64_values[in[i+3]];
+        // A zero in any of them means an invalid char, check once per quad
+        if ((a == 0) | (b == 0) | (c == 0) | (d == 0)) {
+            if (out_size) *out_size = (size_t)(o - (uint8 *)out);
+            return false;
+        }
+        uint32 v = ((a - 1) << 18) | ((b - 1) << 12) | ((c - 1) << 6) | (d - 1);
+        o[0] = (uint8)(v >> 16);
+        o[1] = (uint8)(v >> 8);
+        o[2] = (uint8)v;
+        o += 3;
+    }
+
+    size_t rem = n - i;
+    if (rem > 0) {
+        uint32 a = c_base64_values[in[i]], b = c_base64_values[in[i+1]];
+        uint32 c = rem == 3 ? c_base64_values[in[i+2]] : 1;
+        if (a == 0 || b == 0 || c == 0) {
+            if (out_size) *out_size = (size_t)(o - (uint8 *)out);
+            return false;
+        }
+        uint32 v = ((a - 1) << 18) | ((b - 1) << 12) | ((c - 1) << 6);
+        *o++ = (uint8)(v >> 16);
+        if (rem == 3) *o++ = (uint8)(v >> 8);
+    }
+
+    if (out_size) *out_size = (size_t)(o - (uint8 *)out);
+    return true;
+}
+
+void c_sb_append_hex(c_String_builder *sb, const void *data, size_t size) {
+    c_sb_reserve(sb, C_HEX_ENCODED_SIZE(size));
+    sb->count += c_hex_encode(data, size, sb->items + sb->count);
+}
+
+void c_sb_append_base64(c_String_builder *sb, const void *data, size_t size) {
+    c_sb_reserve(sb, C_BASE64_ENCODED_SIZE(size));
+    sb->count += c_base64_encode(data, size, sb->items + sb->count);
+}
+
+bool c_sb_append_hex_decoded(c_String_builder *sb, c_String_view hex) {
+    size_t decoded = 0;
+    c_sb_reserve(sb, hex.count / 2);
+    if (!c_hex_decode(hex, sb->items + sb->count, &decoded)) return false;
+    sb->count += decoded;
+    return true;
+}
+
+bool c_sb_append_base64_decoded(c_String_builder *sb, c_String_view b64) {
+    size_t decoded = 0;
+    c_sb_reserve(sb, C_BASE64_DECODED_MAX_SIZE(b64.count));
+    if (!c_base64_decode(b64, sb->items + sb->count, &decoded)) return false;
+    sb->count += decoded;
+    return true;
+}
+
+//
+// Line index
+//
+
+static void c_line_index_push(c_Line_index *li, uint64 offset) {
+    if (li->count >= li->capacity) {
+        li->capacity = li->capacity == 0 ? 1024 : li->capacity*2;
+        li->items = C_REALLOC(li->items, li->capacity * sizeof(*li->items));
+        C_ASSERT(li->items != NULL, "Buy more RAM bruh");
+    }
+    li->items[li->count++] = offset;
+}
+
+c_Line_index c_line_index_build(c_String_view text) {
+    c_Line_index li = {0};
+    li.text = text;
+    if (text.count == 0) return li;
+
+    c_line_index_push(&li, 0);
+
+    size_t i = 0;
+#ifdef C_SIMD_SSE2
+    __m128i nl = _mm_set1_epi8('\n');
+    for (; i + 16 <= text.count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(text.data + i));
+        uint32 mask = (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+        while (mask) {
+            c_line_index_push(&li, i + c_ctz32(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+#endif // C_SIMD_SSE2
+
+    for (; i < text.count; ++i) {
+        if (text.data[i] == '\n') c_line_index_push(&li, i + 1);
+    }
+
+    // A trailing newline doesn't start another line
+    if (li.items[li.count-1] == text.count) li.count--;
+
+    return li;
+}
+
+size_t c_line_index_count(const c_Line_index *li) {
+    return li->count;
+}
+
+c_String_view c_line_index_get(const c_Line_index *li, size_t n) {
+    C_ASSERT(n < li->count, "Line number out of bounds");
+
+    size_t start = li->items[n];
+    size_t end = n+1 < li->count ? li->items[n+1] : li->text.count;
+    if (end > start && li->text.data[end-1] == '\n') end--;
+    if (end > start && li->text.data[end-1] == '\r') end--;
+
+    return (c_String_view){
+        .data = li->text.data + start,
+        .count = end - start,
+    };
+}
+
+// Index of the first line that starts at or after `offset`
+static size_t c_line_index_lower_bound(const c_Line_index *li, size_t offset) {
+    size_t lo = 0, hi = li->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo)/2;
+        if (li->items[mid] < offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t c_line_index_find(const c_Line_index *li, size_t offset) {
+    C_ASSERT(li->count > 0, "The line index is empty");
+    size_t n = c_line_index_lower_bound(li, offset + 1);
+    return n - 1;
+}
+
+c_String_view c_line_index_chunk(const c_Line_index *li, size_t chunk, size_t n_chunks) {
+    C_ASSERT(n_chunks > 0 && chunk < n_chunks, "Chunk out of bounds");
+
+    size_t size = li->text.count;
+    size_t from = (size_t)((uint64)li->count * chunk / n_chunks);
+    size_t to   = (size_t)((uint64)li->count * (chunk+1) / n_chunks);
+    size_t start = from < li->count ? li->items[from] : size;
+    size_t end   = to   < li->count ? li->items[to]   : size;
+
+    return (c_String_view){
+        .data = li->text.data + start,
+        .count = end - start,
+    };
+}
+
+void c_line_index_free(c_Line_index *li) {
+    C_FREE(li->items);
+    li->items = NULL;
+    li->count = 0;
+    li->capacity = 0;
+}
+
+//
+// Hashing
+//
+
+static const uint64 c_hash_secrets[2][4] = {
+    { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull },
+    { 0xc51d74b4e2c68d2bull, 0x782e271b3ad2e839ull, 0x3563d827a3b2e44dull, 0x6ad2b82d274e9999ull },
+};
+
+static inline void c_hash_mum(uint64 *a, uint64 *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64)r;
+    *b = (uint64)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64 ha = *a >> 32, hb = *b >> 32, la = (uint32)*a, lb = (uint32)*b;
+    uint64 rh = ha*hb, rm0 = ha*lb, rm1 = hb*la, rl = la*lb;
+    uint64 t = rl + (rm0 << 32), c = t < rl;
+    uint64 lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64 c_hash_mix(uint64 a, uint64 b) {
+    c_hash_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64 c_hash_r8(const uint8 *p) {
+    uint64 v;
+    C_MEMCPY(&v, p, 8);
+    return v;
+}
+
+static inline uint64 c_hash_r4(const uint8 *p) {
+    uint32 v;
+    C_MEMCPY(&v, p, 4);
+    return v;
+}
+
+static inline uint64 c_hash_r3(const uint8 *p, size_t k) {
+    return ((uint64)p[0] << 16) | ((uint64)p[k >> 1] << 8) | p[k - 1];
+}
+
+static inline uint64 c_hash_seed(uint64 seed, const uint64 *secret) {
+    return seed ^ c_hash_mix(seed ^ secret[0], secret[1]);
+}
+
+// Final mix; `p` points at the last (upto 16) unconsumed bytes, `i` of them.
+// NOTE: When `size` > 16, the 16 bytes before p+i must be readable.
+static inline uint64 c_hash_finish(const uint8 *p, size_t i, uint64 size, uint64 seed, const uint64 *secret) {
+    uint64 a, b;
+    if (size <= 16) {
+        if (size >= 4) {
+            a = (c_hash_r4(p) << 32) | c_hash_r4(p + ((size >> 3) << 2));
+            b = (c_hash_r4(p + size - 4) << 32) | c_hash_r4(p + size - 4 - ((size >> 3) << 2));
+        } else if (size > 0) {
+            a = c_hash_r3(p, size);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        while (i > 16) {
+            seed = c_hash_mix(c_hash_r8(p) ^ secret[1], c_hash_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = c_hash_r8(p + i - 16);
+        b = c_hash_r8(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    c_hash_mum(&a, &b);
+    return c_hash_mix(a ^ secret[0] ^ size, b ^ secret[1]);
+}
+
+static inline void c_hash_block(const uint8 *p, uint64 lane[3], const uint64 *secret) {
+    lane[0] = c_hash_mix(c_hash_r8(p)      ^ secret[1], c_hash_r8(p + 8)  ^ lane[0]);
+    lane[1] = c_hash_mix(c_hash_r8(p + 16) ^ secret[2], c_hash_r8(p + 24) ^ lane[1]);
+    lane[2] = c_hash_mix(c_hash_r8(p + 32) ^ secret[3], c_hash_r8(p + 40) ^ lane[2]);
+}
+
+static uint64 c_hash_lane(const uint8 *p, size_t size, uint64 seed, const uint64 *secret) {
+    seed = c_hash_seed(seed, secret);
+    size_t i = size;
+    if (size > 16 && i >= 48) {
+        uint64 lane[3] = { seed, seed, seed };
+        do {
+            c_hash_block(p, lane, secret);
+            p += 48;
+            i -= 48;
+        } while (i >= 48);
+        seed = lane[0] ^ lane[1] ^ lane[2];
+    }
+    return c_hash_finish(p, i, size, seed, secret);
+}
+
+uint64 c_hash(const void *data, size_t size, uint64 seed) {
+    return c_hash_lane((const uint8 *)data, size, seed, c_hash_secrets[0]);
+}
+
+uint64 c_sv_hash(c_String_view sv, uint64 seed) {
+    return c_hash_lane((const uint8 *)sv.data, sv.count, seed, c_hash_secrets[0]);
+}
+
+c_Hash128 c_hash128(const void *data, size_t size, uint64 seed) {
+    return (c_Hash128){
+        .lo = c_hash_lane((const uint8 *)data, size, seed, c_hash_secrets[0]),
+        .hi = c_hash_lane((const uint8 *)data, size, seed, c_hash_secrets[1]),
+    };
+}
+
+c_Hash128 c_sv_hash128(c_String_view sv, uint64 seed) {
+    return c_hash128(sv.data, sv.count, seed);
+}
+
+void c_hash_init(c_Hash_state *h, uint64 seed) {
+    C_MEMSET(h, 0, sizeof(*h));
+    h->seed = seed;
+    for (int l = 0; l < 2; ++l) {
+        uint64 s = c_hash_seed(seed, c_hash_secrets[l]);
+        h->lanes[l][0] = h->lanes[l][1] = h->lanes[l][2] = s;
+    }
+}
+
+void c_hash128_init(c_Hash_state *h, uint64 seed) {
+    c_hash_init(h, seed);
+    h->wide = true;
+}
+
+static inline void c_hash_state_consume(c_Hash_state *h, const uint8 *block) {
+    c_hash_block(block, h->lanes[0], c_hash_secrets[0]);
+    if (h->wide) c_hash_block(block, h->lanes[1], c_hash_secrets[1]);
+    h->consumed_blocks = true;
+}
+
+void c_hash_update(c_Hash_state *h, const void *data, size_t size) {
+    const uint8 *p = (const uint8 *)data;
+    uint8 *pending = h->buff + 16;
+    h->size += size;
+
+    while (size > 0) {
+        // A full pending block is only consumed once we know more data follows it
+        if (h->pending == 48) {
+            c_hash_state_consume(h, pending);
+            C_MEMCPY(h->buff, pending + 32, 16);
+            h->pending = 0;
+        }
+
+        if (h->pending == 0 && size > 48) {
+            do {
+                c_hash_state_consume(h, p);
+                p += 48;
+                size -= 48;
+            } while (size > 48);
+            C_MEMCPY(h->buff, p - 16, 16);
+        }
+
+        size_t n = 48 - h->pending;
+        if (n > size) n = size;
+        C_MEMCPY(pending + h->pending, p, n);
+        h->pending += n;
+        p += n;
+        size -= n;
+    }
+}
+
+static uint64 c_hash_state_lane(const c_Hash_state *h, int l) {
+    const uint64 *secret = c_hash_secrets[l];
+    const uint8 *p = h->buff + 16;
+    size_t i = h->pending;
+    uint64 lane[3] = { h->lanes[l][0], h->lanes[l][1], h->lanes[l][2] };
+    bool consumed = h->consumed_blocks;
+
+    if (h->size > 16 && i == 48) {
+        c_hash_block(p, lane, secret);
+        p += 48;
+        i = 0;
+        consumed = true;
+    }
+
+    uint64 seed = consumed ? lane[0] ^ lane[1] ^ lane[2] : lane[0];
+    return c_hash_finish(p, i, h->size, seed, secret);
+}
+
+uint64 c_hash_final(const c_Hash_state *h) {
+    return c_hash_state_lane(h, 0);
+}
+
+c_Hash128 c_hash128_final(const c_Hash_state *h) {
+    C_ASSERT(h->wide, "Initialize the state with c_hash128_init() to get a 128-bit hash");
+    return (c_Hash128){
+        .lo = c_hash_state_lane(h, 0),
+        .hi = c_hash_state_lane(h, 1),
+    };
+}
+
+//
+// UTF-8
+//
+
+// Decodes the sequence at `p` (`n` bytes available) into *cp and gives back its length, 0 if it's invalid.
+static inline int c_utf8_decode_sequence(const uint8 *p, size_t n, uint32 *cp) {
+    uint8 c = p[0];
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    }
+    if (c < 0xC2) return 0;
+    if (c < 0xE0) {
+        if (n < 2 || (p[1] & 0xC0) != 0x80) return 0;
+        *cp = ((uint32)(c & 0x1F) << 6) | (p[1] & 0x3F);
+        return 2;
+    }
+    if (c < 0xF0) {
+        uint8 lo = c == 0xE0 ? 0xA0 : 0x80; // overlongs
+        uint8 hi = c == 0xED ? 0x9F : 0xBF; // surrogates
+        if (n < 3 || p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80) return 0;
+        *cp = ((uint32)(c & 0x0F) << 12) | ((uint32)(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+        return 3;
+    }
+    if (c < 0xF5) {
+        uint8 lo = c == 0xF0 ? 0x90 : 0x80; // overlongs
+        uint8 hi = c == 0xF4 ? 0x8F : 0xBF; // above U+10FFFF
+        if (n < 4 || p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80) return 0;
+        *cp = ((uint32)(c & 0x07) << 18) | ((uint32)(p[1] & 0x3F) << 12) | ((uint32)(p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+        return 4;
+    }
+    return 0;
+}
+
+#ifdef C_KERNELS_X86
+// Keiser and Lemire's lookup validation: every error shows up in three nibble lookups of a byte and the one before it,
+// except a missing third/fourth continuation, which is checked on its own.
+#define C_UTF8_TOO_SHORT      (1 << 0)
+#define C_UTF8_TOO_LONG       (1 << 1)
+#define C_UTF8_OVERLONG_3     (1 << 2)
+#define C_UTF8_TOO_LARGE      (1 << 3)
+#define C_UTF8_SURROGATE      (1 << 4)
+#define C_UTF8_OVERLONG_2     (1 << 5)
+#define C_UTF8_TOO_LARGE_1000 (1 << 6)
+#define C_UTF8_OVERLONG_4     (1 << 6)
+#define C_UTF8_TWO_CONTS      (1 << 7)
+#define C_UTF8_CARRY          (C_UTF8_TOO_SHORT | C_UTF8_TOO_LONG | C_UTF8_TWO_CONTS)
+#define C_UTF8_CARRY_LARGE    (C_UTF8_CARRY | C_UTF8_TOO_LARGE | C_UTF8_TOO_LARGE_1000)
+#define C_UTF8_CONT_BYTE      (C_UTF8_TOO_LONG | C_UTF8_OVERLONG_2 | C_UTF8_TWO_CONTS)
+
+#define C_UTF8_TABLE(...) _mm256_broadcastsi128_si256(_mm_setr_epi8(__VA_ARGS__))
+
+// Validates 32 bytes at a time and gives back where the scalar path has to take over: the end, or the block with an error.
+// It's always the start of a sequence and everything before it is valid, so the scalar path finds the exact error offset.
+C_TARGET("avx2") static size_t c_utf8_validate_avx2(const uint8 *p, size_t n) {
+    // Indexed by the high nibble of the first byte
+    const __m256i byte_1_high = C_UTF8_TABLE(
+        C_UTF8_TOO_LONG, C_UTF8_TOO_LONG, C_UTF8_TOO_LONG, C_UTF8_TOO_LONG,
+        C_UTF8_TOO_LONG, C_UTF8_TOO_LONG, C_UTF8_TOO_LONG, C_UTF8_TOO_LONG,
+        (char)C_UTF8_TWO_CONTS, (char)C_UTF8_TWO_CONTS, (char)C_UTF8_TWO_CONTS, (char)C_UTF8_TWO_CONTS,
+        C_UTF8_TOO_SHORT | C_UTF8_OVERLONG_2,
+        C_UTF8_TOO_SHORT,
+        C_UTF8_TOO_SHORT | C_UTF8_OVERLONG_3 | C_UTF8_SURROGATE,
+        C_UTF8_TOO_SHORT | C_UTF8_TOO_LARGE | C_UTF8_TOO_LARGE_1000 | C_UTF8_OVERLONG_4);
+    // Indexed by the low nibble of the first byte
+    const __m256i byte_1_low = C_UTF8_TABLE(
+        (char)(C_UTF8_CARRY | C_UTF8_OVERLONG_3 | C_UTF8_OVERLONG_2 | C_UTF8_OVERLONG_4),
+        (char)(C_UTF8_CARRY | C_UTF8_OVERLONG_2),
+        (char)C_UTF8_CARRY, (char)C_UTF8_CARRY,
+        (char)(C_UTF8_CARRY | C_UTF8_TOO_LARGE),
+        (char)C_UTF8_CARRY_LARGE, (char)C_UTF8_CARRY_LARGE, (char)C_UTF8_CARRY_LARGE,
+        (char)C_UTF8_CARRY_LARGE, (char)C_UTF8_CARRY_LARGE, (char)C_UTF8_CARRY_LARGE, (char)C_UTF8_CARRY_LARGE,
+        (char)C_UTF8_CARRY_LARGE,
+        (char)(C_UTF8_CARRY_LARGE | C_UTF8_SURROGATE),
+        (char)C_UTF8_CARRY_LARGE, (char)C_UTF8_CARRY_LARGE);
+    // Indexed by the high nibble of the second byte
+    const __m256i byte_2_high = C_UTF8_TABLE(
+        C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT,
+        C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT,
+        (char)(C_UTF8_CONT_BYTE | C_UTF8_OVERLONG_3 | C_UTF8_TOO_LARGE_1000 | C_UTF8_OVERLONG_4),
+        (char)(C_UTF8_CONT_BYTE | C_UTF8_OVERLONG_3 | C_UTF8_TOO_LARGE),
+        (char)(C_UTF8_CONT_BYTE | C_UTF8_SURROGATE | C_UTF8_TOO_LARGE),
+        (char)(C_UTF8_CONT_BYTE | C_UTF8_SURROGATE | C_UTF8_TOO_LARGE),
+        C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT, C_UTF8_TOO_SHORT);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i third_lead = _mm256_set1_epi8((char)(0xE0 - 0x80)); // only 111xxxxx stays >= 0x80
+    const __m256i fourth_lead = _mm256_set1_epi8((char)(0xF0 - 0x80)); // only 1111xxxx stays >= 0x80
+    const __m256i high_bit = _mm256_set1_epi8((char)0x80);
+
+    __m256i prev_input = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i input = _mm256_loadu_si256((const __m256i *)(p + i));
+        // All ASCII and nothing before it waiting for continuation bytes
+        if (_mm256_movemask_epi8(input) == 0 && ((uint32)_mm256_movemask_epi8(prev_input) >> 29) == 0) {
+            prev_input = input;
+            continue;
+        }
+        __m256i across = _mm256_permute2x128_si256(prev_input, input, 0x21);
+        __m256i prev1 = _mm256_alignr_epi8(input, across, 15);
+        __m256i prev2 = _mm256_alignr_epi8(input, across, 14);
+        __m256i prev3 = _mm256_alignr_epi8(input, across, 13);
+
+        __m256i special = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                             _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))),
+            _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+        __m256i must_be_cont = _mm256_and_si256(_mm256_or_si256(_mm256_subs_epu8(prev2, third_lead), _mm256_subs_epu8(prev3, fourth_lead)), high_bit);
+        __m256i error = _mm256_xor_si256(must_be_cont, special);
+        if (!_mm256_testz_si256(error, error)) break;
+        prev_input = input;
+    }
+
+    // Back up to the start of the sequence that runs into where we stopped (at most 3 bytes before it)
+    size_t start = i >= 3 ? i - 3 : 0;
+    while (start < i && (p[start] & 0xC0) == 0x80) start++;
+    return start;
+}
+#endif // C_KERNELS_X86
+
+bool c_utf8_validate(c_String_view sv, size_t *error_offset) {
+    const uint8 *p = (const uint8 *)sv.data;
+    size_t n = sv.count;
+    size_t i = 0;
+
+#ifdef C_KERNELS_X86
+    if (n >= 64 && c_simd_level() >= C_SIMD_LEVEL_AVX2) i = c_utf8_validate_avx2(p, n);
+#endif // C_KERNELS_X86
+    while (i < n) {
+#ifdef C_SIMD_SSE2
+        // Skip ASCII 16 bytes at a time
+        if (i + 16 <= n) {
+            uint32 mask = (uint32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(p + i)));
+            if (mask == 0) {
+                i += 16;
+                continue;
+            }
+            i += c_ctz32(mask);
+        }
+#endif // C_SIMD_SSE2
+        uint32 cp;
+        int len = c_utf8_decode_sequence(p + i, n - i, &cp);
+        if (len == 0) {
+            if (error_offset) *error_offset = i;
+            return false;
+        }
+        i += len;
+    }
+
+    if (error_offset) *error_offset = n;
+    return true;
+}
+
+size_t c_utf8_count_codepoints(c_String_view sv) {
+    size_t count = 0;
+    size_t i = 0;
+
+#ifdef C_SIMD_SSE2
+    // Everything but continuation bytes (0x80..0xBF, -128..-65 as signed) starts a codepoint
+    __m128i cont_max = _mm_set1_epi8(-65);
+    for (; i + 16 <= sv.count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(sv.data + i));
+        count += c_popcount32((uint32)_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, cont_max)));
+    }
+#endif // C_SIMD_SSE2
+
+    for (; i < sv.count; ++i) {
+        count += ((uint8)sv.data[i] & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+size_t c_utf8_utf16_length(c_String_view sv) {
+    // Codepoints above U+FFFF (4 byte sequences) take a surrogate pair
+    size_t pairs = 0;
+    size_t i = 0;
+
+#ifdef C_SIMD_SSE2
+    // 0xF0..0xFF is -16..-1 as signed
+    __m128i lead4_min = _mm_set1_epi8(-17);
+    for (; i + 16 <= sv.count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(sv.data + i));
+        __m128i lead4 = _mm_and_si128(_mm_cmpgt_epi8(chunk, lead4_min), _mm_cmplt_epi8(chunk, _mm_setzero_si128()));
+        pairs += c_popcount32((uint32)_mm_movemask_epi8(lead4));
+    }
+#endif // C_SIMD_SSE2
+
+    for (; i < sv.count; ++i) {
+        pairs += (uint8)sv.data[i] >= 0xF0;
+    }
+    return c_utf8_count_codepoints(sv) + pairs;
+}
+
+bool c_utf8_to_utf32(c_String_view sv, uint32 *out, size_t *out_count) {
+    const uint8 *p = (const uint8 *)sv.data;
+    size_t n = sv.count;
+    size_t i = 0, o = 0;
+
+    while (i < n) {
+#ifdef C_SIMD_SSE2
+        if (i + 16 <= n) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)(p + i));
+            if (_mm_movemask_epi8(chunk) == 0) {
+                __m128i zero = _mm_setzero_si128();
+                __m128i lo = _mm_unpacklo_epi8(chunk, zero);
+                __m128i hi = _mm_unpackhi_epi8(chunk, zero);
+                _mm_storeu_si128((__m128i *)(out + o),      _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128((__m128i *)(out + o + 4),  _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128((__m128i *)(out + o + 8),  _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128((__m128i *)(out + o + 12), _mm_unpackhi_epi16(hi, zero));
+                i += 16;
+                o += 16;
+                continue;
+            }
+        }
+#endif // C_SIMD_SSE2
+        uint32 cp;
+        int len = c_utf8_decode_sequence(p + i, n - i, &cp);
+        if (len == 0) {
+            if (out_count) *out_count = o;
+            return false;
+        }
+        out[o++] = cp;
+        i += len;
+    }
+
+    if (out_count) *out_count = o;
+    return true;
+}
+
+bool c_utf8_to_utf16(c_String_view sv, uint16 *out, size_t *out_count) {
+    const uint8 *p = (const uint8 *)sv.data;
+    size_t n = sv.count;
+    size_t i = 0, o = 0;
+
+    while (i < n) {
+#ifdef C_SIMD_SSE2
+        if (i + 16 <= n) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)(p + i));
+            if (_mm_movemask_epi8(chunk) == 0) {
+                __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128((__m128i *)(out + o),     _mm_unpacklo_epi8(chunk, zero));
+                _mm_storeu_si128((__m128i *)(out + o + 8), _mm_unpackhi_epi8(chunk, zero));
+                i += 16;
+                o += 16;
+                continue;
+            }
+        }
+#endif // C_SIMD_SSE2
+        uint32 cp;
+        int len = c_utf8_decode_sequence(p + i, n - i, &cp);
+        if (len == 0) {
+            if (out_count) *out_count = o;
+            return false;
+        }
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out[o++] = (uint16)(0xD800 | (cp >> 10));
+            out[o++] = (uint16)(0xDC00 | (cp & 0x3FF));
+        } else {
+            out[o++] = (uint16)cp;
+        }
+        i += len;
+    }
+
+    if (out_count) *out_count = o;
+    return true;
+}
+
+int c_utf8_encode(uint32 codepoint, char out[4]) {
+    if (codepoint < 0x80) {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char)(0xC0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) {
+        codepoint = C_UTF8_REPLACEMENT_CHAR;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char)(0xE0 | (codepoint >> 12));
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (codepoint >> 18));
+    out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+bool c_sv_lpop_codepoint(c_String_view *sv, uint32 *codepoint) {
+    if (sv->count == 0) return false;
+
+    uint32 cp;
+    int len = c_utf8_decode_sequence((const uint8 *)sv->data, sv->count, &cp);
+    if (len == 0) {
+        cp = C_UTF8_REPLACEMENT_CHAR;
+        len = 1;
+    }
+
+    sv->data += len;
+    sv->count -= len;
+    if (codepoint) *codepoint = cp;
+    return true;
+}
+
+wchar *c_sv_to_wstr(c_String_view sv) {
+    bool ok;
+    size_t count = 0;
+    wchar *res;
+
+    if (sizeof(wchar) == 2) {
+        res = C_MALLOC(sizeof(wchar)*(c_utf8_utf16_length(sv) + 1));
+        C_ASSERT(res != NULL, "Buy more RAM bruh");
+        ok = c_utf8_to_utf16(sv, (uint16 *)res, &count);
+    } else {
+        res = C_MALLOC(sizeof(wchar)*(c_utf8_count_codepoints(sv) + 1));
+        C_ASSERT(res != NULL, "Buy more RAM bruh");
+        ok = c_utf8_to_utf32(sv, (uint32 *)res, &count);
+    }
+
+    if (!ok) {
+        C_FREE(res);
+        return NULL;
+    }
+    res[count] = 0;
+    return res;
+}
+
+void c_sb_append_codepoint(c_String_builder *sb, uint32 codepoint) {
+    c_sb_reserve(sb, 4);
+    sb->count += c_utf8_encode(codepoint, sb->items + sb->count);
+}
+
+//
+// Formatting
+//
+
+void c_sb_append_sv(c_String_builder *sb, c_String_view sv) {
+    c_sb_reserve(sb, sv.count);
+    C_MEMCPY(sb->items + sb->count, sv.data, sv.count);
+    sb->count += sv.count;
+}
+
+void c_sb_vappendf(c_String_builder *sb, const char *fmt, va_list args) {
+    va_list args_copy;
+    va_copy(args_copy, args);
+
+    c_sb_reserve(sb, 1);
+    size_t spare = sb->capacity - sb->count;
+    int n = vsnprintf(sb->items + sb->count, spare, fmt, args);
+    C_ASSERT(n >= 0, "Invalid format string");
+
+    if ((size_t)n >= spare) {
+        // +1 for the NUL vsnprintf always writes
+        c_sb_reserve(sb, (size_t)n + 1);
+        vsnprintf(sb->items + sb->count, (size_t)n + 1, fmt, args_copy);
+    }
+    va_end(args_copy);
+
+    sb->count += (size_t)n;
+}
+
+void c_sb_appendf(c_String_builder *sb, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    c_sb_vappendf(sb, fmt, args);
+    va_end(args);
+}
+
+void c_sb_append_int(c_String_builder *sb, int64 v) {
+    c_sb_reserve(sb, C_FMT_NUMBER_MAX_SIZE);
+    sb->count += c_fmt_int(v, sb->items + sb->count);
+}
+
+void c_sb_append_uint(c_String_builder *sb, uint64 v) {
+    c_sb_reserve(sb, C_FMT_NUMBER_MAX_SIZE);
+    sb->count += c_fmt_uint(v, sb->items + sb->count);
+}
+
+void c_sb_append_float64(c_String_builder *sb, float64 v) {
+    c_sb_reserve(sb, C_FMT_NUMBER_MAX_SIZE);
+    sb->count += c_fmt_float64(v, sb->items + sb->count);
+}
+
+void c_sb_append_float32(c_String_builder *sb, float32 v) {
+    c_sb_reserve(sb, C_FMT_NUMBER_MAX_SIZE);
+    sb->count += c_fmt_float32(v, sb->items + sb->count);
+}
+
+static const char c_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline int c_count_digits(uint64 v) {
+    int n = 1;
+    for (;;) {
+        if (v < 10) return n;
+        if (v < 100) return n + 1;
+        if (v < 1000) return n + 2;
+        if (v < 10000) return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+int c_fmt_uint(uint64 v, char *out) {
+    int len = c_count_digits(v);
+    char *p = out + len;
+
+    // Two digits per division
+    while (v >= 100) {
+        size_t i = (size_t)(v % 100) * 2;
+        v /= 100;
+        p -= 2;
+        p[0] = c_digit_pairs[i];
+        p[1] = c_digit_pairs[i + 1];
+    }
+    if (v >= 10) {
+        p -= 2;
+        p[0] = c_digit_pairs[v * 2];
+        p[1] = c_digit_pairs[v * 2 + 1];
+    } else {
+        *--p = (char)('0' + v);
+    }
+
+    return len;
+}
+
+int c_fmt_int(int64 v, char *out) {
+    if (v < 0) {
+        *out = '-';
+        // NOTE: Negate as unsigned so INT64_MIN doesn't overflow
+        return 1 + c_fmt_uint(0 - (uint64)v, out + 1);
+    }
+    return c_fmt_uint((uint64)v, out);
+}
+
+// Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers")
+// Always round-trips, and gives the shortest digits for ~99.9% of the values.
+
+typedef struct {
+    uint64 f;
+    int e;
+} c_Diy_fp;
+
+// Normalized 10^k for k = -348, -340, ..., 340
+static const uint64 c_cached_powers_f[] = {
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull,
+    0xcf42894a5dce35eaull, 0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull,
+    0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full, 0xbe5691ef416bd60cull,
+    0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull,
+    0xc21094364dfb5637ull, 0x9096ea6f3848984full, 0xd77485cb25823ac7ull,
+    0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull, 0xb23867fb2a35b28eull,
+    0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull,
+    0xb5b5ada8aaff80b8ull, 0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull,
+    0x964e858c91ba2655ull, 0xdff9772470297ebdull, 0xa6dfbd9fb8e5b88full,
+    0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull,
+    0xaa242499697392d3ull, 0xfd87b5f28300ca0eull, 0xbce5086492111aebull,
+    0x8cbccc096f5088ccull, 0xd1b71758e219652cull, 0x9c40000000000000ull,
+    0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull,
+    0x9f4f2726179a2245ull, 0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull,
+    0x83c7088e1aab65dbull, 0xc45d1df942711d9aull, 0x924d692ca61be758ull,
+    0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull,
+    0x952ab45cfa97a0b3ull, 0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull,
+    0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull, 0x88fcf317f22241e2ull,
+    0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull,
+    0x8bab8eefb6409c1aull, 0xd01fef10a657842cull, 0x9b10a4e5e9913129ull,
+    0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull, 0x80444b5e7aa7cf85ull,
+    0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull
+};
+
+static const int16 c_cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+static const uint64 c_pow10_u64[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+    1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+    1000000000000000000ull, 10000000000000000000ull,
+};
+
+static inline c_Diy_fp c_diy_fp_normalize(c_Diy_fp x) {
+    while ((x.f & (1ull << 63)) == 0) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+static inline c_Diy_fp c_diy_fp_mul(c_Diy_fp x, c_Diy_fp y) {
+    const uint64 m32 = 0xFFFFFFFFull;
+    uint64 a = x.f >> 32, b = x.f & m32, c = y.f >> 32, d = y.f & m32;
+    uint64 ac = a*c, bc = b*c, ad = a*d, bd = b*d;
+    uint64 tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+    tmp += 1ull << 31; // round
+    return (c_Diy_fp){ ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64 };
+}
+
+static inline c_Diy_fp c_cached_power(int e, int *k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (ik != dk) ik++;
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    return (c_Diy_fp){ c_cached_powers_f[index], c_cached_powers_e[index] };
+}
+
+static inline void c_grisu_round(char *buff, int len, uint64 delta, uint64 rest, uint64 ten_kappa, uint64 wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buff[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static void c_grisu_digit_gen(c_Diy_fp w, c_Diy_fp mp, uint64 delta, char *buff, int *len, int *k) {
+    c_Diy_fp one = { 1ull << -mp.e, mp.e };
+    uint64 wp_w = mp.f - w.f;
+    uint32 p1 = (uint32)(mp.f >> -one.e);
+    uint64 p2 = mp.f & (one.f - 1);
+    int kappa = c_count_digits(p1);
+    *len = 0;
+
+    while (kappa > 0) {
+        uint32 div = (uint32)c_pow10_u64[kappa - 1];
+        uint32 d = p1 / div;
+        p1 %= div;
+        if (d || *len) buff[(*len)++] = (char)('0' + d);
+        kappa--;
+        uint64 tmp = ((uint64)p1 << -one.e) + p2;
+        if (tmp <= delta) {
+            *k += kappa;
+            c_grisu_round(buff, *len, delta, tmp, c_pow10_u64[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || *len) buff[(*len)++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *k += kappa;
+            c_grisu_round(buff, *len, delta, p2, one.f, wp_w * c_pow10_u64[-kappa]);
+            return;
+        }
+    }
+}
+
+// v = f * 2^e exactly; `lower_closer` when f is the smallest significand of its binade
+static void c_grisu2(uint64 f, int e, bool lower_closer, char *buff, int *len, int *k) {
+    c_Diy_fp plus = c_diy_fp_normalize((c_Diy_fp){ (f << 1) + 1, e - 1 });
+    c_Diy_fp minus = lower_closer ? (c_Diy_fp){ (f << 2) - 1, e - 2 } : (c_Diy_fp){ (f << 1) - 1, e - 1 };
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    c_Diy_fp c_mk = c_cached_power(plus.e, k);
+    c_Diy_fp w  = c_diy_fp_mul(c_diy_fp_normalize((c_Diy_fp){ f, e }), c_mk);
+    c_Diy_fp wp = c_diy_fp_mul(plus, c_mk);
+    c_Diy_fp wm = c_diy_fp_mul(minus, c_mk);
+    wm.f++;
+    wp.f--;
+    c_grisu_digit_gen(w, wp, wp.f - wm.f, buff, len, k);
+}
+
+// Lays out `len` digits (in buff) times 10^k like 123.45, 0.00012, 1.2345e+20
+static int c_fmt_digits(char *buff, int len, int k, char *out) {
+    int kk = len + k; // position of the decimal point
+    char *o = out;
+
+    if (k >= 0 && kk <= 21) {
+        C_MEMCPY(o, buff, len);
+        o += len;
+        for (int i = 0; i < k; ++i) *o++ = '0';
+        *o++ = '.';
+        *o++ = '0';
+    } else if (kk > 0 && kk <= 21) {
+        C_MEMCPY(o, buff, kk);
+        o += kk;
+        *o++ = '.';
+        C_MEMCPY(o, buff + kk, len - kk);
+        o += len - kk;
+    } else if (kk > -6 && kk <= 0) {
+        *o++ = '0';
+        *o++ = '.';
+        for (int i = kk; i < 0; ++i) *o++ = '0';
+        C_MEMCPY(o, buff, len);
+        o += len;
+    } else {
+        *o++ = buff[0];
+        if (len > 1) {
+            *o++ = '.';
+            C_MEMCPY(o, buff + 1, len - 1);
+            o += len - 1;
+        }
+        int exp = kk - 1;
+        *o++ = 'e';
+        *o++ = exp < 0 ? '-' : '+';
+        o += c_fmt_uint((uint64)(exp < 0 ? -exp : exp), o);
+    }
+
+    return (int)(o - out);
+}
+
+static int c_fmt_special(bool negative, bool is_nan, bool is_inf, char *out) {
+    char *o = out;
+    if (negative && !is_nan) *o++ = '-';
+    if (is_nan) {
+        C_MEMCPY(o, "nan", 3);
+    } else if (is_inf) {
+        C_MEMCPY(o, "inf", 3);
+    } else {
+        C_MEMCPY(o, "0.0", 3);
+    }
+    return (int)(o - out) + 3;
+}
+
+int c_fmt_float64(float64 v, char *out) {
+    uint64 bits;
+    C_MEMCPY(&bits, &v, sizeof(bits));
+    bool negative = (bits >> 63) != 0;
+    int biased_e = (int)((bits >> 52) & 0x7FF);
+    uint64 significand = bits & ((1ull << 52) - 1);
+
+    if (biased_e == 0x7FF) return c_fmt_special(negative, significand != 0, significand == 0, out);
+    if (biased_e == 0 && significand == 0) return c_fmt_special(negative, false, false, out);
+
+    uint64 f;
+    int e;
+    if (biased_e != 0) {
+        f = significand | (1ull << 52);
+        e = biased_e - 1075;
+    } else {
+        f = significand;
+        e = -1074;
+    }
+
+    char buff[32];
+    int len = 0, k = 0;
+    c_grisu2(f, e, biased_e > 1 && significand == 0, buff, &len, &k);
+
+    char *o = out;
+    if (negative) *o++ = '-';
+    return (int)(o - out) + c_fmt_digits(buff, len, k, o);
+}
+
+int c_fmt_float32(float32 v, char *out) {
+    uint32 bits;
+    C_MEMCPY(&bits, &v, sizeof(bits));
+    bool negative = (bits >> 31) != 0;
+    int biased_e = (int)((bits >> 23) & 0xFF);
+    uint32 significand = bits & ((1u << 23) - 1);
+
+    if (biased_e == 0xFF) return c_fmt_special(negative, significand != 0, significand == 0, out);
+    if (biased_e == 0 && significand == 0) return c_fmt_special(negative, false, false, out);
+
+    uint64 f;
+    int e;
+    if (biased_e != 0) {
+        f = significand | (1u << 23);
+        e = biased_e - 150;
+    } else {
+        f = significand;
+        e = -149;
+    }
+
+    char buff[32];
+    int len = 0, k = 0;
+    // Same algorithm, only the boundaries are float32's
+    c_grisu2(f, e, biased_e > 1 && significand == 0, buff, &len, &k);
+
+    char *o = out;
+    if (negative) *o++ = '-';
+    return (int)(o - out) + c_fmt_digits(buff, len, k, o);
+}
+
+//
+// String rope
+//
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#define C_ROPE_MAX_FREE_SEGMENTS 16
+#define C_ROPE_MAX_IOV 1024
+
+c_String_rope c_rope_make(int fd, size_t segment_size, size_t flush_threshold) {
+    c_String_rope r = {0};
+    r.fd = fd;
+    r.segment_size = segment_size == 0 ? C_ROPE_DEFAULT_SEGMENT_SIZE : segment_size;
+    r.flush_threshold = flush_threshold == 0 ? r.segment_size*16 : flush_threshold;
+    return r;
+}
+
+static c_Rope_segment *c_rope_push_segment(c_String_rope *r) {
+    if (r->count >= r->capacity) {
+        r->capacity = r->capacity == 0 ? 16 : r->capacity*2;
+        r->items = C_REALLOC(r->items, r->capacity * sizeof(*r->items));
+        C_ASSERT(r->items != NULL, "Buy more RAM bruh");
+    }
+
+    c_Rope_segment *seg = &r->items[r->count++];
+    if (r->free_count > 0) {
+        seg->data = r->free_segments[--r->free_count];
+    } else {
+        seg->data = C_MALLOC(r->segment_size);
+        C_ASSERT(seg->data != NULL, "Buy more RAM bruh");
+    }
+    seg->count = 0;
+    return seg;
+}
+
+static void c_rope_release_segment(c_String_rope *r, char *data) {
+    if (r->free_segments == NULL) {
+        r->free_segments = C_MALLOC(sizeof(*r->free_segments) * C_ROPE_MAX_FREE_SEGMENTS);
+        C_ASSERT(r->free_segments != NULL, "Buy more RAM bruh");
+    }
+    if (r->free_count < C_ROPE_MAX_FREE_SEGMENTS) {
+        r->free_segments[r->free_count++] = data;
+    } else {
+        C_FREE(data);
+    }
+}
+
+static bool c_rope_write_out(c_String_rope *r, size_t n) {
+#if defined(_WIN32)
+    for (size_t i = 0; i < n; ++i) {
+        const char *p = r->items[i].data;
+        size_t left = r->items[i].count;
+        while (left > 0) {
+            int w = _write(r->fd, p, (unsigned)left);
+            if (w <= 0) return false;
+            p += w;
+            left -= (size_t)w;
+            r->written += (uint64)w;
+        }
+    }
+    return true;
+#else
+    struct iovec iov[C_ROPE_MAX_IOV];
+    size_t i = 0;
+    while (i < n) {
+        int iov_count = 0;
+        for (size_t j = i; j < n && iov_count < C_ROPE_MAX_IOV; ++j) {
+            iov[iov_count].iov_base = r->items[j].data;
+            iov[iov_count].iov_len = r->items[j].count;
+            iov_count++;
+        }
+
+        // Keep going from where a partial write left off
+        struct iovec *v = iov;
+        while (iov_count > 0) {
+            ssize_t w = writev(r->fd, v, iov_count);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bool stuck = w == 0;
+            r->written += (uint64)w;
+            while (iov_count > 0 && (size_t)w >= v->iov_len) {
+                w -= (ssize_t)v->iov_len;
+                v++;
+                iov_count--;
+                i++;
+            }
+            if (iov_count > 0) {
+                // Nothing written with bytes left to go (empty segments are fine), retrying would spin forever
+                if (stuck) {
+                    errno = EIO;
+                    return false;
+                }
+                v->iov_base = (char *)v->iov_base + w;
+                v->iov_len -= (size_t)w;
+            }
+        }
+    }
+    return true;
+#endif
+}
+
+// Writes out the first `n` segments and recycles them
+static bool c_rope_write_segments(c_String_rope *r, size_t n) {
+    if (n == 0) return !r->failed;
+
+    if (!r->failed && !c_rope_write_out(r, n)) {
+        c_log_error("Failed to write rope to fd %d: %s", r->fd, strerror(errno));
+        r->failed = true;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        r->buffered -= r->items[i].count;
+        c_rope_release_segment(r, r->items[i].data);
+    }
+    C_MEMMOVE(r->items, r->items + n, (r->count - n) * sizeof(*r->items));
+    r->count -= n;
+
+    return !r->failed;
+}
+
+void c_rope_append(c_String_rope *r, const void *data, size_t size) {
+    const char *p = (const char *)data;
+
+    while (size > 0) {
+        c_Rope_segment *seg = r->count > 0 ? &r->items[r->count-1] : NULL;
+        if (seg == NULL || seg->count == r->segment_size) {
+            // Every segment is full at this point
+            if (r->fd >= 0 && r->buffered >= r->flush_threshold) c_rope_write_segments(r, r->count);
+            seg = c_rope_push_segment(r);
+        }
+
+        size_t n = r->segment_size - seg->count;
+        if (n > size) n = size;
+        C_MEMCPY(seg->data + seg->count, p, n);
+        seg->count += n;
+        r->buffered += n;
+        p += n;
+        size -= n;
+    }
+}
+
+void c_rope_append_sv(c_String_rope *r, c_String_view sv) {
+    c_rope_append(r, sv.data, sv.count);
+}
+
+void c_rope_appendf(c_String_rope *r, const char *fmt, ...) {
+    va_list args;
+
+    // Try to format straight into the current segment
+    c_Rope_segment *seg = r->count > 0 ? &r->items[r->count-1] : NULL;
+    size_t spare = seg ? r->segment_size - seg->count : 0;
+    if (spare > 0) {
+        va_start(args, fmt);
+        int n = vsnprintf(seg->data + seg->count, spare, fmt, args);
+        va_end(args);
+        C_ASSERT(n >= 0, "Invalid format string");
+        // NOTE: vsnprintf needs space for the NUL too
+        if ((size_t)n < spare) {
+            seg->count += (size_t)n;
+            r->buffered += (size_t)n;
+            return;
+        }
+    }
+
+    char stack_buff[1024];
+    va_start(args, fmt);
+    int n = vsnprintf(stack_buff, sizeof(stack_buff), fmt, args);
+    va_end(args);
+    C_ASSERT(n >= 0, "Invalid format string");
+
+    if ((size_t)n < sizeof(stack_buff)) {
+        c_rope_append(r, stack_buff, (size_t)n);
+        return;
+    }
+
+    char *heap_buff = C_MALLOC((size_t)n + 1);
+    C_ASSERT(heap_buff != NULL, "Buy more RAM bruh");
+    va_start(args, fmt);
+    vsnprintf(heap_buff, (size_t)n + 1, fmt, args);
+    va_end(args);
+    c_rope_append(r, heap_buff, (size_t)n);
+    C_FREE(heap_buff);
+}
+
+bool c_rope_flush(c_String_rope *r) {
+    C_ASSERT(r->fd >= 0, "This rope doesn't have an fd to flush to");
+    return c_rope_write_segments(r, r->count);
+}
+
+void c_rope_to_sb(const c_String_rope *r, c_String_builder *sb) {
+    c_sb_reserve(sb, r->buffered);
+    for (size_t i = 0; i < r->count; ++i) {
+        C_MEMCPY(sb->items + sb->count, r->items[i].data, r->items[i].count);
+        sb->count += r->items[i].count;
+    }
+}
+
+void c_rope_free(c_String_rope *r) {
+    for (size_t i = 0; i < r->count; ++i) C_FREE(r->items[i].data);
+    for (size_t i = 0; i < r->free_count; ++i) C_FREE(r->free_segments[i]);
+    C_FREE(r->items);
+    C_FREE(r->free_segments);
+    r->items = NULL;
+    r->free_segments = NULL;
+    r->count = r->capacity = r->free_count = 0;
+    r->buffered = 0;
+}
+
+//
+// Batch file loading
+//
+
+#include <sys/stat.h>
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+typedef struct {
+    c_File_load *files;
+    size_t count;
+    size_t next;     // next file to claim (atomic)
+    char *buff;      // NULL in the stat phase
+} c_File_load_job;
+
+static void c_file_load_stat(c_File_load *fl) {
+    struct stat st;
+    if (stat(fl->path, &st) < 0) {
+        fl->error = errno;
+        return;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        fl->error = EISDIR;
+        return;
+    }
+    fl->content.count = (size_t)st.st_size;
+}
+
+static void c_file_load_read(c_File_load *fl) {
+    size_t size = fl->content.count;
+    size_t got = 0;
+#if defined(_WIN32)
+    FILE *f = fopen(fl->path, "rb");
+    if (f == NULL) {
+        fl->error = errno;
+        return;
+    }
+    got = fread(fl->content.data, 1, size, f);
+    if (got < size && ferror(f)) fl->error = errno ? errno : EIO;
+    fclose(f);
+#else
+    int fd = open(fl->path, O_RDONLY);
+    if (fd < 0) {
+        fl->error = errno;
+        return;
+    }
+    while (got < size) {
+        ssize_t n = read(fd, fl->content.data + got, size - got);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fl->error = errno;
+            break;
+        }
+        if (n == 0) break; // the file shrank since we stat()ed it
+        got += (size_t)n;
+    }
+    close(fd);
+#endif // defined(_WIN32)
+    // NOTE: If the file grew since we stat()ed it, we only give back what was there back then
+    fl->content.count = got;
+    fl->content.data[got] = '\0';
+}
+
+static void *c_file_load_worker(void *arg) {
+    c_File_load_job *job = (c_File_load_job *)arg;
+    for (;;) {
+        size_t i = C_ATOMIC_FETCH_ADD(&job->next, (size_t)1);
+        if (i >= job->count) break;
+
+        c_File_load *fl = &job->files[i];
+        if (job->buff == NULL) {
+            c_file_load_stat(fl);
+        } else if (fl->error == 0) {
+            c_file_load_read(fl);
+        }
+    }
+    return NULL;
+}
+
+// Runs the job on the calling thread plus `n_threads-1` helpers
+static void c_file_load_run(c_File_load_job *job, int n_threads) {
+    c_Thread threads[64];
+    int spawned = 0;
+    job->next = 0;
+    for (int i = 1; i < n_threads && spawned < (int)C_ARRAY_LEN(threads); ++i) {
+        if (!c_thread_create(&threads[spawned], c_file_load_worker, job)) break;
+        spawned++;
+    }
+    c_file_load_worker(job);
+    for (int i = 0; i < spawned; ++i) c_thread_join(threads[i]);
+}
+
+size_t c_load_files(c_File_load *files, size_t count, c_Arena *a, int n_threads) {
+    if (count == 0) return 0;
+
+    if (n_threads <= 0) {
+        // Loading is mostly waiting on syscalls, so we can go well past the cpu count
+        n_threads = c_cpu_count()*2;
+        if (n_threads > 32) n_threads = 32;
+    }
+    if ((size_t)n_threads > count) n_threads = (int)count;
+
+    for (size_t i = 0; i < count; ++i) {
+        files[i].content.data = NULL;
+        files[i].content.count = 0;
+        files[i].error = 0;
+    }
+
+    // Phase 1: Get all the sizes
+    c_File_load_job job = { .files = files, .count = count, .buff = NULL };
+    c_file_load_run(&job, n_threads);
+
+    // One allocation for everything; each file gets its size + 1 for the NUL
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (files[i].error == 0) total += files[i].content.count + 1;
+    }
+    job.buff = c_arena_alloc(a, total == 0 ? 1 : total);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (files[i].error != 0) continue;
+        files[i].content.data = job.buff + offset;
+        offset += files[i].content.count + 1;
+    }
+
+    // Phase 2: Read everything in place
+    c_file_load_run(&job, n_threads);
+
+    size_t loaded = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (files[i].error == 0) {
+            loaded++;
+        } else {
+            files[i].content.data = NULL;
+            files[i].content.count = 0;
+        }
+    }
+    return loaded;
+}
+
+//
+// File writer
+//
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif // defined(_WIN32)
+
+static bool c_file_writer_write_all(c_File_writer *w, const char *data, size_t size) {
+    while (size > 0) {
+#if defined(_WIN32)
+        int n = _write(w->fd, data, size > INT_MAX ? INT_MAX : (unsigned)size);
+#else
+        ssize_t n = write(w->fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+#if defined(O_DIRECT)
+        if (n < 0 && errno == EINVAL && w->direct) {
+            // The filesystem doesn't like our O_DIRECT writes after all
+            fcntl(w->fd, F_SETFL, fcntl(w->fd, F_GETFL) & ~O_DIRECT);
+            w->direct = false;
+            continue;
+        }
+#endif // defined(O_DIRECT)
+#endif // defined(_WIN32)
+        if (n <= 0) {
+            c_log_error("'%s': Failed to write: %s", w->path, strerror(errno));
+            w->failed = true;
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+        w->written += (uint64)n;
+    }
+    return true;
+}
+
+static int c_file_writer_open_fd(cstr path, bool exclusive, bool direct) {
+#if defined(_WIN32)
+    (void)direct;
+    int oflags = _O_WRONLY | _O_CREAT | _O_BINARY | (exclusive ? _O_EXCL : _O_TRUNC);
+    return _open(path, oflags, _S_IREAD | _S_IWRITE);
+#else
+    int oflags = O_WRONLY | O_CREAT | (exclusive ? O_EXCL : O_TRUNC);
+#if defined(O_DIRECT)
+    if (direct) {
+        int fd = open(path, oflags | O_DIRECT, 0666);
+        if (fd >= 0 || errno != EINVAL) return fd;
+        // EINVAL: The filesystem doesn't support O_DIRECT (eg: tmpfs)
+    }
+#else
+    (void)direct;
+#endif // defined(O_DIRECT)
+    return open(path, oflags, 0666);
+#endif // defined(_WIN32)
+}
+
+bool c_file_writer_open(c_File_writer *w, cstr path, int flags, size_t buffer_size) {
+    C_MEMSET(w, 0, sizeof(*w));
+    w->fd = -1;
+    w->flags = flags;
+    if (buffer_size == 0) buffer_size = C_FILE_WRITER_DEFAULT_BUFFER_SIZE;
+    // O_DIRECT writes need to be whole aligned blocks
+    buffer_size = (buffer_size + C_FILE_WRITER_ALIGNMENT-1) & ~(size_t)(C_FILE_WRITER_ALIGNMENT-1);
+
+    size_t path_len = strlen(path);
+    w->path = C_MALLOC(path_len + 1);
+    C_ASSERT(w->path != NULL, "Buy more RAM bruh");
+    C_MEMCPY(w->path, path, path_len + 1);
+
+    bool direct = (flags & C_WRITE_DIRECT) != 0;
+    if (flags & C_WRITE_ATOMIC) {
+        // The temp file must be on the same filesystem for the rename to be atomic, so put it right next to `path`
+        static uint64 counter = 0;
+        size_t tmp_size = path_len + 64;
+        w->tmp_path = C_MALLOC(tmp_size);
+        C_ASSERT(w->tmp_path != NULL, "Buy more RAM bruh");
+        for (int attempt = 0; attempt < 100 && w->fd < 0; ++attempt) {
+#if defined(_WIN32)
+            long pid = (long)_getpid();
+#else
+            long pid = (long)getpid();
+#endif // defined(_WIN32)
+            snprintf(w->tmp_path, tmp_size, "%s.tmp.%ld.%llu", path, pid, (unsigned long long)C_ATOMIC_FETCH_ADD(&counter, (uint64)1));
+            w->fd = c_file_writer_open_fd(w->tmp_path, true, direct);
+            if (w->fd < 0 && errno != EEXIST) break;
+        }
+    } else {
+        w->fd = c_file_writer_open_fd(path, false, direct);
+    }
+
+    if (w->fd < 0) {
+        c_log_error("'%s': %s", path, strerror(errno));
+        C_FREE(w->path);
+        C_FREE(w->tmp_path);
+        w->path = w->tmp_path = NULL;
+        return false;
+    }
+
+#if defined(O_DIRECT)
+    w->direct = direct && (fcntl(w->fd, F_GETFL) & O_DIRECT) != 0;
+#endif // defined(O_DIRECT)
+
+#if !defined(_WIN32)
+    if (w->tmp_path) {
+        // The temp file got 0666 & ~umask; Give it the mode of the file it's going to replace
+        struct stat st;
+        if (stat(path, &st) == 0 && fchmod(w->fd, st.st_mode & 07777) != 0) {
+            c_log_warning("'%s': Failed to keep the file mode: %s", path, strerror(errno));
+        }
+    }
+#endif // !defined(_WIN32)
+
+    w->buff_mem = C_MALLOC(buffer_size + C_FILE_WRITER_ALIGNMENT);
+    C_ASSERT(w->buff_mem != NULL, "Buy more RAM bruh");
+    w->buff = (char *)(((uintptr_t)w->buff_mem + C_FILE_WRITER_ALIGNMENT-1) & ~(uintptr_t)(C_FILE_WRITER_ALIGNMENT-1));
+    w->capacity = buffer_size;
+    return true;
+}
+
+bool c_file_writer_flush(c_File_writer *w) {
+    if (w->failed) return false;
+    if (w->count == 0) return true;
+
+#if defined(O_DIRECT)
+    if (w->direct && w->count % C_FILE_WRITER_ALIGNMENT != 0) {
+        // A partial block; the file offset won't be aligned after this, so O_DIRECT is done for
+        fcntl(w->fd, F_SETFL, fcntl(w->fd, F_GETFL) & ~O_DIRECT);
+        w->direct = false;
+    }
+#endif // defined(O_DIRECT)
+
+    bool ok = c_file_writer_write_all(w, w->buff, w->count);
+    w->count = 0;
+    return ok;
+}
+
+bool c_file_writer_write(c_File_writer *w, const void *data, size_t size) {
+    if (w->failed) return false;
+    const char *d = (const char *)data;
+
+    if (w->count + size <= w->capacity) {
+        C_MEMCPY(w->buff + w->count, d, size);
+        w->count += size;
+        return true;
+    }
+
+    // Top off the buffer so it goes out as one full (aligned) block
+    size_t n = w->capacity - w->count;
+    C_MEMCPY(w->buff + w->count, d, n);
+    w->count += n;
+    d += n;
+    size -= n;
+    if (!c_file_writer_flush(w)) return false;
+
+    // User memory isn't aligned, so O_DIRECT writes keep going through the buffer
+    if (!w->direct && size >= w->capacity) {
+        return c_file_writer_write_all(w, d, size);
+    }
+    while (size > w->capacity) {
+        C_MEMCPY(w->buff, d, w->capacity);
+        w->count = w->capacity;
+        d += w->capacity;
+        size -= w->capacity;
+        if (!c_file_writer_flush(w)) return false;
+    }
+    C_MEMCPY(w->buff, d, size);
+    w->count = size;
+    return true;
+}
+
+bool c_file_writer_write_sv(c_File_writer *w, c_String_view sv) {
+    return c_file_writer_write(w, sv.data, sv.count);
+}
+
+bool c_file_writer_write_sb(c_File_writer *w, const c_String_builder *sb) {
+    return c_file_writer_write(w, sb->items, sb->count);
+}
+
+bool c_file_writer_writef(c_File_writer *w, const char *fmt, ...) {
+    if (w->failed) return false;
+
+    va_list args;
+    va_start(args, fmt);
+    size_t spare = w->capacity - w->count;
+    int n = vsnprintf(w->buff + w->count, spare, fmt, args);
+    va_end(args);
+    C_ASSERT(n >= 0, "Invalid format string");
+
+    // NOTE: vsnprintf needs room for the NUL too, which we don't keep
+    if ((size_t)n < spare) {
+        w->count += (size_t)n;
+        return true;
+    }
+
+    char *heap_buff = C_MALLOC((size_t)n + 1);
+    C_ASSERT(heap_buff != NULL, "Buy more RAM bruh");
+    va_start(args, fmt);
+    vsnprintf(heap_buff, (size_t)n + 1, fmt, args);
+    va_end(args);
+    bool ok = c_file_writer_write(w, heap_buff, (size_t)n);
+    C_FREE(heap_buff);
+    return ok;
+}
+
+// fsync()s the directory `path` is in, so the rename itself survives a crash
+static void c_file_writer_sync_dir(cstr path) {
+#if defined(_WIN32)
+    (void)path; // MOVEFILE_WRITE_THROUGH already takes care of this
+#else
+    const char *slash = strrchr(path, '/');
+    char dir[4096] = ".";
+    if (slash != NULL) {
+        size_t len = slash == path ? 1 : (size_t)(slash - path);
+        if (len >= sizeof(dir)) return;
+        C_MEMCPY(dir, path, len);
+        dir[len] = '\0';
+    }
+    int fd = open(dir, O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+#endif // defined(_WIN32)
+}
+
+bool c_file_writer_close(c_File_writer *w) {
+    bool ok = c_file_writer_flush(w);
+
+#if defined(_WIN32)
+    if (ok && w->tmp_path && _commit(w->fd) != 0) {
+#else
+    if (ok && w->tmp_path && fsync(w->fd) != 0) {
+#endif // defined(_WIN32)
+        c_log_error("'%s': Failed to sync: %s", w->tmp_path, strerror(errno));
+        ok = false;
+    }
+#if defined(_WIN32)
+    if (_close(w->fd) != 0) ok = false;
+#else
+    if (close(w->fd) != 0) ok = false;
+#endif // defined(_WIN32)
+
+    if (w->tmp_path) {
+#if defined(_WIN32)
+        if (ok && !MoveFileExA(w->tmp_path, w->path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            c_log_error("'%s': Failed to replace (error %lu)", w->path, GetLastError());
+            ok = false;
+        }
+#else
+        if (ok && rename(w->tmp_path, w->path) != 0) {
+            c_log_error("'%s': Failed to replace: %s", w->path, strerror(errno));
+            ok = false;
+        }
+        if (ok) c_file_writer_sync_dir(w->path);
+#endif // defined(_WIN32)
+        if (!ok) remove(w->tmp_path);
+    }
+
+    C_FREE(w->buff_mem);
+    C_FREE(w->path);
+    C_FREE(w->tmp_path);
+    C_MEMSET(w, 0, sizeof(*w));
+    w->fd = -1;
+    return ok;
+}
+
+//
+// Directory walker
+//
+
+// NOTE: openat()/fstatat()/fdopendir() and O_DIRECTORY/O_CLOEXEC are POSIX.1-2008, which the top of this file
+//       asks for in strict ISO C modes.
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif // !defined(_WIN32)
+
+#define C_DIR_WALK_NO_PARENT ((size_t)-1)
+
+typedef struct {
+    c_Dir_walk *walk;
+    int flags;
+    c_Dir_filter filter;
+    void *user;
+} c_Dir_walk_ctx;
+
+cstr c_dir_entry_path(const c_Dir_walk *walk, const c_Dir_entry *e) {
+    return walk->names.items + e->path_offset;
+}
+
+cstr c_dir_entry_name(const c_Dir_walk *walk, const c_Dir_entry *e) {
+    return walk->names.items + e->path_offset + e->name_offset;
+}
+
+// Stores "<parent>/<name>" in walk->names without adding an entry; `parent` is an offset into walk->names.
+static size_t c_dir_walk_push_path(c_Dir_walk *walk, size_t parent, const char *name, uint32 *name_offset) {
+    size_t name_len = strlen(name);
+    size_t parent_len = parent == C_DIR_WALK_NO_PARENT ? 0 : strlen(walk->names.items + parent);
+    // NOTE: Reserve before taking pointers into names, it might move
+    c_sb_reserve(&walk->names, parent_len + 1 + name_len + 1);
+
+    size_t offset = walk->names.count;
+    char *p = walk->names.items + offset;
+    if (parent_len > 0) {
+        C_MEMCPY(p, walk->names.items + parent, parent_len);
+        p[parent_len++] = '/';
+    }
+    C_MEMCPY(p + parent_len, name, name_len + 1);
+    walk->names.count += parent_len + name_len + 1;
+    if (name_offset) *name_offset = (uint32)parent_len;
+    return offset;
+}
+
+// Adds the entry unless the filter says no; Gives back the offset of its path or C_DIR_WALK_NO_PARENT.
+static size_t c_dir_walk_add(c_Dir_walk_ctx *ctx, size_t parent, const char *name, c_Dir_entry_type type) {
+    c_Dir_walk *walk = ctx->walk;
+    size_t names_count = walk->names.count;
+
+    uint32 name_offset = 0;
+    size_t offset = c_dir_walk_push_path(walk, parent, name, &name_offset);
+    const char *path = walk->names.items + offset;
+    if (ctx->filter && !ctx->filter(path, path + name_offset, type, ctx->user)) {
+        walk->names.count = names_count;
+        return C_DIR_WALK_NO_PARENT;
+    }
+
+    c_Dir_entry e = {
+        .path_offset = offset,
+        .name_offset = name_offset,
+        .type = type,
+    };
+    c_darr_append(*walk, e);
+    return offset;
+}
+
+static void c_dir_walk_merge(c_Dir_walk *dst, const c_Dir_walk *src) {
+    size_t base = dst->names.count;
+    c_sb_reserve(&dst->names, src->names.count);
+    C_MEMCPY(dst->names.items + base, src->names.items, src->names.count);
+    dst->names.count += src->names.count;
+    for (size_t i = 0; i < src->count; ++i) {
+        c_Dir_entry e = src->items[i];
+        e.path_offset += base;
+        c_darr_append(*dst, e);
+    }
+}
+
+void c_dir_walk_free(c_Dir_walk *walk) {
+    C_FREE(walk->items);
+    c_sb_free(&walk->names);
+    C_MEMSET(walk, 0, sizeof(*walk));
+}
+
+#if defined(_WIN32)
+static void c_dir_walk_dir(c_Dir_walk_ctx *ctx, const char *root, size_t parent) {
+    c_String_builder pattern = {0};
+    c_sb_append(&pattern, (char *)root);
+    if (parent != C_DIR_WALK_NO_PARENT) {
+        c_sb_append_char(&pattern, '\\');
+        c_sb_append(&pattern, ctx->walk->names.items + parent);
+    }
+    c_sb_append(&pattern, "\\*");
+    c_sb_append_null(&pattern);
+
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileExA(pattern.items, FindExInfoBasic, &fd, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+    c_sb_free(&pattern);
+    if (h == INVALID_HANDLE_VALUE) return;
+
+    do {
+        if (strcmp(fd.cFileName, ".") == 0 || strcmp(fd.cFileName, "..") == 0) continue;
+        c_Dir_entry_type type = C_DIR_ENTRY_FILE;
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) type = C_DIR_ENTRY_LINK;
+        else if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) type = C_DIR_ENTRY_DIR;
+
+        size_t offset = c_dir_walk_add(ctx, parent, fd.cFileName, type);
+        if (offset != C_DIR_WALK_NO_PARENT && type == C_DIR_ENTRY_DIR && (ctx->flags & C_WALK_RECURSIVE)) {
+            c_dir_walk_dir(ctx, root, offset);
+        }
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+}
+
+bool c_dir_walk(c_Dir_walk *walk, cstr dir, int flags, c_Dir_filter filter, void *user) {
+    DWORD attrs = GetFileAttributesA(dir);
+    if (attrs == INVALID_FILE_ATTRIBUTES || !(attrs & FILE_ATTRIBUTE_DIRECTORY)) {
+        c_log_error("'%s': Failed to open directory", dir);
+        return false;
+    }
+    // NOTE: C_WALK_THREADED is single-threaded here, see its comment
+    if (flags & C_WALK_THREADED) flags |= C_WALK_RECURSIVE;
+    c_Dir_walk_ctx ctx = { .walk = walk, .flags = flags, .filter = filter, .user = user };
+    c_dir_walk_dir(&ctx, dir, C_DIR_WALK_NO_PARENT);
+    return true;
+}
+#else
+typedef struct {
+    char **items;
+    size_t count;
+    size_t capacity;
+} c_Dir_walk_paths; // @darr
+
+// Shared between the threads of a C_WALK_THREADED walk
+typedef struct {
+    int root_fd;
+    int flags;
+    c_Dir_filter filter;
+    void *user;
+
+    c_Mutex lock;
+    c_Cond cond;              // signaled when there is more pending, or when the walk is done
+    c_Dir_walk_paths pending; // directories (relative to root_fd) nobody has walked yet
+    size_t busy;              // threads currently walking a directory
+} c_Dir_walk_shared;
+
+typedef struct {
+    c_Dir_walk_shared *shared;
+    c_Dir_walk walk; // what this thread found, merged at the end
+} c_Dir_walk_worker_arg;
+
+static c_Dir_entry_type c_dir_walk_stat_type(int dir_fd, const char *name) {
+    struct stat st;
+    if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) < 0) return C_DIR_ENTRY_OTHER;
+    if (S_ISREG(st.st_mode)) return C_DIR_ENTRY_FILE;
+    if (S_ISDIR(st.st_mode)) return C_DIR_ENTRY_DIR;
+    if (S_ISLNK(st.st_mode)) return C_DIR_ENTRY_LINK;
+    return C_DIR_ENTRY_OTHER;
+}
+
+// Walks the dir `fd` (and closes it); Subdirs are either walked right away or handed to `shared`.
+static void c_dir_walk_fd(c_Dir_walk_ctx *ctx, int fd, size_t parent, c_Dir_walk_shared *shared) {
+    DIR *d = fdopendir(fd);
+    if (d == NULL) {
+        close(fd);
+        return;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(d)) != NULL) {
+        const char *name = ent->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+        c_Dir_entry_type type;
+#if defined(DT_DIR)
+        // d_type saves us a stat() on most filesystems
+        switch (ent->d_type) {
+            case DT_REG: type = C_DIR_ENTRY_FILE; break;
+            case DT_DIR: type = C_DIR_ENTRY_DIR;  break;
+            case DT_LNK: type = C_DIR_ENTRY_LINK; break;
+            case DT_UNKNOWN: type = c_dir_walk_stat_type(dirfd(d), name); break;
+            default: type = C_DIR_ENTRY_OTHER; break;
+        }
+#else
+        type = c_dir_walk_stat_type(dirfd(d), name);
+#endif // defined(DT_DIR)
+
+        size_t offset = c_dir_walk_add(ctx, parent, name, type);
+        if (offset == C_DIR_WALK_NO_PARENT || type != C_DIR_ENTRY_DIR || !(ctx->flags & C_WALK_RECURSIVE)) continue;
+
+        if (shared) {
+            const char *path = ctx->walk->names.items + offset;
+            size_t len = strlen(path);
+            char *copy = C_MALLOC(len + 1);
+            C_ASSERT(copy != NULL, "Buy more RAM bruh");
+            C_MEMCPY(copy, path, len + 1);
+            c_mutex_lock(&shared->lock);
+            c_darr_append(shared->pending, copy);
+            c_cond_signal(&shared->cond);
+            c_mutex_unlock(&shared->lock);
+        } else {
+            int sub = openat(dirfd(d), name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (sub >= 0) c_dir_walk_fd(ctx, sub, offset, NULL);
+        }
+    }
+    closedir(d);
+}
+
+static void *c_dir_walk_worker(void *arg) {
+    c_Dir_walk_shared *shared = ((c_Dir_walk_worker_arg *)arg)->shared;
+    c_Dir_walk *walk = &((c_Dir_walk_worker_arg *)arg)->walk;
+    c_Dir_walk_ctx ctx = { .walk = walk, .flags = shared->flags, .filter = shared->filter, .user = shared->user };
+
+    for (;;) {
+        c_mutex_lock(&shared->lock);
+        // Someone still walking might find more to do; Otherwise we're done
+        while (shared->pending.count == 0 && shared->busy > 0) c_cond_wait(&shared->cond, &shared->lock);
+        if (shared->pending.count == 0) {
+            c_mutex_unlock(&shared->lock);
+            break;
+        }
+        char *path = shared->pending.items[--shared->pending.count];
+        shared->busy++;
+        c_mutex_unlock(&shared->lock);
+
+        int fd = openat(shared->root_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0) {
+            // The path has to be in our own names for the children to be built from it
+            size_t parent = c_dir_walk_push_path(walk, C_DIR_WALK_NO_PARENT, path, NULL);
+            c_dir_walk_fd(&ctx, fd, parent, shared);
+        }
+        C_FREE(path);
+
+        c_mutex_lock(&shared->lock);
+        shared->busy--;
+        if (shared->busy == 0 && shared->pending.count == 0) c_cond_broadcast(&shared->cond);
+        c_mutex_unlock(&shared->lock);
+    }
+    return NULL;
+}
+
+bool c_dir_walk(c_Dir_walk *walk, cstr dir, int flags, c_Dir_filter filter, void *user) {
+    int root_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd < 0) {
+        c_log_error("'%s': %s", dir, strerror(errno));
+        return false;
+    }
+
+    c_Dir_walk_ctx ctx = { .walk = walk, .flags = flags, .filter = filter, .user = user };
+    if (!(flags & C_WALK_THREADED)) {
+        c_dir_walk_fd(&ctx, root_fd, C_DIR_WALK_NO_PARENT, NULL);
+        return true;
+    }
+
+    c_Dir_walk_shared shared = {
+        .root_fd = root_fd,
+        .flags = flags | C_WALK_RECURSIVE,
+        .filter = filter,
+        .user = user,
+    };
+    c_mutex_init(&shared.lock);
+    c_cond_init(&shared.cond);
+    ctx.flags = shared.flags;
+
+    // The top level is walked here, which gives the workers something to start on
+    int fd = dup(root_fd);
+    if (fd >= 0) c_dir_walk_fd(&ctx, fd, C_DIR_WALK_NO_PARENT, &shared);
+
+    int n_threads = c_cpu_count();
+    if (n_threads > 64) n_threads = 64;
+    c_Thread threads[64];
+    c_Dir_walk_worker_arg args[64] = {0};
+    int spawned = 0;
+    for (int i = 0; i < n_threads; ++i) args[i].shared = &shared;
+    for (int i = 1; i < n_threads; ++i) {
+        if (!c_thread_create(&threads[spawned], c_dir_walk_worker, &args[spawned])) break;
+        spawned++;
+    }
+    c_dir_walk_worker(&args[spawned]);
+
+    for (int i = 0; i < spawned; ++i) c_thread_join(threads[i]);
+    for (int i = 0; i <= spawned; ++i) {
+        c_dir_walk_merge(walk, &args[i].walk);
+        c_dir_walk_free(&args[i].walk);
+    }
+
+    c_darr_free(shared.pending);
+    c_cond_destroy(&shared.cond);
+    c_mutex_destroy(&shared.lock);
+    close(root_fd);
+    return true;
+}
+#endif // defined(_WIN32)
+
+//
+// File watcher
+//
+
+cstr c_watch_event_path(const c_Watch_events *events, const c_Watch_event *e) {
+    return events->names.items + e->path_offset;
+}
+
+void c_watch_events_free(c_Watch_events *events) {
+    C_FREE(events->items);
+    c_sb_free(&events->names);
+    C_MEMSET(events, 0, sizeof(*events));
+}
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+
+#define C_WATCH_MASK (IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+
+bool c_os_watch_init(c_Watch *w) {
+    C_MEMSET(w, 0, sizeof(*w));
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (w->fd < 0) {
+        c_log_error("Failed to init inotify: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// Binary search; Gives back where `wd` is, or where it would go
+static size_t c_watch_find(const c_Watch *w, int wd) {
+    size_t lo = 0, hi = w->targets.count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo)/2;
+        if (w->targets.items[mid].wd < wd) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// NOTE: Might move w->paths, so `path` can't point into it
+static void c_watch_set_path(c_Watch *w, c_Watch_target *t, const char *path, size_t len) {
+    c_sb_reserve(&w->paths, len + 1);
+    t->path_offset = w->paths.count;
+    C_MEMCPY(w->paths.items + w->paths.count, path, len);
+    w->paths.items[w->paths.count + len] = '\0';
+    w->paths.count += len + 1;
+}
+
+static void c_watch_forget_path(c_Watch *w, const c_Watch_target *t) {
+    w->paths_unused += strlen(w->paths.items + t->path_offset) + 1;
+}
+
+static void c_watch_remove_target(c_Watch *w, size_t i) {
+    c_watch_forget_path(w, &w->targets.items[i]);
+    C_MEMMOVE(w->targets.items + i, w->targets.items + i + 1, (w->targets.count - i - 1) * sizeof(*w->targets.items));
+    w->targets.count--;
+}
+
+// Drops the paths no target points to anymore
+// NOTE: Moves w->paths, so don't hold on to pointers into it across this
+static void c_watch_compact_paths(c_Watch *w) {
+    c_String_builder paths = {0};
+    c_sb_reserve(&paths, w->paths.count - w->paths_unused);
+    for (size_t i = 0; i < w->targets.count; ++i) {
+        c_Watch_target *t = &w->targets.items[i];
+        const char *path = w->paths.items + t->path_offset;
+        size_t len = strlen(path);
+        t->path_offset = paths.count;
+        C_MEMCPY(paths.items + paths.count, path, len + 1);
+        paths.count += len + 1;
+    }
+    c_sb_free(&w->paths);
+    w->paths = paths;
+    w->paths_unused = 0;
+}
+
+// Is `path` `dir` itself or something under it?
+static bool c_watch_path_under(const char *path, const char *dir, size_t dir_len) {
+    return strncmp(path, dir, dir_len) == 0 && (path[dir_len] == '\0' || path[dir_len] == '/');
+}
+
+static bool c_os_watch_add_one(c_Watch *w, cstr path, bool recursive, bool rearm) {
+    int wd = inotify_add_watch(w->fd, path, C_WATCH_MASK | (recursive ? IN_ONLYDIR : 0));
+    if (wd < 0) {
+        c_log_error("'%s': Failed to watch: %s", path, strerror(errno));
+        return false;
+    }
+
+    size_t len = strlen(path);
+    // Strip trailing '/'s so "<dir>/<name>" comes out clean
+    while (len > 1 && path[len-1] == '/') len--;
+
+    size_t i = c_watch_find(w, wd);
+    if (i < w->targets.count && w->targets.items[i].wd == wd) {
+        // NOTE: Watching the same dir/file again gives back the same wd; If it was renamed, the path we have is stale
+        c_Watch_target *t = &w->targets.items[i];
+        t->recursive = t->recursive || recursive;
+        const char *old = w->paths.items + t->path_offset;
+        if (strncmp(old, path, len) != 0 || old[len] != '\0') {
+            c_watch_forget_path(w, t);
+            c_watch_set_path(w, t, path, len);
+        }
+        return true;
+    }
+
+    c_Watch_target t = {
+        .wd = wd,
+        .recursive = recursive,
+        .rearm = rearm,
+    };
+    c_darr_append(w->targets, t);
+    C_MEMMOVE(w->targets.items + i + 1, w->targets.items + i, (w->targets.count - 1 - i) * sizeof(t));
+    w->targets.items[i] = t;
+    c_watch_set_path(w, &w->targets.items[i], path, len);
+    return true;
+}
+
+// A watched dir was renamed from `from` to `to`; The watches follow the dirs, only their paths have to change.
+static void c_watch_repath_tree(c_Watch *w, const char *from, const char *to) {
+    size_t from_len = strlen(from);
+    c_String_builder path = {0};
+    for (size_t i = 0; i < w->targets.count; ++i) {
+        c_Watch_target *t = &w->targets.items[i];
+        const char *old = w->paths.items + t->path_offset;
+        if (!c_watch_path_under(old, from, from_len)) continue;
+        path.count = 0;
+        c_sb_append(&path, (char *)to);
+        c_sb_append(&path, (char *)old + from_len);
+        c_watch_forget_path(w, t);
+        c_watch_set_path(w, t, path.items, path.count);
+    }
+    c_sb_free(&path);
+}
+
+// A watched dir was moved out of the watched tree; Stop watching it and everything under it.
+static void c_watch_remove_tree(c_Watch *w, const char *dir) {
+    size_t dir_len = strlen(dir);
+    for (size_t i = w->targets.count; i-- > 0;) {
+        c_Watch_target *t = &w->targets.items[i];
+        if (!c_watch_path_under(w->paths.items + t->path_offset, dir, dir_len)) continue;
+        // NOTE: The IN_IGNORED this causes won't find the target anymore, which is fine
+        inotify_rm_watch(w->fd, t->wd);
+        c_watch_remove_target(w, i);
+    }
+}
+
+typedef struct {
+    c_Watch *w;
+    c_Watch_events *events; // NULL to not report the entries
+    c_String_builder path;
+    size_t base_len;
+} c_Watch_walk_ctx;
+
+static void c_watch_push_event(c_Watch *w, c_Watch_events *events, const char *dir, const char *name, int bits, bool is_dir);
+
+// Adds watches for every directory under `dir`; Filters see every entry, so this is where they're reported too.
+static bool c_os_watch_walk_filter(cstr path, cstr name, c_Dir_entry_type type, void *user) {
+    (void)name;
+    c_Watch_walk_ctx *ctx = (c_Watch_walk_ctx *)user;
+    ctx->path.count = ctx->base_len;
+    c_sb_append_char(&ctx->path, '/');
+    c_sb_append(&ctx->path, (char *)path);
+    c_sb_append_null(&ctx->path);
+
+    if (type == C_DIR_ENTRY_DIR) c_os_watch_add_one(ctx->w, ctx->path.items, true, false);
+    if (ctx->events) c_watch_push_event(ctx->w, ctx->events, ctx->path.items, NULL, C_WATCH_CREATED, type == C_DIR_ENTRY_DIR);
+    return type == C_DIR_ENTRY_DIR;
+}
+
+static void c_os_watch_add_tree(c_Watch *w, cstr dir, c_Watch_events *events) {
+    c_Watch_walk_ctx ctx = { .w = w, .events = events };
+    c_sb_append(&ctx.path, (char *)dir);
+    ctx.base_len = ctx.path.count;
+
+    c_Dir_walk walk = {0};
+    c_dir_walk(&walk, dir, C_WALK_RECURSIVE, c_os_watch_walk_filter, &ctx);
+    c_dir_walk_free(&walk);
+    c_sb_free(&ctx.path);
+}
+
+bool c_os_watch_add(c_Watch *w, cstr path, int flags) {
+    bool recursive = (flags & C_WATCH_RECURSIVE) != 0;
+    struct stat st;
+    bool is_file = !recursive && stat(path, &st) == 0 && !S_ISDIR(st.st_mode);
+    if (!c_os_watch_add_one(w, path, recursive, is_file)) return false;
+    if (recursive) c_os_watch_add_tree(w, path, NULL);
+    return true;
+}
+
+static void c_watch_push_event(c_Watch *w, c_Watch_events *events, const char *dir, const char *name, int bits, bool is_dir) {
+    size_t names_count = events->names.count;
+    size_t offset = names_count;
+    size_t dir_len = strlen(dir);
+    size_t name_len = name ? strlen(name) : 0;
+    c_sb_reserve(&events->names, dir_len + 1 + name_len + 1);
+    char *p = events->names.items + offset;
+    C_MEMCPY(p, dir, dir_len);
+    if (name_len > 0) {
+        p[dir_len++] = '/';
+        C_MEMCPY(p + dir_len, name, name_len);
+    }
+    p[dir_len + name_len] = '\0';
+    size_t len = dir_len + name_len;
+
+    // Keep the table atmost half full
+    if ((events->count + 1)*2 > w->table_size) {
+        size_t new_size = w->table_size ? w->table_size*2 : 64;
+        C_FREE(w->table);
+        w->table = C_MALLOC(new_size * sizeof(*w->table));
+        C_ASSERT(w->table != NULL, "Buy more RAM bruh");
+        C_MEMSET(w->table, 0, new_size * sizeof(*w->table));
+        w->table_size = new_size;
+        for (size_t i = 0; i < events->count; ++i) {
+            cstr path = events->names.items + events->items[i].path_offset;
+            size_t slot = (size_t)c_hash(path, strlen(path), 0) & (new_size - 1);
+            while (w->table[slot] != 0) slot = (slot + 1) & (new_size - 1);
+            w->table[slot] = (uint32)i + 1;
+        }
+    }
+
+    size_t slot = (size_t)c_hash(p, len, 0) & (w->table_size - 1);
+    while (w->table[slot] != 0) {
+        c_Watch_event *e = &events->items[w->table[slot] - 1];
+        const char *other = events->names.items + e->path_offset;
+        if (strncmp(other, p, len) == 0 && other[len] == '\0') {
+            e->events |= bits;
+            e->is_dir = e->is_dir || is_dir;
+            return; // The name we wrote past names.count just gets overwritten
+        }
+        slot = (slot + 1) & (w->table_size - 1);
+    }
+
+    events->names.count += len + 1;
+    c_Watch_event e = {
+        .path_offset = offset,
+        .events = bits,
+        .is_dir = is_dir,
+    };
+    c_darr_append(*events, e);
+    w->table[slot] = (uint32)events->count;
+}
+
+// A dir that was moved out of a watched dir, waiting for the other half of the rename
+typedef struct {
+    uint32 cookie;
+    size_t path_offset; // into c_Watch_moves.paths
+    bool done;          // the IN_MOVED_TO came, it was renamed within the watched tree
+} c_Watch_move;
+
+typedef struct {
+    c_Watch_move *items;
+    size_t count;
+    size_t capacity;
+    c_String_builder paths;
+} c_Watch_moves; // @darr
+
+bool c_os_watch_poll(c_Watch *w, c_Watch_events *events, int timeout_ms) {
+    events->count = 0;
+    events->names.count = 0;
+    if (w->table) C_MEMSET(w->table, 0, w->table_size * sizeof(*w->table));
+
+    struct pollfd pfd = { .fd = w->fd, .events = POLLIN };
+    int ready;
+    do {
+        ready = poll(&pfd, 1, timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+    if (ready < 0) {
+        c_log_error("Failed to poll inotify: %s", strerror(errno));
+        return false;
+    }
+    if (ready == 0) return true;
+
+    // Drain everything that's queued up in as few reads as possible
+    char buff[64*1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    c_Watch_moves moves = {0};
+    bool ok = true;
+    for (;;) {
+        ssize_t n = read(w->fd, buff, sizeof(buff));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) break;
+            c_log_error("Failed to read inotify: %s", strerror(errno));
+            ok = false;
+            break;
+        }
+
+        for (char *p = buff; p < buff + n;) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            p += sizeof(*ev) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                c_watch_push_event(w, events, "", NULL, C_WATCH_OVERFLOW, false);
+                continue;
+            }
+            size_t target = c_watch_find(w, ev->wd);
+            if (target >= w->targets.count || w->targets.items[target].wd != ev->wd) continue;
+            c_Watch_target *t = &w->targets.items[target];
+            if (ev->mask & IN_IGNORED) {
+                // The file/dir is gone (or unmounted), so is the watch
+                bool rearm = t->rearm;
+                c_String_builder path = {0};
+                if (rearm) {
+                    c_sb_append(&path, w->paths.items + t->path_offset);
+                    c_sb_append_null(&path);
+                }
+                c_watch_remove_target(w, target);
+                // Something took its place, most likely an editor saving through a rename
+                if (rearm && access(path.items, F_OK) == 0 && c_os_watch_add_one(w, path.items, false, true)) {
+                    c_watch_push_event(w, events, path.items, NULL, C_WATCH_CREATED, false);
+                }
+                c_sb_free(&path);
+                continue;
+            }
+
+            int bits = 0;
+            if (ev->mask & IN_CREATE)                      bits |= C_WATCH_CREATED;
+            if (ev->mask & (IN_MODIFY | IN_ATTRIB))        bits |= C_WATCH_MODIFIED;
+            if (ev->mask & (IN_DELETE | IN_DELETE_SELF))   bits |= C_WATCH_DELETED;
+            if (ev->mask & (IN_MOVED_FROM | IN_MOVE_SELF)) bits |= C_WATCH_MOVED | C_WATCH_DELETED;
+            if (ev->mask & IN_MOVED_TO)                    bits |= C_WATCH_MOVED | C_WATCH_CREATED;
+            if (bits == 0) continue;
+
+            bool is_dir = (ev->mask & IN_ISDIR) != 0;
+            const char *dir = w->paths.items + t->path_offset;
+            const char *name = ev->len > 0 ? ev->name : NULL;
+            c_watch_push_event(w, events, dir, name, bits, is_dir);
+
+            if (!t->recursive || !is_dir || !name || !(ev->mask & (IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO))) continue;
+            c_String_builder sub = {0};
+            c_sb_append(&sub, (char *)dir);
+            c_sb_append_char(&sub, '/');
+            c_sb_append(&sub, (char *)name);
+            c_sb_append_null(&sub);
+
+            if (ev->mask & IN_MOVED_FROM) {
+                // Renamed within the tree if the IN_MOVED_TO with the same cookie shows up, moved out otherwise
+                c_Watch_move move = { .cookie = ev->cookie, .path_offset = moves.paths.count };
+                c_sb_append(&moves.paths, sub.items);
+                c_sb_append_null(&moves.paths);
+                c_darr_append(moves, move);
+                c_sb_free(&sub);
+                continue;
+            }
+
+            c_Watch_move *from = NULL;
+            for (size_t i = 0; i < moves.count && (ev->mask & IN_MOVED_TO); ++i) {
+                if (moves.items[i].cookie == ev->cookie && !moves.items[i].done) from = &moves.items[i];
+            }
+            if (from) {
+                from->done = true;
+                c_watch_repath_tree(w, moves.paths.items + from->path_offset, sub.items);
+            } else if (c_os_watch_add_one(w, sub.items, true, false)) {
+                // NOTE: Things can be created in the new dir before we watch it, so we report what's already in there
+                c_os_watch_add_tree(w, sub.items, events);
+            }
+            c_sb_free(&sub);
+        }
+    }
+
+    for (size_t i = 0; i < moves.count; ++i) {
+        if (!moves.items[i].done) c_watch_remove_tree(w, moves.paths.items + moves.items[i].path_offset);
+    }
+    c_darr_free(moves);
+    c_sb_free(&moves.paths);
+    if (w->paths_unused > w->paths.count/2) c_watch_compact_paths(w);
+    return ok;
+}
+
+void c_os_watch_close(c_Watch *w) {
+    if (w->fd >= 0) close(w->fd);
+    c_sb_free(&w->paths);
+    c_darr_free(w->targets);
+    C_FREE(w->table);
+    C_MEMSET(w, 0, sizeof(*w));
+    w->fd = -1;
+}
+#else
+bool c_os_watch_init(c_Watch *w) {
+    C_MEMSET(w, 0, sizeof(*w));
+    w->fd = -1;
+    c_log_error("c_os_watch is only implemented on Linux");
+    return false;
+}
+
+bool c_os_watch_add(c_Watch *w, cstr path, int flags) {
+    (void)w; (void)path; (void)flags;
+    return false;
+}
+
+bool c_os_watch_poll(c_Watch *w, c_Watch_events *events, int timeout_ms) {
+    (void)w; (void)timeout_ms;
+    events->count = 0;
+    events->names.count = 0;
+    return false;
+}
+
+void c_os_watch_close(c_Watch *w) {
+    (void)w;
+}
+#endif // defined(__linux__)
+
+//
+// Profiler
+//
+
+typedef struct {
+    const char *name; // NULL for the end of a zone
+    uint64 ticks;
+} c_Profile_event;
+
+typedef struct {
+    c_Profile_event *items;
+    size_t count;
+    size_t capacity;
+} c_Profile_events; // @darr
+
+typedef struct c_Profile_thread c_Profile_thread;
+struct c_Profile_thread {
+    // Single producer (the owning thread), single consumer (whoever collects under c_profile_lock)
+    c_Profile_event ring[C_PROFILE_RING_SIZE];
+    uint64 head;    // written by the owning thread
+    uint64 tail;    // written by the collector
+    uint64 dropped; // bumped by the owning thread, taken by the collector
+
+    c_Profile_events collected;
+    uint32 tid;
+    c_Profile_thread *next;
+};
+
+// NOTE: Thread buffers are never freed, so events of threads that have exited can still be collected
+static c_Mutex c_profile_lock = C_MUTEX_INIT;
+static c_Profile_thread *c_profile_threads = NULL;
+static uint32 c_profile_thread_count = 0;
+static C_THREAD_LOCAL c_Profile_thread *c_profile_this_thread = NULL;
+
+static c_Profile_thread *c_profile_register_thread(void) {
+    c_Profile_thread *t = C_MALLOC(sizeof(*t));
+    C_ASSERT(t != NULL, "Buy more RAM bruh");
+    // NOTE: No need to clear the ring itself
+    t->head = t->tail = t->dropped = 0;
+    C_MEMSET(&t->collected, 0, sizeof(t->collected));
+
+    c_mutex_lock(&c_profile_lock);
+    t->tid = ++c_profile_thread_count;
+    t->next = c_profile_threads;
+    c_profile_threads = t;
+    c_mutex_unlock(&c_profile_lock);
+
+    c_profile_this_thread = t;
+    return t;
+}
+
+static inline void c_profile_push(const char *name) {
+    c_Profile_thread *t = c_profile_this_thread;
+    if (t == NULL) t = c_profile_register_thread();
+
+    uint64 head = t->head;
+    if (head - C_ATOMIC_LOAD(&t->tail) >= C_PROFILE_RING_SIZE) {
+        C_ATOMIC_FETCH_ADD(&t->dropped, (uint64)1);
+        return;
+    }
+    c_Profile_event *e = &t->ring[head & (C_PROFILE_RING_SIZE - 1)];
+    e->name = name;
+    e->ticks = c_time_ticks();
+    C_ATOMIC_STORE(&t->head, head + 1);
+}
+
+void c_profile_begin(const char *name) {
+    c_profile_push(name);
+}
+
+void c_profile_end(void) {
+    c_profile_push(NULL);
+}
+
+// Moves what's in the rings to the collected events; c_profile_lock must be held
+static void c_profile_collect(void) {
+    for (c_Profile_thread *t = c_profile_threads; t; t = t->next) {
+        uint64 head = C_ATOMIC_LOAD(&t->head);
+        for (uint64 i = t->tail; i < head; ++i) {
+            c_darr_append(t->collected, t->ring[i & (C_PROFILE_RING_SIZE - 1)]);
+        }
+        C_ATOMIC_STORE(&t->tail, head);
+        uint64 dropped = C_ATOMIC_EXCHANGE(&t->dropped, (uint64)0);
+        if (dropped > 0) {
+            c_log_warning("Profiler: thread %u dropped %llu events; flush more often or raise C_PROFILE_RING_SIZE",
+                          t->tid, (unsigned long long)dropped);
+        }
+    }
+}
+
+static void c_profile_write_json_string(c_File_writer *w, const char *s) {
+    c_file_writer_write(w, "\"", 1);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') c_file_writer_write(w, "\\", 1);
+        if ((unsigned char)*s < 0x20) continue;
+        c_file_writer_write(w, s, 1);
+    }
+    c_file_writer_write(w, "\"", 1);
+}
+
+bool c_profile_write_trace(cstr path) {
+    c_File_writer w;
+    if (!c_file_writer_open(&w, path, C_WRITE_ATOMIC, 0)) return false;
+
+    c_mutex_lock(&c_profile_lock);
+    c_profile_collect();
+
+    uint64 base = UINT64_MAX;
+    for (c_Profile_thread *t = c_profile_threads; t; t = t->next) {
+        if (t->collected.count > 0 && t->collected.items[0].ticks < base) base = t->collected.items[0].ticks;
+    }
+
+    c_file_writer_writef(&w, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+    for (c_Profile_thread *t = c_profile_threads; t; t = t->next) {
+        for (size_t i = 0; i < t->collected.count; ++i) {
+            c_Profile_event e = t->collected.items[i];
+            // Chrome wants microseconds
+            uint64 ns = c_ticks_to_ns(e.ticks - base);
+            c_file_writer_writef(&w, "%s\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03llu",
+                                 first ? "" : ",", e.name ? 'B' : 'E', t->tid,
+                                 (unsigned long long)(ns / 1000), (unsigned long long)(ns % 1000));
+            if (e.name) {
+                c_file_writer_writef(&w, ",\"name\":");
+                c_profile_write_json_string(&w, e.name);
+            }
+            c_file_writer_write(&w, "}", 1);
+            first = false;
+        }
+    }
+    c_mutex_unlock(&c_profile_lock);
+
+    c_file_writer_writef(&w, "\n]}\n");
+    return c_file_writer_close(&w);
+}
+
+static c_Profile_stat *c_profile_stat_get(c_Profile_stats *stats, const char *name) {
+    for (size_t i = 0; i < stats->count; ++i) {
+        // Same literal most of the time, so check the pointer first
+        if (stats->items[i].name == name || strcmp(stats->items[i].name, name) == 0) return &stats->items[i];
+    }
+    c_Profile_stat s = { .name = name };
+    c_darr_append(*stats, s);
+    return &stats->items[stats->count - 1];
+}
+
+static int c_profile_stat_compare(const void *a, const void *b) {
+    const c_Profile_stat *sa = (const c_Profile_stat *)a;
+    const c_Profile_stat *sb = (const c_Profile_stat *)b;
+    if (sa->self_ns != sb->self_ns) return sa->self_ns < sb->self_ns ? 1 : -1;
+    return strcmp(sa->name, sb->name);
+}
+
+typedef struct {
+    const char *name;
+    uint64 start;
+    uint64 children; // ticks spent in nested zones
+} c_Profile_open_zone;
+
+void c_profile_summary(c_Profile_stats *stats) {
+    stats->count = 0;
+    c_Profile_open_zone stack[256];
+
+    c_mutex_lock(&c_profile_lock);
+    c_profile_collect();
+    for (c_Profile_thread *t = c_profile_threads; t; t = t->next) {
+        size_t depth = 0;
+        size_t overflow = 0; // zones nested deeper than the stack; they still count towards their parent
+        for (size_t i = 0; i < t->collected.count; ++i) {
+            c_Profile_event e = t->collected.items[i];
+            if (e.name) {
+                if (depth == C_ARRAY_LEN(stack)) {
+                    overflow++;
+                    continue;
+                }
+                stack[depth++] = (c_Profile_open_zone){ .name = e.name, .start = e.ticks };
+                continue;
+            }
+
+            if (overflow > 0) {
+                overflow--;
+                continue;
+            }
+            if (depth == 0) continue; // ended a zone that began before a c_profile_reset()
+
+            c_Profile_open_zone z = stack[--depth];
+            uint64 total = e.ticks - z.start;
+            if (depth > 0) stack[depth-1].children += total;
+
+            c_Profile_stat *s = c_profile_stat_get(stats, z.name);
+            s->calls++;
+            s->total_ns += c_ticks_to_ns(total);
+            s->self_ns += c_ticks_to_ns(total - z.children);
+        }
+    }
+    c_mutex_unlock(&c_profile_lock);
+
+    if (stats->count > 0) qsort(stats->items, stats->count, sizeof(*stats->items), c_profile_stat_compare);
+}
+
+void c_profile_print_summary(FILE *stream) {
+    c_Profile_stats stats = {0};
+    c_profile_summary(&stats);
+
+    uint64 all_self = 0;
+    for (size_t i = 0; i < stats.count; ++i) all_self += stats.items[i].self_ns;
+
+    fprintf(stream, "%-32s %10s %14s %14s %7s\n", "zone", "calls", "total (ms)", "self (ms)", "self %");
+    for (size_t i = 0; i < stats.count; ++i) {
+        c_Profile_stat s = stats.items[i];
+        fprintf(stream, "%-32s %10llu %14.3f %14.3f %6.2f%%\n", s.name, (unsigned long long)s.calls,
+                (float64)s.total_ns / 1e6, (float64)s.self_ns / 1e6,
+                all_self ? 100.0 * (float64)s.self_ns / (float64)all_self : 0.0);
+    }
+    c_darr_free(stats);
+}
+
+void c_profile_reset(void) {
+    c_mutex_lock(&c_profile_lock);
+    c_profile_collect();
+    for (c_Profile_thread *t = c_profile_threads; t; t = t->next) t->collected.count = 0;
+    c_mutex_unlock(&c_profile_lock);
+}
+
+//
+// Logging
+//
+
+#include <signal.h>
+#if defined(_WIN32)
+#include <io.h>
+#define C_LOG_FD_WRITE(fd, data, size) _write((fd), (data), (unsigned)(size))
+#else
+#include <unistd.h>
+#define C_LOG_FD_WRITE(fd, data, size) write((fd), (data), (size))
+#endif // defined(_WIN32)
+
+typedef struct c_Log_thread c_Log_thread;
+struct c_Log_thread {
+    // Records are [uint32 len | C_LOG_RECORD_STDERR][len bytes], wrapping around the end of the ring
+    char ring[C_LOG_RING_SIZE];
+    uint64 head; // written by the owning thread
+    uint64 tail; // written by the writer thread (under c_log_lock)
+    bool exited; // the owning thread is gone, freed once drained (under c_log_lock)
+    c_Log_thread *next;
+};
+
+#define C_LOG_RECORD_STDERR (1u << 31)
+#define C_LOG_RECORD_BINARY (1u << 30) // goes to the binary log
+#define C_LOG_RECORD_FLAGS  (C_LOG_RECORD_STDERR | C_LOG_RECORD_BINARY)
+
+// NOTE: A thread can exit with logs still queued, so its ring is only freed by the drain after that
+static c_Mutex c_log_lock = C_MUTEX_INIT;
+static c_Log_thread *c_log_threads = NULL;
+static C_THREAD_LOCAL c_Log_thread *c_log_this_thread = NULL;
+static int64 c_log_async = 0;          // async logging is on
+static int64 c_log_stop_requested = 0;
+static c_Thread c_log_writer;
+static c_Cond c_log_wake = C_COND_INIT;  // the writer waits here for something to write
+static c_Cond c_log_space = C_COND_INIT; // threads with a full ring wait here for the writer
+static int64 c_log_writer_idle = 0;      // the writer is waiting on c_log_wake (or about to)
+static size_t c_log_space_waiters = 0;   // under c_log_lock
+// Tells us when a thread exits, so its ring can be freed
+#if defined(_WIN32)
+static DWORD c_log_exit_key = FLS_OUT_OF_INDEXES;
+#else
+static pthread_key_t c_log_exit_key;
+#endif // defined(_WIN32)
+static bool c_log_exit_key_created = false; // under c_log_lock
+static c_String_builder c_log_batches[2]; // stdout, stderr; only touched under c_log_lock
+static C_THREAD_LOCAL bool c_log_holding_lock = false; // logging from under c_log_lock has to go straight out
+
+c_Log_module c_log_default_module = C_LOG_MODULE_INIT("default");
+int64 c_log_generation = 1;
+int64 c_blog_file_id = 0;
+static c_File_writer c_blog_writer; // only touched under c_log_lock
+static int64 c_blog_next_site_id = 1;
+static int64 c_blog_last_file_id = 0;
+static bool c_blog_started_async = false;
+
+// Runtime thresholds
+typedef struct {
+    char name[32];
+    int level;
+} c_Log_rule;
+
+static c_Log_rule c_log_rules[64];
+static size_t c_log_rules_count = 0;
+static c_Mutex c_log_rules_lock = C_MUTEX_INIT;
+
+void c_log_module_refresh(c_Log_module *m) {
+    c_mutex_lock(&c_log_rules_lock);
+    int64 generation = C_ATOMIC_LOAD(&c_log_generation);
+    int64 level = -1;
+    for (size_t i = 0; i < c_log_rules_count; ++i) {
+        if (strcmp(c_log_rules[i].name, m->name) == 0) {
+            level = c_log_rules[i].level;
+            break;
+        }
+        if (strcmp(c_log_rules[i].name, "*") == 0) level = c_log_rules[i].level;
+    }
+    // NOTE: The level has to be in place before the generation says it's up to date
+    C_ATOMIC_STORE(&m->level, level);
+    C_ATOMIC_STORE(&m->generation, generation);
+    c_mutex_unlock(&c_log_rules_lock);
+}
+
+void c_log_set_level(cstr module, c_Log_level level) {
+    if (module == NULL) module = "*";
+    c_mutex_lock(&c_log_rules_lock);
+    size_t i = 0;
+    while (i < c_log_rules_count && strcmp(c_log_rules[i].name, module) != 0) i++;
+    if (i == c_log_rules_count) {
+        C_ASSERT(c_log_rules_count < C_ARRAY_LEN(c_log_rules), "Too many log modules");
+        c_log_rules_count++;
+        snprintf(c_log_rules[i].name, sizeof(c_log_rules[i].name), "%s", module);
+    }
+    c_log_rules[i].level = (int)level;
+    C_ATOMIC_FETCH_ADD(&c_log_generation, (int64)1);
+    c_mutex_unlock(&c_log_rules_lock);
+}
+
+bool c_log_configure(cstr spec) {
+    static const char *names[] = { "debug", "info", "warning", "error", "off" };
+    c_String_view rest = c_sv_from_cstr(spec);
+    while (rest.count > 0) {
+        c_String_view rule = c_sv_lpop_until_char(&rest, ',');
+        c_sv_lremove(&rest, 1); // ','
+        c_sv_trim(&rule);
+        if (rule.count == 0) continue;
+
+        c_String_view module = c_sv_lpop_until_char(&rule, '=');
+        c_sv_lremove(&rule, 1); // '='
+        c_sv_trim(&module);
+        c_sv_trim(&rule);
+
+        int level = -1;
+        for (size_t i = 0; i < C_ARRAY_LEN(names); ++i) {
+            if (c_sv_equals(rule, c_sv_from_cstr(names[i]))) level = (int)i;
+        }
+        if (level < 0 || module.count == 0 || module.count >= sizeof(c_log_rules[0].name)) {
+            c_log_error("Invalid log level rule '"c_SV_FMT"="c_SV_FMT"'", c_SV_ARG(module), c_SV_ARG(rule));
+            return false;
+        }
+        char name[sizeof(c_log_rules[0].name)];
+        C_MEMCPY(name, module.data, module.count);
+        name[module.count] = '\0';
+        c_log_set_level(name, (c_Log_level)level);
+    }
+    return true;
+}
+
+static void c_log_write_fd(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        int64 n = (int64)C_LOG_FD_WRITE(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return; // Nowhere left to report this
+        data += n;
+        size -= (size_t)n;
+    }
+}
+
+static void c_log_ring_read(const c_Log_thread *t, uint64 pos, void *out, size_t size) {
+    size_t start = (size_t)(pos & (C_LOG_RING_SIZE - 1));
+    size_t first = C_MIN(size, C_LOG_RING_SIZE - start);
+    C_MEMCPY(out, t->ring + start, first);
+    C_MEMCPY((char *)out + first, t->ring, size - first);
+}
+
+static void c_log_ring_write(c_Log_thread *t, uint64 pos, const void *data, size_t size) {
+    size_t start = (size_t)(pos & (C_LOG_RING_SIZE - 1));
+    size_t first = C_MIN(size, C_LOG_RING_SIZE - start);
+    C_MEMCPY(t->ring + start, data, first);
+    C_MEMCPY(t->ring, (const char *)data + first, size - first);
+}
+
+static size_t c_log_drain(void);
+static void c_log_drain_stopped(void);
+
+static void c_log_thread_exit(void *arg) {
+    c_Log_thread *t = (c_Log_thread *)arg;
+    c_mutex_lock(&c_log_lock);
+    t->exited = true;
+    // Nobody else is going to drain it
+    if (!C_ATOMIC_LOAD(&c_log_async)) c_log_drain_stopped();
+    c_mutex_unlock(&c_log_lock);
+    c_log_this_thread = NULL;
+}
+
+#if defined(_WIN32)
+static void NTAPI c_log_fls_exit(void *arg) {
+    if (arg) c_log_thread_exit(arg);
+}
+#endif // defined(_WIN32)
+
+static void c_log_set_exit_value(c_Log_thread *t) {
+#if defined(_WIN32)
+    if (c_log_exit_key != FLS_OUT_OF_INDEXES) FlsSetValue(c_log_exit_key, t);
+#else
+    if (c_log_exit_key_created) pthread_setspecific(c_log_exit_key, t);
+#endif // defined(_WIN32)
+}
+
+static c_Log_thread *c_log_register_thread(void) {
+    c_Log_thread *t = C_MALLOC(sizeof(*t));
+    C_ASSERT(t != NULL, "Buy more RAM bruh");
+    t->head = t->tail = 0;
+    t->exited = false;
+    c_mutex_lock(&c_log_lock);
+    if (!c_log_exit_key_created) {
+#if defined(_WIN32)
+        c_log_exit_key = FlsAlloc(c_log_fls_exit);
+        c_log_exit_key_created = true;
+#else
+        c_log_exit_key_created = pthread_key_create(&c_log_exit_key, c_log_thread_exit) == 0;
+#endif // defined(_WIN32)
+    }
+    t->next = c_log_threads;
+    c_log_threads = t;
+    c_mutex_unlock(&c_log_lock);
+    c_log_set_exit_value(t);
+    c_log_this_thread = t;
+    return t;
+}
+
+// Is anything queued in any of the rings? c_log_lock must be held
+static bool c_log_pending(void) {
+    for (c_Log_thread *t = c_log_threads; t; t = t->next) {
+        if (C_ATOMIC_LOAD(&t->head) != t->tail) return true;
+    }
+    return false;
+}
+
+static void c_log_push(uint32 flags, const char *msg, size_t len) {
+    c_Log_thread *t = c_log_this_thread;
+    if (t == NULL) t = c_log_register_thread();
+
+    // Huge messages get cut so they always fit
+    if (len > C_LOG_RING_SIZE/2) len = C_LOG_RING_SIZE/2;
+    uint32 header = (uint32)len | flags;
+    size_t need = sizeof(header) + len;
+
+    uint64 head = t->head;
+    if (head + need - C_ATOMIC_LOAD(&t->tail) > C_LOG_RING_SIZE) {
+        // Full; wait for the writer rather than lose logs (the tail only moves under the lock)
+        c_mutex_lock(&c_log_lock);
+        while (head + need - t->tail > C_LOG_RING_SIZE) {
+            if (!C_ATOMIC_LOAD(&c_log_async)) {
+                c_log_drain_stopped();
+                continue;
+            }
+            c_log_space_waiters++;
+            c_cond_signal(&c_log_wake);
+            c_cond_wait(&c_log_space, &c_log_lock);
+            c_log_space_waiters--;
+        }
+        c_mutex_unlock(&c_log_lock);
+    }
+
+    c_log_ring_write(t, head, &header, sizeof(header));
+    c_log_ring_write(t, head + sizeof(header), msg, len);
+    C_ATOMIC_STORE(&t->head, head + need);
+
+    // NOTE: The fence pairs with the ones in c_log_writer_main() and c_log_async_stop(): either they see the new
+    //       head, or we see that the writer is asleep (or gone) and handle it here.
+    C_ATOMIC_FENCE();
+    if (!C_ATOMIC_LOAD(&c_log_async)) {
+        // Async logging was stopped after we decided to use it; Its final drain might have missed this
+        c_mutex_lock(&c_log_lock);
+        c_log_drain_stopped();
+        c_mutex_unlock(&c_log_lock);
+    } else if (C_ATOMIC_LOAD(&c_log_writer_idle)) {
+        c_mutex_lock(&c_log_lock);
+        c_cond_signal(&c_log_wake);
+        c_mutex_unlock(&c_log_lock);
+    }
+}
+
+void c_log_vwrite(c_Log_level level, const char *fmt, va_list args) {
+    bool to_stderr = level == C_LOG_ERROR;
+    if (!C_ATOMIC_LOAD(&c_log_async) || c_log_holding_lock) {
+        vfprintf(to_stderr ? stderr : stdout, fmt, args);
+        return;
+    }
+    uint32 flags = to_stderr ? C_LOG_RECORD_STDERR : 0;
+
+    char buff[1024];
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int n = vsnprintf(buff, sizeof(buff), fmt, args);
+    if (n < 0) {
+        va_end(args_copy);
+        return;
+    }
+    if ((size_t)n < sizeof(buff)) {
+        c_log_push(flags, buff, (size_t)n);
+    } else {
+        char *heap_buff = C_MALLOC((size_t)n + 1);
+        C_ASSERT(heap_buff != NULL, "Buy more RAM bruh");
+        vsnprintf(heap_buff, (size_t)n + 1, fmt, args_copy);
+        c_log_push(flags, heap_buff, (size_t)n);
+        C_FREE(heap_buff);
+    }
+    va_end(args_copy);
+}
+
+void c_log_write(c_Log_level level, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    c_log_vwrite(level, fmt, args);
+    va_end(args);
+}
+
+// Binary log records in the file: [uint8 tag][uint32 size][size bytes]
+enum {
+    C_BLOG_TAG_SITE = 1,  // [uint32 id][uint8 level][fmt]
+    C_BLOG_TAG_EVENT = 2, // [uint32 site id][args]
+};
+
+#define C_BLOG_MAGIC "CLOG\x01\0\0\0"
+
+static void c_blog_write_record_header(uint8 tag, uint32 size) {
+    char header[5];
+    header[0] = (char)tag;
+    C_MEMCPY(header + 1, &size, sizeof(size));
+    c_file_writer_write(&c_blog_writer, header, sizeof(header));
+}
+
+// c_log_lock must be held
+static void c_blog_append_record(const c_Log_thread *t, uint64 pos, size_t len) {
+    if (c_blog_writer.fd < 0 || c_blog_writer.buff == NULL) return; // closed in the meantime
+    char record[C_BLOG_MAX_RECORD_SIZE];
+    c_log_ring_read(t, pos, record, len);
+    c_blog_write_record_header(C_BLOG_TAG_EVENT, (uint32)len);
+    c_file_writer_write(&c_blog_writer, record, len);
+}
+
+// Writes out everything queued in all the rings (and frees the ones of exited threads); c_log_lock must be held.
+// Returns the bytes written.
+static size_t c_log_drain(void) {
+    for (c_Log_thread **it = &c_log_threads; *it;) {
+        c_Log_thread *t = *it;
+        uint64 head = C_ATOMIC_LOAD(&t->head);
+        uint64 tail = t->tail;
+        while (tail < head) {
+            uint32 header;
+            c_log_ring_read(t, tail, &header, sizeof(header));
+            size_t len = header & ~C_LOG_RECORD_FLAGS;
+            if (header & C_LOG_RECORD_BINARY) {
+                c_blog_append_record(t, tail + sizeof(header), len);
+            } else {
+                c_String_builder *sb = &c_log_batches[(header & C_LOG_RECORD_STDERR) ? 1 : 0];
+                c_sb_reserve(sb, len);
+                c_log_ring_read(t, tail + sizeof(header), sb->items + sb->count, len);
+                sb->count += len;
+            }
+            tail += sizeof(header) + len;
+        }
+        C_ATOMIC_STORE(&t->tail, tail);
+
+        // NOTE: An exited thread can't log anymore, so it's empty for good
+        if (t->exited) {
+            *it = t->next;
+            C_FREE(t);
+        } else {
+            it = &t->next;
+        }
+    }
+
+    size_t written = c_log_batches[0].count + c_log_batches[1].count;
+    c_log_write_fd(1, c_log_batches[0].items, c_log_batches[0].count);
+    c_log_write_fd(2, c_log_batches[1].items, c_log_batches[1].count);
+    c_log_batches[0].count = 0;
+    c_log_batches[1].count = 0;
+    if (c_log_space_waiters > 0) c_cond_broadcast(&c_log_space);
+    return written;
+}
+
+// Drains without the writer thread around, and gives the batch memory back; c_log_lock must be held
+static void c_log_drain_stopped(void) {
+    c_log_holding_lock = true;
+    c_log_drain();
+    c_log_holding_lock = false;
+    c_sb_free(&c_log_batches[0]);
+    c_sb_free(&c_log_batches[1]);
+    C_MEMSET(c_log_batches, 0, sizeof(c_log_batches));
+}
+
+static void *c_log_writer_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        c_mutex_lock(&c_log_lock);
+        if (C_ATOMIC_LOAD(&c_log_stop_requested)) {
+            c_mutex_unlock(&c_log_lock);
+            break;
+        }
+        c_log_holding_lock = true;
+        c_log_drain();
+        c_log_holding_lock = false;
+
+        // Sleep until a logger has something for us; See c_log_push() for the fence
+        C_ATOMIC_STORE(&c_log_writer_idle, (int64)1);
+        C_ATOMIC_FENCE();
+        if (!c_log_pending() && !C_ATOMIC_LOAD(&c_log_stop_requested)) c_cond_wait(&c_log_wake, &c_log_lock);
+        C_ATOMIC_STORE(&c_log_writer_idle, (int64)0);
+        c_mutex_unlock(&c_log_lock);
+    }
+    return NULL;
+}
+
+bool c_log_async_start(void) {
+    static bool registered = false;
+    if (C_ATOMIC_LOAD(&c_log_async)) return true;
+
+    // Whatever is in the stdio buffers has to come out before our logs
+    fflush(stdout);
+    fflush(stderr);
+
+    C_ATOMIC_STORE(&c_log_stop_requested, (int64)0);
+    if (!c_thread_create(&c_log_writer, c_log_writer_main, NULL)) return false;
+    C_ATOMIC_STORE(&c_log_async, (int64)1);
+
+    if (!registered) {
+        atexit(c_log_async_stop);
+        registered = true;
+    }
+    return true;
+}
+
+void c_log_async_stop(void) {
+    if (!C_ATOMIC_LOAD(&c_log_async)) return;
+    c_mutex_lock(&c_log_lock);
+    C_ATOMIC_STORE(&c_log_stop_requested, (int64)1);
+    c_cond_signal(&c_log_wake);
+    c_mutex_unlock(&c_log_lock);
+    c_thread_join(c_log_writer);
+    C_ATOMIC_STORE(&c_log_async, (int64)0);
+    // NOTE: Pairs with the fence in c_log_push(), whoever is still pushing either sees that we stopped or gets drained here
+    C_ATOMIC_FENCE();
+
+    // Messages that made it into a ring while we were stopping
+    c_mutex_lock(&c_log_lock);
+    c_log_drain_stopped();
+    // Our own ring is empty and we're not using it, other threads free theirs when they exit
+    c_Log_thread *self = c_log_this_thread;
+    if (self) {
+        for (c_Log_thread **it = &c_log_threads; *it; it = &(*it)->next) {
+            if (*it == self) {
+                *it = self->next;
+                break;
+            }
+        }
+        C_FREE(self);
+        c_log_this_thread = NULL;
+        c_log_set_exit_value(NULL);
+    }
+    c_mutex_unlock(&c_log_lock);
+}
+
+void c_log_flush(void) {
+    if (C_ATOMIC_LOAD(&c_log_async)) {
+        c_mutex_lock(&c_log_lock);
+        c_log_holding_lock = true;
+        c_log_drain();
+        c_log_holding_lock = false;
+        c_mutex_unlock(&c_log_lock);
+    }
+    fflush(stdout);
+    fflush(stderr);
+}
+
+void c_log_crash_flush(void) {
+    // NOTE: No waiting or allocating here; the crashing thread might be holding the lock
+    bool locked = c_mutex_trylock(&c_log_lock);
+    for (c_Log_thread *t = c_log_threads; t; t = t->next) {
+        uint64 head = C_ATOMIC_LOAD(&t->head);
+        uint64 tail = C_ATOMIC_LOAD(&t->tail);
+        while (tail < head) {
+            uint32 header;
+            c_log_ring_read(t, tail, &header, sizeof(header));
+            size_t len = header & ~C_LOG_RECORD_FLAGS;
+            int fd = (header & C_LOG_RECORD_STDERR) ? 2 : 1;
+            if (header & C_LOG_RECORD_BINARY) {
+                tail += sizeof(header) + len;
+                continue;
+            }
+            // The record can wrap around the end of the ring
+            size_t start = (size_t)((tail + sizeof(header)) & (C_LOG_RING_SIZE - 1));
+            size_t first = C_MIN(len, C_LOG_RING_SIZE - start);
+            c_log_write_fd(fd, t->ring + start, first);
+            c_log_write_fd(fd, t->ring, len - first);
+            tail += sizeof(header) + len;
+        }
+        C_ATOMIC_STORE(&t->tail, tail);
+    }
+    if (locked) c_mutex_unlock(&c_log_lock);
+}
+
+static void c_log_crash_handler(int sig) {
+    c_log_crash_flush();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+void c_log_install_crash_handler(void) {
+    signal(SIGSEGV, c_log_crash_handler);
+    signal(SIGABRT, c_log_crash_handler);
+    signal(SIGILL,  c_log_crash_handler);
+    signal(SIGFPE,  c_log_crash_handler);
+#if defined(SIGBUS)
+    signal(SIGBUS,  c_log_crash_handler);
+#endif // defined(SIGBUS)
+}
+
+// Binary logging
+
+enum {
+    C_BLOG_ARG_INT,
+    C_BLOG_ARG_LONG,
+    C_BLOG_ARG_LLONG,
+    C_BLOG_ARG_INTMAX,
+    C_BLOG_ARG_SIZE,
+    C_BLOG_ARG_PTRDIFF,
+    C_BLOG_ARG_DOUBLE,
+    C_BLOG_ARG_LDOUBLE,
+    C_BLOG_ARG_STR,
+    C_BLOG_ARG_PTR,
+};
+
+typedef struct {
+    const char *start;  // the '%'
+    const char *end;    // one past the conversion char
+    int stars;          // how many '*'s (each one takes an int argument before the value)
+    int arg;            // C_BLOG_ARG_*, -1 for "%%"
+    char conversion;
+} c_Blog_spec;
+
+// Parses the conversion spec starting at the '%' in `p`; false on ones we can't handle.
+static bool c_blog_parse_spec(const char *p, c_Blog_spec *spec) {
+    spec->start = p++;
+    spec->stars = 0;
+    spec->arg = -1;
+    if (*p == '%') {
+        spec->conversion = '%';
+        spec->end = p + 1;
+        return true;
+    }
+
+    while (*p && strchr("-+ #0'", *p)) p++;
+    if (*p == '*') { spec->stars++; p++; }
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') { spec->stars++; p++; }
+        while (*p >= '0' && *p <= '9') p++;
+    }
+
+    int length = C_BLOG_ARG_INT;
+    bool long_double = false;
+    switch (*p) {
+        case 'h': p++; if (*p == 'h') p++; break;
+        case 'l': p++; length = C_BLOG_ARG_LONG; if (*p == 'l') { p++; length = C_BLOG_ARG_LLONG; } break;
+        case 'j': p++; length = C_BLOG_ARG_INTMAX; break;
+        case 'z': p++; length = C_BLOG_ARG_SIZE; break;
+        case 't': p++; length = C_BLOG_ARG_PTRDIFF; break;
+        case 'L': p++; long_double = true; break;
+        default: break;
+    }
+
+    spec->conversion = *p;
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            spec->arg = length;
+            break;
+        case 'c':
+            spec->arg = C_BLOG_ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->arg = long_double ? C_BLOG_ARG_LDOUBLE : C_BLOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->arg = C_BLOG_ARG_STR;
+            break;
+        case 'p':
+            spec->arg = C_BLOG_ARG_PTR;
+            break;
+        default:
+            return false;
+    }
+    spec->end = p + 1;
+    return true;
+}
+
+// c_log_lock must be held
+static void c_blog_describe_site(c_Log_site *site) {
+    if (site->id == 0) {
+        site->arg_count = 0;
+        for (const char *p = site->fmt; *p; ++p) {
+            if (*p != '%') continue;
+            c_Blog_spec spec;
+            C_ASSERT(c_blog_parse_spec(p, &spec), "Unsupported conversion in a binary log format");
+            for (int i = 0; i < spec.stars; ++i) {
+                C_ASSERT(site->arg_count < C_BLOG_MAX_ARGS, "Too many arguments for a binary log");
+                site->args[site->arg_count++] = C_BLOG_ARG_INT;
+            }
+            if (spec.arg >= 0) {
+                C_ASSERT(site->arg_count < C_BLOG_MAX_ARGS, "Too many arguments for a binary log");
+                site->args[site->arg_count++] = (uint8)spec.arg;
+            }
+            p = spec.end - 1;
+        }
+        site->id = c_blog_next_site_id++;
+    }
+
+    uint32 id = (uint32)site->id;
+    uint8 level = (uint8)site->level;
+    size_t fmt_len = strlen(site->fmt);
+    c_blog_write_record_header(C_BLOG_TAG_SITE, (uint32)(sizeof(id) + sizeof(level) + fmt_len));
+    c_file_writer_write(&c_blog_writer, &id, sizeof(id));
+    c_file_writer_write(&c_blog_writer, &level, sizeof(level));
+    c_file_writer_write(&c_blog_writer, site->fmt, fmt_len);
+    C_ATOMIC_STORE(&site->file_id, c_blog_file_id);
+}
+
+void c_blog_write(c_Log_site *site, ...) {
+    va_list args;
+    va_start(args, site);
+    if (c_log_holding_lock) {
+        c_log_vwrite(site->level, site->fmt, args);
+        va_end(args);
+        return;
+    }
+
+    if (C_ATOMIC_LOAD(&site->file_id) != C_ATOMIC_LOAD(&c_blog_file_id)) {
+        c_mutex_lock(&c_log_lock);
+        c_log_holding_lock = true;
+        if (site->file_id != c_blog_file_id && c_blog_file_id != 0) c_blog_describe_site(site);
+        c_log_holding_lock = false;
+        c_mutex_unlock(&c_log_lock);
+    }
+    if (C_ATOMIC_LOAD(&site->file_id) != C_ATOMIC_LOAD(&c_blog_file_id)) {
+        // The binary log got closed in the meantime
+        c_log_vwrite(site->level, site->fmt, args);
+        va_end(args);
+        return;
+    }
+
+    char record[C_BLOG_MAX_RECORD_SIZE];
+    uint32 id = (uint32)site->id;
+    C_MEMCPY(record, &id, sizeof(id));
+    size_t n = sizeof(id);
+
+    for (uint8 i = 0; i < site->arg_count; ++i) {
+        uint64 v = 0;
+        switch (site->args[i]) {
+            case C_BLOG_ARG_INT:     { int64 x = va_arg(args, int);       C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_LONG:    { int64 x = va_arg(args, long);      C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_LLONG:   { int64 x = va_arg(args, long long); C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_INTMAX:  { int64 x = (int64)va_arg(args, intmax_t);  C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_SIZE:    { int64 x = (int64)va_arg(args, size_t);    C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_PTRDIFF: { int64 x = (int64)va_arg(args, ptrdiff_t); C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_DOUBLE:  { float64 x = va_arg(args, double); C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_LDOUBLE: { float64 x = (float64)va_arg(args, long double); C_MEMCPY(&v, &x, 8); } break;
+            case C_BLOG_ARG_PTR:     { v = (uint64)(uintptr_t)va_arg(args, void *); } break;
+            case C_BLOG_ARG_STR: {
+                const char *s = va_arg(args, const char *);
+                uint32 len = s ? (uint32)strlen(s) : UINT32_MAX;
+                size_t space = sizeof(record) - n - sizeof(len) - 8*(size_t)(site->arg_count - i - 1);
+                if (s && len > space) len = (uint32)space;
+                C_MEMCPY(record + n, &len, sizeof(len));
+                n += sizeof(len);
+                if (s) {
+                    C_MEMCPY(record + n, s, len);
+                    n += len;
+                }
+                continue;
+            }
+        }
+        C_MEMCPY(record + n, &v, sizeof(v));
+        n += sizeof(v);
+    }
+    va_end(args);
+
+    c_log_push(C_LOG_RECORD_BINARY, record, n);
+}
+
+bool c_blog_open(cstr path) {
+    c_blog_close();
+    if (!C_ATOMIC_LOAD(&c_log_async)) {
+        if (!c_log_async_start()) return false;
+        c_blog_started_async = true;
+    }
+
+    c_mutex_lock(&c_log_lock);
+    c_log_holding_lock = true;
+    bool ok = c_file_writer_open(&c_blog_writer, path, 0, 0);
+    if (ok) {
+        c_file_writer_write(&c_blog_writer, C_BLOG_MAGIC, 8);
+        C_ATOMIC_STORE(&c_blog_file_id, ++c_blog_last_file_id);
+    }
+    c_log_holding_lock = false;
+    c_mutex_unlock(&c_log_lock);
+    return ok;
+}
+
+void c_blog_close(void) {
+    if (C_ATOMIC_LOAD(&c_blog_file_id) == 0) return;
+    C_ATOMIC_STORE(&c_blog_file_id, (int64)0);
+    c_log_flush();
+
+    c_mutex_lock(&c_log_lock);
+    c_log_holding_lock = true;
+    c_file_writer_close(&c_blog_writer);
+    c_log_holding_lock = false;
+    c_mutex_unlock(&c_log_lock);
+
+    if (c_blog_started_async) {
+        c_log_async_stop();
+        c_blog_started_async = false;
+    }
+}
+
+typedef struct {
+    uint32 id; // 0 for an empty slot, ids start at 1
+    const char *fmt;
+    size_t fmt_len;
+} c_Blog_decoded_site;
+
+// Ids are handed out per process, so the ones in a log can be far apart; Open addressing by id.
+typedef struct {
+    c_Blog_decoded_site *slots;
+    size_t count;
+    size_t size; // a power of 2
+} c_Blog_decoded_sites;
+
+// Gives back the slot of `id`, or the empty slot it would go in
+static c_Blog_decoded_site *c_blog_find_site(const c_Blog_decoded_sites *sites, uint32 id) {
+    size_t slot = (size_t)(id * 2654435761u) & (sites->size - 1);
+    while (sites->slots[slot].id != 0 && sites->slots[slot].id != id) slot = (slot + 1) & (sites->size - 1);
+    return &sites->slots[slot];
+}
+
+static void c_blog_add_site(c_Blog_decoded_sites *sites, uint32 id, const char *fmt, size_t fmt_len) {
+    // Keep it atmost half full
+    if ((sites->count + 1)*2 > sites->size) {
+        c_Blog_decoded_sites grown = { .size = sites->size ? sites->size*2 : 64 };
+        grown.slots = C_CALLOC(grown.size, sizeof(*grown.slots));
+        C_ASSERT(grown.slots != NULL, "Buy more RAM bruh");
+        for (size_t i = 0; i < sites->size; ++i) {
+            if (sites->slots[i].id != 0) *c_blog_find_site(&grown, sites->slots[i].id) = sites->slots[i];
+        }
+        grown.count = sites->count;
+        C_FREE(sites->slots);
+        *sites = grown;
+    }
+    c_Blog_decoded_site *s = c_blog_find_site(sites, id);
+    if (s->id == 0) sites->count++;
+    s->id = id;
+    s->fmt = fmt;
+    s->fmt_len = fmt_len;
+}
+
+// Renders one event with the site's format, a spec at a time
+static bool c_blog_render(c_String_builder *out, const char *fmt, size_t fmt_len, c_String_view args) {
+    // The format in the file isn't NUL-terminated
+    char *f = C_MALLOC(fmt_len + 1);
+    C_ASSERT(f != NULL, "Buy more RAM bruh");
+    C_MEMCPY(f, fmt, fmt_len);
+    f[fmt_len] = '\0';
+
+    bool ok = true;
+    const char *p = f;
+    while (*p) {
+        const char *pct = strchr(p, '%');
+        if (pct == NULL) {
+            c_sb_append(out, (char *)p);
+            break;
+        }
+        c_sb_reserve(out, (size_t)(pct - p));
+        C_MEMCPY(out->items + out->count, p, (size_t)(pct - p));
+        out->count += (size_t)(pct - p);
+
+        c_Blog_spec spec;
+        if (!c_blog_parse_spec(pct, &spec)) {
+            ok = false;
+            break;
+        }
+        p = spec.end;
+        if (spec.arg < 0) {
+            c_sb_append_char(out, '%');
+            continue;
+        }
+
+        // Put the values of the '*'s right in the spec
+        char spec_buff[64];
+        size_t sn = 0;
+        for (const char *s = spec.start; s < spec.end && sn + 16 < sizeof(spec_buff); ++s) {
+            if (*s != '*') {
+                spec_buff[sn++] = *s;
+                continue;
+            }
+            int64 star = 0;
+            if (args.count < 8) { ok = false; break; }
+            C_MEMCPY(&star, args.data, 8);
+            c_sv_lremove(&args, 8);
+            sn += (size_t)snprintf(spec_buff + sn, sizeof(spec_buff) - sn, "%d", (int)star);
+        }
+        if (!ok) break;
+        spec_buff[sn] = '\0';
+
+        if (spec.arg == C_BLOG_ARG_STR) {
+            uint32 len;
+            if (args.count < sizeof(len)) { ok = false; break; }
+            C_MEMCPY(&len, args.data, sizeof(len));
+            c_sv_lremove(&args, sizeof(len));
+            if (len != UINT32_MAX && len > args.count) { ok = false; break; }
+            c_String_view s = len == UINT32_MAX ? c_sv_from_cstr("(null)") : (c_String_view){ args.data, len };
+            if (len != UINT32_MAX) c_sv_lremove(&args, len);
+            // The string isn't NUL-terminated, so it always goes through "%.*s" with the precision folded in
+            spec_buff[--sn] = '\0'; // 's'
+            char *dot = strchr(spec_buff, '.');
+            if (dot) {
+                size_t precision = (size_t)atoi(dot + 1);
+                if (precision < s.count) s.count = precision;
+                *dot = '\0';
+            }
+            char s_spec[sizeof(spec_buff) + 4];
+            snprintf(s_spec, sizeof(s_spec), "%s.*s", spec_buff);
+            c_sb_appendf(out, s_spec, (int)s.count, s.data);
+            continue;
+        }
+
+        uint64 v;
+        if (args.count < 8) { ok = false; break; }
+        C_MEMCPY(&v, args.data, 8);
+        c_sv_lremove(&args, 8);
+        bool is_unsigned = strchr("uoxX", spec.conversion) != NULL;
+        int64 i;
+        float64 d;
+        C_MEMCPY(&i, &v, 8);
+        C_MEMCPY(&d, &v, 8);
+
+        switch (spec.arg) {
+            case C_BLOG_ARG_INT:
+                if (is_unsigned) c_sb_appendf(out, spec_buff, (unsigned)i);
+                else             c_sb_appendf(out, spec_buff, (int)i);
+                break;
+            case C_BLOG_ARG_LONG:
+                if (is_unsigned) c_sb_appendf(out, spec_buff, (unsigned long)i);
+                else             c_sb_appendf(out, spec_buff, (long)i);
+                break;
+            case C_BLOG_ARG_LLONG:
+                if (is_unsigned) c_sb_appendf(out, spec_buff, (unsigned long long)i);
+                else             c_sb_appendf(out, spec_buff, (long long)i);
+                break;
+            case C_BLOG_ARG_INTMAX:
+                if (is_unsigned) c_sb_appendf(out, spec_buff, (uintmax_t)i);
+                else             c_sb_appendf(out, spec_buff, (intmax_t)i);
+                break;
+            case C_BLOG_ARG_SIZE:
+                c_sb_appendf(out, spec_buff, (size_t)i);
+                break;
+            case C_BLOG_ARG_PTRDIFF:
+                c_sb_appendf(out, spec_buff, (ptrdiff_t)i);
+                break;
+            case C_BLOG_ARG_DOUBLE:
+                c_sb_appendf(out, spec_buff, d);
+                break;
+            case C_BLOG_ARG_LDOUBLE:
+                c_sb_appendf(out, spec_buff, (long double)d);
+                break;
+            case C_BLOG_ARG_PTR:
+                c_sb_appendf(out, spec_buff, (void *)(uintptr_t)v);
+                break;
+        }
+    }
+
+    C_FREE(f);
+    return ok;
+}
+
+bool c_blog_decode(c_String_view data, c_String_builder *out) {
+    if (data.count < 8 || memcmp(data.data, C_BLOG_MAGIC, 8) != 0) {
+        c_log_error("Not a binary log");
+        return false;
+    }
+    c_sv_lremove(&data, 8);
+
+    c_Blog_decoded_sites sites = {0};
+    bool ok = true;
+
+    while (data.count > 0) {
+        uint32 size;
+        if (data.count < 5) { ok = false; break; }
+        uint8 tag = (uint8)data.data[0];
+        C_MEMCPY(&size, data.data + 1, sizeof(size));
+        c_sv_lremove(&data, 5);
+        if (size > data.count || size < sizeof(uint32)) { ok = false; break; }
+        c_String_view payload = { data.data, size };
+        c_sv_lremove(&data, size);
+
+        uint32 id;
+        C_MEMCPY(&id, payload.data, sizeof(id));
+        c_sv_lremove(&payload, sizeof(id));
+
+        if (id == 0) { ok = false; break; }
+        if (tag == C_BLOG_TAG_SITE) {
+            if (payload.count < 1) { ok = false; break; }
+            c_blog_add_site(&sites, id, payload.data + 1, payload.count - 1); // skip the level
+        } else if (tag == C_BLOG_TAG_EVENT) {
+            c_Blog_decoded_site *site = sites.size ? c_blog_find_site(&sites, id) : NULL;
+            if (site == NULL || site->id != id) { ok = false; break; }
+            if (!c_blog_render(out, site->fmt, site->fmt_len, payload)) { ok = false; break; }
+        } else {
+            ok = false;
+            break;
+        }
     }
+
+    C_FREE(sites.slots);
+    if (!ok) c_log_error("Corrupted binary log");
+    return ok;
 }
 
-void c_sv_rtrim(c_String_view* sv){
-    while (sv->count > 0 && isspace(*(sv->data+sv->count-1))){
-        sv->count--;
-    }
+//
+// Benchmarks
+//
+
+#if !defined(__GNUC__) && !defined(__clang__)
+volatile uint64 c_bench_sink = 0;
+#endif // !defined(__GNUC__) && !defined(__clang__)
+
+#define C_BENCH_MAX_ITERS (1ull << 40)
+
+static uint64 c_bench_sample(c_Bench_proc fn, void *ctx, uint64 iters) {
+    uint64 start = c_time_ticks();
+    fn(iters, ctx);
+    return c_time_ticks() - start;
 }
 
-void c_sv_trim(c_String_view* sv){
-    c_sv_ltrim(sv);
-    c_sv_rtrim(sv);
+static int c_bench_compare_ticks(const void *a, const void *b) {
+    uint64 x = *(const uint64 *)a, y = *(const uint64 *)b;
+    return (x > y) - (x < y);
 }
 
-char* c_sv_to_cstr(c_String_view sv){
-    char* res = (char*)malloc(sizeof(char)*(sv.count + 1));
-    if (res == NULL) {
-        C_ASSERT(false, "Buy more RAM bruh");
+c_Bench_result c_bench_run(const char *name, c_Bench_proc fn, void *ctx, const c_Bench_options *opts) {
+    c_Bench_options o = opts ? *opts : (c_Bench_options){0};
+    if (o.sample_ns == 0) o.sample_ns = C_BENCH_SAMPLE_NS;
+    if (o.warmup == 0) o.warmup = C_BENCH_WARMUP;
+    if (o.warmup < 0) o.warmup = 0;
+    if (o.samples <= 0) o.samples = C_BENCH_SAMPLES;
+
+    // NOTE: Only trust runs of at least an eighth of a sample, shorter ones are mostly timer overhead
+    uint64 iters = 1;
+    for (;;) {
+        uint64 ns = c_ticks_to_ns(c_bench_sample(fn, ctx, iters));
+        if (ns >= o.sample_ns / 8 || iters >= C_BENCH_MAX_ITERS) {
+            float64 scaled = (float64)iters * (float64)o.sample_ns / (float64)(ns == 0 ? 1 : ns);
+            iters = scaled < 1.0 ? 1 : scaled > (float64)C_BENCH_MAX_ITERS ? C_BENCH_MAX_ITERS : (uint64)scaled;
+            break;
+        }
+        iters *= 2;
     }
-    C_MEMCPY(res, sv.data, sv.count);
-    res[sv.count] = '\0';
-    return res;
+
+    for (int i = 0; i < o.warmup; ++i) c_bench_sample(fn, ctx, iters);
+
+    uint64 *ticks = C_MALLOC(sizeof(*ticks) * (size_t)o.samples);
+    C_ASSERT(ticks != NULL, "Buy more RAM bruh");
+    for (int i = 0; i < o.samples; ++i) ticks[i] = c_bench_sample(fn, ctx, iters);
+    qsort(ticks, (size_t)o.samples, sizeof(*ticks), c_bench_compare_ticks);
+
+    uint64 median = ticks[o.samples / 2];
+    if (o.samples % 2 == 0) median = (ticks[o.samples / 2 - 1] + median) / 2;
+    int p99 = (int)ceil(0.99 * (float64)o.samples) - 1;
+
+    c_Bench_result r = {
+        .name = name,
+        .iters = iters,
+        .samples = o.samples,
+        .min_ns = (float64)c_ticks_to_ns(ticks[0]) / (float64)iters,
+        .median_ns = (float64)c_ticks_to_ns(median) / (float64)iters,
+        .p99_ns = (float64)c_ticks_to_ns(ticks[p99]) / (float64)iters,
+        .ticks = (float64)median / (float64)iters,
+    };
+    if (o.bytes_per_iter > 0 && r.median_ns > 0) r.bytes_per_sec = (float64)o.bytes_per_iter * 1e9 / r.median_ns;
+
+    C_FREE(ticks);
+    return r;
 }
 
-int64 c_sv_to_int(c_String_view sv, int *count_out, int base) {
-    char *str = c_sv_to_cstr(sv);
+void c_bench_print_header(FILE *stream) {
+    fprintf(stream, "# name\titers\tsamples\tmin_ns\tmedian_ns\tp99_ns\tticks\tMB/s\n");
+}
 
-    char *endptr = NULL;
+void c_bench_print(FILE *stream, const c_Bench_result *r) {
+    fprintf(stream, "%s\t%llu\t%d\t%.3f\t%.3f\t%.3f\t%.2f\t%.2f\n", r->name, (unsigned long long)r->iters,
+            r->samples, r->min_ns, r->median_ns, r->p99_ns, r->ticks, r->bytes_per_sec / 1e6);
+}
 
-    int64 res = strtol(str, &endptr, base);
+//
+// Allocation tracking
+//
 
-    if (endptr == str) {
-        *count_out = -1;
-        return res;
+// NOTE: Everything in here uses the plain libc allocator, it's what the C_* macros end up calling.
+#define C_TRACK_MAX_SITES 4096 // sites after that are all counted under one "(other)" site
+
+typedef struct {
+    void *ptr; // NULL for empty slots
+    size_t size;
+    uint32 site;
+} c_Track_entry;
+
+static struct {
+    c_Mutex lock;
+    c_Alloc_site sites[C_TRACK_MAX_SITES + 1]; // open addressing on file/line, `file` NULL for empty slots
+    size_t sites_count;
+    c_Track_entry *entries; // live allocations, open addressing on the pointer
+    size_t entries_count;
+    size_t entries_capacity; // power of 2
+    bool atexit_registered;
+} c_track = { .lock = C_MUTEX_INIT };
+
+static size_t c_track_ptr_hash(void *ptr) {
+    return (size_t)(((uint64)(uintptr_t)ptr >> 4) * 0x9E3779B97F4A7C15ull >> 17);
+}
+
+static uint32 c_track_site(const char *file, int line) {
+    uint32 h = 2166136261u;
+    for (const char *c = file; *c; ++c) h = (h ^ (uint8)*c) * 16777619u;
+    h ^= (uint32)line * 0x9E3779B1u;
+
+    for (uint32 i = 0; i < C_TRACK_MAX_SITES; ++i) {
+        uint32 idx = (h + i) % C_TRACK_MAX_SITES;
+        c_Alloc_site *s = &c_track.sites[idx];
+        if (s->file == NULL) {
+            // NOTE: Keeping the table at most 3/4 full so misses stay short
+            if (c_track.sites_count >= C_TRACK_MAX_SITES / 4 * 3) break;
+            s->file = file;
+            s->line = line;
+            c_track.sites_count++;
+            return idx;
+        }
+        // NOTE: __FILE__ of the same header can be a different string in every translation unit
+        if (s->line == line && (s->file == file || strcmp(s->file, file) == 0)) return idx;
     }
 
-    *count_out = (int)(endptr - str);
+    c_Alloc_site *other = &c_track.sites[C_TRACK_MAX_SITES];
+    other->file = "(other)";
+    return C_TRACK_MAX_SITES;
+}
 
-    C_FREE(str);
-    return res;
+static void c_track_grow(void) {
+    size_t old_capacity = c_track.entries_capacity;
+    c_Track_entry *old = c_track.entries;
+
+    c_track.entries_capacity = old_capacity == 0 ? 1024 : old_capacity * 2;
+    c_track.entries = calloc(c_track.entries_capacity, sizeof(*c_track.entries));
+    C_ASSERT(c_track.entries != NULL, "Buy more RAM bruh");
+
+    size_t mask = c_track.entries_capacity - 1;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old[i].ptr == NULL) continue;
+        size_t j = c_track_ptr_hash(old[i].ptr) & mask;
+        while (c_track.entries[j].ptr != NULL) j = (j + 1) & mask;
+        c_track.entries[j] = old[i];
+    }
+    free(old);
 }
 
-uint64 c_sv_to_uint(c_String_view sv, int *count, int base) {
-    char* str = c_sv_to_cstr(sv);
+static void c_track_at_exit(void) {
+    c_alloc_print_leaks(stderr);
+}
 
-    char *endptr = NULL;
-    uint64 res = strtoul(str, &endptr, base);
+static void c_track_record(void *ptr, size_t size, const char *file, int line) {
+    c_mutex_lock(&c_track.lock);
+    if (!c_track.atexit_registered) {
+        atexit(c_track_at_exit);
+        c_track.atexit_registered = true;
+    }
 
-    if (endptr == str) {
-        *count = -1;
-        return res;
+    uint32 idx = c_track_site(file, line);
+    c_Alloc_site *s = &c_track.sites[idx];
+    s->live_bytes += size;
+    s->live_count++;
+    s->total_count++;
+    s->total_bytes += size;
+    if (s->live_bytes > s->peak_bytes) s->peak_bytes = s->live_bytes;
+
+    if ((c_track.entries_count + 1) * 2 > c_track.entries_capacity) c_track_grow();
+    size_t mask = c_track.entries_capacity - 1;
+    size_t i = c_track_ptr_hash(ptr) & mask;
+    while (c_track.entries[i].ptr != NULL && c_track.entries[i].ptr != ptr) i = (i + 1) & mask;
+    if (c_track.entries[i].ptr == NULL) c_track.entries_count++;
+    c_track.entries[i] = (c_Track_entry){ ptr, size, idx };
+    c_mutex_unlock(&c_track.lock);
+}
+
+// Forgets `ptr` before it's freed (so nobody else can get the same address in the meantime);
+// Gives back false for pointers that weren't tracked.
+static bool c_track_forget(void *ptr, c_Track_entry *out) {
+    bool found = false;
+    c_mutex_lock(&c_track.lock);
+    size_t mask = c_track.entries_capacity - 1;
+    size_t i = c_track.entries_capacity ? c_track_ptr_hash(ptr) & mask : 0;
+    while (c_track.entries_capacity && c_track.entries[i].ptr != NULL) {
+        if (c_track.entries[i].ptr == ptr) {
+            found = true;
+            break;
+        }
+        i = (i + 1) & mask;
     }
 
-    *count = (int)(endptr - str);
+    if (found) {
+        *out = c_track.entries[i];
+        c_Alloc_site *s = &c_track.sites[out->site];
+        s->live_bytes -= out->size;
+        s->live_count--;
+        c_track.entries_count--;
+
+        // Backward shift, so lookups never have to skip over deleted slots
+        for (size_t j = (i + 1) & mask; c_track.entries[j].ptr != NULL; j = (j + 1) & mask) {
+            size_t home = c_track_ptr_hash(c_track.entries[j].ptr) & mask;
+            bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (stays) continue;
+            c_track.entries[i] = c_track.entries[j];
+            i = j;
+        }
+        c_track.entries[i].ptr = NULL;
+    }
+    c_mutex_unlock(&c_track.lock);
+    return found;
+}
 
-    C_FREE(str);
+void *c_track_malloc(size_t size, const char *file, int line) {
+    void *ptr = malloc(size);
+    if (ptr) c_track_record(ptr, size, file, line);
+    return ptr;
+}
+
+void *c_track_calloc(size_t n, size_t size, const char *file, int line) {
+    void *ptr = calloc(n, size);
+    if (ptr) c_track_record(ptr, n * size, file, line);
+    return ptr;
+}
+
+void *c_track_realloc(void *ptr, size_t size, const char *file, int line) {
+    if (ptr == NULL) return c_track_malloc(size, file, line);
+
+    c_Track_entry old;
+    bool tracked = c_track_forget(ptr, &old);
+    void *res = realloc(ptr, size);
+    if (res) {
+        c_track_record(res, size, file, line);
+    } else if (tracked && size != 0) {
+        // Still there, it just didn't grow
+        c_Alloc_site *s = &c_track.sites[old.site];
+        c_track_record(ptr, old.size, s->file, s->line);
+    }
     return res;
 }
 
-float64 c_sv_to_float(c_String_view sv, int *count) {
-    char* str = c_sv_to_cstr(sv);
+void c_track_free(void *ptr) {
+    if (ptr == NULL) return;
+    c_Track_entry old;
+    c_track_forget(ptr, &old);
+    free(ptr);
+}
 
-    char *endptr = NULL;
-    float64 res = strtod(str, &endptr);
+static int c_alloc_site_compare(const void *a, const void *b) {
+    const c_Alloc_site *x = a, *y = b;
+    if (x->peak_bytes != y->peak_bytes) return x->peak_bytes < y->peak_bytes ? 1 : -1;
+    int cmp = strcmp(x->file, y->file);
+    return cmp != 0 ? cmp : x->line - y->line;
+}
 
-    if (endptr == str) {
-        *count = -1;
-        return res;
+void c_alloc_summary(c_Alloc_sites *sites) {
+    // NOTE: Copied out first, appending to `sites` can allocate through the tracker
+    c_Alloc_site *copy = malloc(sizeof(c_track.sites));
+    C_ASSERT(copy != NULL, "Buy more RAM bruh");
+    c_mutex_lock(&c_track.lock);
+    size_t n = 0;
+    for (size_t i = 0; i <= C_TRACK_MAX_SITES; ++i) {
+        if (c_track.sites[i].file != NULL) copy[n++] = c_track.sites[i];
     }
+    c_mutex_unlock(&c_track.lock);
 
-    *count = (int)(endptr - str);
-
-    C_FREE(str);
-    return res;
+    size_t start = sites->count;
+    for (size_t i = 0; i < n; ++i) c_darr_append(*sites, copy[i]);
+    free(copy);
+    if (n > 0) qsort(sites->items + start, n, sizeof(*sites->items), c_alloc_site_compare);
 }
 
-bool c_sv_contains_char(c_String_view sv, char ch){
-    for (size_t i = 0; i < sv.count; ++i){
-        if (sv.data[i] == ch) return true;
+void c_alloc_print_report(FILE *stream) {
+    c_Alloc_sites sites = {0};
+    c_alloc_summary(&sites);
+
+    uint64 live = 0, count = 0;
+    for (size_t i = 0; i < sites.count; ++i) {
+        live += sites.items[i].live_bytes;
+        count += sites.items[i].total_count;
     }
-    return false;
+    fprintf(stream, "%llu allocations, %llu bytes live\n", (unsigned long long)count, (unsigned long long)live);
+
+    fprintf(stream, "%-40s %12s %12s %10s %10s %14s\n", "site", "live (B)", "peak (B)", "live", "allocs", "total (B)");
+    for (size_t i = 0; i < sites.count; ++i) {
+        c_Alloc_site s = sites.items[i];
+        char where[512];
+        snprintf(where, sizeof(where), "%s:%d", s.file, s.line);
+        fprintf(stream, "%-40s %12llu %12llu %10llu %10llu %14llu\n", where, (unsigned long long)s.live_bytes,
+                (unsigned long long)s.peak_bytes, (unsigned long long)s.live_count,
+                (unsigned long long)s.total_count, (unsigned long long)s.total_bytes);
+    }
+    c_darr_free(sites);
 }
 
-bool c_sv_is_hex_numbers(c_String_view sv) {
-    char hex[] = {
-        '0', '1', '2', '3', '4', '5', '6', '7',
-        '8', '9', '0', 'a', 'b', 'c', 'd', 'e', 'f',
-        'A', 'B', 'C', 'D', 'E', 'F'
-    };
-    bool found = false;
-    for (size_t i = 0; i < sv.count; ++i) {
-        char c = sv.data[i];
-        for (size_t j = 0; j < C_ARRAY_LEN(hex); ++j) {
-            if (hex[j] == c) {
-	found = true;
-            }
+uint64 c_alloc_print_leaks(FILE *stream) {
+    c_Alloc_sites sites = {0};
+    c_alloc_summary(&sites);
+
+    uint64 leaked = 0, bytes = 0;
+    for (size_t i = 0; i < sites.count; ++i) {
+        leaked += sites.items[i].live_count;
+        bytes += sites.items[i].live_bytes;
+    }
+    if (leaked > 0) {
+        fprintf(stream, "Leaked %llu bytes in %llu allocations:\n", (unsigned long long)bytes, (unsigned long long)leaked);
+        for (size_t i = 0; i < sites.count; ++i) {
+            c_Alloc_site s = sites.items[i];
+            if (s.live_count == 0) continue;
+            fprintf(stream, "    %s:%d: %llu bytes in %llu allocations\n", s.file, s.line,
+                    (unsigned long long)s.live_bytes, (unsigned long long)s.live_count);
         }
     }
+    c_darr_free(sites);
+    return leaked;
+}
 
-    return found;
+//
+// Arena snapshots
+//
+
+bool c_arena_save(const c_Arena *a, const void *root, cstr path) {
+    C_ASSERT(a->buff, "Bro pass an initialized arena!");
+    size_t size = (size_t)((uint8 *)a->ptr - (uint8 *)a->buff);
+    C_ASSERT(root == NULL || ((uint8 *)root >= (uint8 *)a->buff && (uint8 *)root < (uint8 *)a->ptr),
+             "The root must be in the arena");
+
+    uint8 header_bytes[C_ARENA_SNAPSHOT_HEADER_SIZE] = {0};
+    c_Arena_snapshot_header header = {
+        .version = C_ARENA_SNAPSHOT_VERSION,
+        .header_size = C_ARENA_SNAPSHOT_HEADER_SIZE,
+        .size = size,
+        .root = root ? (uint64)((uint8 *)root - (uint8 *)a->buff) : UINT64_MAX,
+        .checksum = c_hash(a->buff, size, 0),
+    };
+    C_MEMCPY(header.magic, C_ARENA_SNAPSHOT_MAGIC, sizeof(header.magic));
+    C_MEMCPY(header_bytes, &header, sizeof(header));
+
+    c_File_writer w;
+    if (!c_file_writer_open(&w, path, C_WRITE_ATOMIC, 0)) return false;
+    c_file_writer_write(&w, header_bytes, sizeof(header_bytes));
+    c_file_writer_write(&w, a->buff, size);
+    return c_file_writer_close(&w);
 }
 
-bool c_sv_equals(c_String_view sv1, c_String_view sv2) {
-    if (sv1.count != sv2.count) return false;
-    for (size_t i = 0; i < sv1.count; ++i) {
-        if (sv1.data[i] != sv2.data[i]) {
-            return false;
-        }
+bool c_arena_snapshot_load(c_Arena_snapshot *s, cstr path, bool verify) {
+    C_MEMSET(s, 0, sizeof(*s));
+
+    c_String_view file = c_map_file(path, verify ? C_MAP_SEQUENTIAL : C_MAP_RANDOM);
+    if (file.data == NULL) return false;
+
+    cstr why = NULL;
+    c_Arena_snapshot_header h = {0};
+    if (file.count < C_ARENA_SNAPSHOT_HEADER_SIZE) {
+        why = "not an arena snapshot (too small)";
+    } else {
+        C_MEMCPY(&h, file.data, sizeof(h));
+        if (memcmp(h.magic, C_ARENA_SNAPSHOT_MAGIC, sizeof(h.magic)) != 0) why = "not an arena snapshot";
+        else if (h.version != C_ARENA_SNAPSHOT_VERSION) why = "unsupported version";
+        else if (h.header_size != C_ARENA_SNAPSHOT_HEADER_SIZE) why = "unsupported header size";
+        else if (h.size != file.count - C_ARENA_SNAPSHOT_HEADER_SIZE) why = "the size doesn't match the file (truncated?)";
+        else if (h.root != UINT64_MAX && h.root >= h.size) why = "the root is out of bounds";
+        else if (verify && c_hash(file.data + C_ARENA_SNAPSHOT_HEADER_SIZE, (size_t)h.size, 0) != h.checksum) why = "checksum mismatch";
+    }
+    if (why) {
+        c_log_error("'%s': %s", path, why);
+        c_unmap_file(file);
+        return false;
     }
 
+    s->file = file;
+    s->data = file.data + C_ARENA_SNAPSHOT_HEADER_SIZE;
+    s->size = (size_t)h.size;
+    s->root = h.root == UINT64_MAX ? NULL : (uint8 *)s->data + h.root;
     return true;
 }
 
-c_String_view c_sv_get_part(c_String_view sv, int from, int to) {
-    from = c_clampi(from, 0, sv.count);
-    to   = c_clampi(to, from, sv.count);
+void c_arena_snapshot_unload(c_Arena_snapshot *s) {
+    c_unmap_file(s->file);
+    C_MEMSET(s, 0, sizeof(*s));
+}
 
-    c_String_view range = {
-        .data = (char*)(sv.data + from),
-        .count = (size_t)(to - from),
-    };
+//
+// Compression
+//
 
-    return range;
+#define C_LZ_MIN_MATCH     4
+#define C_LZ_LAST_LITERALS 5  // the last bytes are always literals
+#define C_LZ_MFLIMIT       12 // no match starts closer than this to the end
+#define C_LZ_MAX_OFFSET    65535
+#define C_LZ_HASH_LOG      12
+#define C_LZ_SKIP_TRIGGER  6  // after 2^this misses in a row, skip ahead faster
+
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define C_LZ_LITTLE_ENDIAN // the lowest set bit of two XORed words is in the first byte that differs
+#endif
+
+static inline uint32 c_lz_read32(const uint8 *p) {
+    uint32 v;
+    C_MEMCPY(&v, p, sizeof(v));
+    return v;
 }
 
-bool c_sv_lpop_arg(c_String_view *sv, c_String_view *out) {
-    c_sv_trim(sv);
-    if (sv->count == 0) return false;
+static inline uint64 c_lz_read64(const uint8 *p) {
+    uint64 v;
+    C_MEMCPY(&v, p, sizeof(v));
+    return v;
+}
 
-    // If starts with a quote, consume until matching quote (allowing backslash escapes).
-    char start = sv->data[0];
-    if (start == '"' || start == '\'') {
-        // skip opening quote
-        sv->data++;
-        sv->count--;
-        const char *start_ptr = sv->data;
-        size_t out_count = 0;
+static inline uint32 c_lz_hash(uint32 seq) {
+    return (seq * 2654435761u) >> (32 - C_LZ_HASH_LOG);
+}
 
-        while (sv->count > 0) {
-            char c = *sv->data;
-            if (c == '\\' && sv->count > 1) {
-                // skip backslash, take next char literally
-                sv->data++;
-                sv->count--;
-                sv->data++; sv->count--;
-                out_count += 1;
-                continue;
+// Writes a length that didn't fit in its 4 bits of the token
+static inline uint8 *c_lz_write_length(uint8 *op, size_t len) {
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = (uint8)len;
+    return op;
+}
+
+size_t c_lz_compress_block(const void *src, size_t src_size, void *dst, size_t dst_capacity) {
+    const uint8 *base = src;
+    const uint8 *ip = base;
+    const uint8 *anchor = base;
+    const uint8 *end = base + src_size;
+    uint8 *op = dst;
+    uint8 *oend = op + dst_capacity;
+    C_ASSERT(src_size <= UINT32_MAX, "Compress big buffers in blocks (see c_Lz_encoder)");
+
+    if (src_size > C_LZ_MFLIMIT) {
+        const uint8 *mflimit = end - C_LZ_MFLIMIT;
+        const uint8 *matchlimit = end - C_LZ_LAST_LITERALS;
+        // NOTE: Positions from `base`; A stale or 0 entry just fails the compare below
+        uint32 table[1 << C_LZ_HASH_LOG];
+        C_MEMSET(table, 0, sizeof(table));
+        table[c_lz_hash(c_lz_read32(ip))] = 0;
+        ip++;
+
+        for (;;) {
+            const uint8 *match;
+            uint32 attempts = 1u << C_LZ_SKIP_TRIGGER;
+            for (;;) {
+                if (ip > mflimit) goto last_literals;
+                uint32 seq = c_lz_read32(ip);
+                uint32 h = c_lz_hash(seq);
+                match = base + table[h];
+                table[h] = (uint32)(ip - base);
+                if (match < ip && ip - match <= C_LZ_MAX_OFFSET && c_lz_read32(match) == seq) break;
+                ip += attempts++ >> C_LZ_SKIP_TRIGGER;
             }
-            if (c == start) {
-                // closing quote found; advance past it and finish
-                sv->data++;
-                sv->count--;
+
+            while (ip > anchor && match > base && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+
+            const uint8 *mp = ip + C_LZ_MIN_MATCH;
+            const uint8 *mm = match + C_LZ_MIN_MATCH;
+            while (mp + 8 <= matchlimit) {
+                uint64 diff = c_lz_read64(mp) ^ c_lz_read64(mm);
+                if (diff == 0) {
+                    mp += 8;
+                    mm += 8;
+                    continue;
+                }
+#if defined(C_LZ_LITTLE_ENDIAN)
+                mp += c_ctz64(diff) >> 3;
+                goto match_end;
+#else
                 break;
+#endif // defined(C_LZ_LITTLE_ENDIAN)
+            }
+            while (mp < matchlimit && *mp == *mm) {
+                mp++;
+                mm++;
+            }
+#if defined(C_LZ_LITTLE_ENDIAN)
+        match_end:;
+#endif // defined(C_LZ_LITTLE_ENDIAN)
+
+            size_t lit_len = (size_t)(ip - anchor);
+            size_t match_len = (size_t)(mp - ip) - C_LZ_MIN_MATCH;
+            if ((size_t)(oend - op) < 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1) return 0;
+
+            uint8 *token = op++;
+            if (lit_len >= 15) {
+                *token = 15 << 4;
+                op = c_lz_write_length(op, lit_len - 15);
+            } else {
+                *token = (uint8)(lit_len << 4);
+            }
+            C_MEMCPY(op, anchor, lit_len);
+            op += lit_len;
+
+            size_t offset = (size_t)(ip - match);
+            *op++ = (uint8)offset;
+            *op++ = (uint8)(offset >> 8);
+            if (match_len >= 15) {
+                *token |= 15;
+                op = c_lz_write_length(op, match_len - 15);
+            } else {
+                *token |= (uint8)match_len;
             }
-            sv->data++;
-            sv->count--;
-            out_count++;
-        }
 
-        *out = (c_String_view){ .data = (char*)start_ptr, .count = out_count };
-        return true;
+            ip = anchor = mp;
+            if (ip > mflimit) break;
+            // Positions the skipped-over part of the match would have added
+            table[c_lz_hash(c_lz_read32(ip - 2))] = (uint32)(ip - 2 - base);
+        }
     }
 
-    // Unquoted: pop until next space
-    const char *start_ptr = sv->data;
-    while (sv->count > 0 && *sv->data != ' ') {
-        sv->data++;
-        sv->count--;
+last_literals:;
+    size_t lit_len = (size_t)(end - anchor);
+    if ((size_t)(oend - op) < 1 + lit_len / 255 + 1 + lit_len) return 0;
+    if (lit_len >= 15) {
+        *op++ = 15 << 4;
+        op = c_lz_write_length(op, lit_len - 15);
+    } else {
+        *op++ = (uint8)(lit_len << 4);
     }
-    *out = (c_String_view){ .data = (char*)start_ptr, .count = (size_t)(sv->data - start_ptr) };
+    C_MEMCPY(op, anchor, lit_len);
+    op += lit_len;
+    return (size_t)(op - (uint8 *)dst);
+}
+
+// Gives back false if it runs off the end of the input
+static inline bool c_lz_read_length(const uint8 **ip, const uint8 *iend, size_t *len) {
+    uint8 b;
+    do {
+        if (*ip >= iend) return false;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
     return true;
 }
 
-//
-// String
-//
+int64 c_lz_decompress_block(const void *src, size_t src_size, void *dst, size_t dst_capacity) {
+    const uint8 *ip = src;
+    const uint8 *iend = ip + src_size;
+    uint8 *base = dst;
+    uint8 *op = base;
+    uint8 *oend = base + dst_capacity;
+
+    for (;;) {
+        if (ip >= iend) return -1;
+        uint32 token = *ip++;
+        size_t lit_len = token >> 4;
+        size_t match_len = token & 15;
+        size_t offset;
+
+        // NOTE: Copying in fixed-size chunks can go past the literals or the match, that's fine as long as it
+        //       stays in the buffers
+        if (lit_len < 15 && (size_t)(iend - ip) >= 16 + 2 && (size_t)(oend - op) >= 32) {
+            // Most sequences are this short, no loops for them
+            C_MEMCPY(op, ip, 16);
+            op += lit_len;
+            ip += lit_len;
+            offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > (size_t)(op - base)) return -1;
+            if (match_len < 15 && offset >= 8) {
+                const uint8 *match = op - offset;
+                C_MEMCPY(op, match, 8);
+                C_MEMCPY(op + 8, match + 8, 8);
+                C_MEMCPY(op + 16, match + 16, 2);
+                op += match_len + C_LZ_MIN_MATCH;
+                continue;
+            }
+        } else {
+            if (lit_len == 15 && !c_lz_read_length(&ip, iend, &lit_len)) return -1;
+            if (lit_len > (size_t)(iend - ip) || lit_len > (size_t)(oend - op)) return -1;
+            if ((size_t)(iend - ip) >= lit_len + 16 && (size_t)(oend - op) >= lit_len + 16) {
+                for (size_t i = 0; i < lit_len; i += 16) C_MEMCPY(op + i, ip + i, 16);
+            } else {
+                C_MEMCPY(op, ip, lit_len);
+            }
+            op += lit_len;
+            ip += lit_len;
+            if (ip == iend) break; // the last sequence has no match
+
+            if (iend - ip < 2) return -1;
+            offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > (size_t)(op - base)) return -1;
+        }
 
-bool c_str_starts_with(const char *str, const char *suffix) {
-    if (str == NULL) return false;
-    while (*str != 0 && *suffix != 0) {
-        if (*suffix++ != *str++) {
-            return false;
+        if (match_len == 15 && !c_lz_read_length(&ip, iend, &match_len)) return -1;
+        match_len += C_LZ_MIN_MATCH;
+        if (match_len > (size_t)(oend - op)) return -1;
+
+        const uint8 *match = op - offset;
+        if ((size_t)(oend - op) < match_len + 8) {
+            for (size_t i = 0; i < match_len; ++i) op[i] = match[i];
+        } else if (offset >= 8) {
+            // Every 8 bytes read are already written, even when the match overlaps what it's writing
+            for (size_t i = 0; i < match_len; i += 8) C_MEMCPY(op + i, match + i, 8);
+        } else {
+            // A short repeating pattern: after the first 8 bytes, copy from a whole number of periods back
+            // that's at least 8 bytes away
+            for (size_t i = 0; i < 8; ++i) op[i] = match[i];
+            size_t back = offset * ((8 + offset - 1) / offset);
+            for (size_t i = 8; i < match_len; i += 8) C_MEMCPY(op + i, op + i - back, 8);
+        }
+        op += match_len;
+    }
+    return (int64)(op - base);
+}
+
+static void c_lz_put32(c_String_builder *sb, uint32 v) {
+    char bytes[4] = { (char)v, (char)(v >> 8), (char)(v >> 16), (char)(v >> 24) };
+    c_sb_append_sv(sb, (c_String_view){ .data = bytes, .count = sizeof(bytes) });
+}
+
+static uint32 c_lz_get32(const char *p) {
+    const uint8 *b = (const uint8 *)p;
+    return (uint32)b[0] | ((uint32)b[1] << 8) | ((uint32)b[2] << 16) | ((uint32)b[3] << 24);
+}
+
+static void c_lz_encoder_flush_block(c_Lz_encoder *e, const char *data, size_t size) {
+    if (size == 0) return;
+    c_String_builder *out = e->out;
+    size_t bound = c_lz_compress_bound(size);
+    c_sb_reserve(out, 4 + bound);
+    size_t n = c_lz_compress_block(data, size, out->items + out->count + 4, bound);
+    if (n == 0 || n >= size) {
+        // Didn't get any smaller
+        c_lz_put32(out, (uint32)size | 0x80000000u);
+        c_sb_append_sv(out, (c_String_view){ .data = (char *)data, .count = size });
+    } else {
+        c_lz_put32(out, (uint32)n);
+        out->count += n;
+    }
+}
+
+void c_lz_encoder_begin(c_Lz_encoder *e, c_String_builder *out) {
+    C_MEMSET(e, 0, sizeof(*e));
+    e->out = out;
+    c_hash_init(&e->hash, 0);
+    c_sb_append_sv(out, (c_String_view){ .data = C_LZ_FRAME_MAGIC, .count = 4 });
+    c_lz_put32(out, C_LZ_BLOCK_SIZE);
+}
+
+void c_lz_encoder_write(c_Lz_encoder *e, c_String_view data) {
+    c_hash_update(&e->hash, data.data, data.count);
+    while (data.count > 0) {
+        // Whole blocks straight from the input
+        if (e->block_count == 0 && data.count >= C_LZ_BLOCK_SIZE) {
+            c_lz_encoder_flush_block(e, data.data, C_LZ_BLOCK_SIZE);
+            c_sv_lremove(&data, C_LZ_BLOCK_SIZE);
+            continue;
+        }
+        if (e->block == NULL) {
+            e->block = C_MALLOC(C_LZ_BLOCK_SIZE);
+            C_ASSERT(e->block != NULL, "Buy more RAM bruh");
+        }
+        size_t n = C_LZ_BLOCK_SIZE - e->block_count;
+        if (n > data.count) n = data.count;
+        C_MEMCPY(e->block + e->block_count, data.data, n);
+        e->block_count += n;
+        c_sv_lremove(&data, n);
+        if (e->block_count == C_LZ_BLOCK_SIZE) {
+            c_lz_encoder_flush_block(e, e->block, e->block_count);
+            e->block_count = 0;
+        }
+    }
+}
+
+void c_lz_encoder_end(c_Lz_encoder *e) {
+    c_lz_encoder_flush_block(e, e->block, e->block_count);
+    C_FREE(e->block);
+
+    uint64 checksum = c_hash_final(&e->hash);
+    c_lz_put32(e->out, 0);
+    c_lz_put32(e->out, (uint32)checksum);
+    c_lz_put32(e->out, (uint32)(checksum >> 32));
+    C_MEMSET(e, 0, sizeof(*e));
+}
+
+enum {
+    C_LZ_DECODE_HEADER,
+    C_LZ_DECODE_BLOCKS,
+    C_LZ_DECODE_CHECKSUM,
+    C_LZ_DECODE_DONE,
+    C_LZ_DECODE_FAILED,
+};
+
+void c_lz_decoder_begin(c_Lz_decoder *d) {
+    C_MEMSET(d, 0, sizeof(*d));
+    c_hash_init(&d->hash, 0);
+    d->state = C_LZ_DECODE_HEADER;
+}
+
+static bool c_lz_decoder_fail(c_Lz_decoder *d, cstr why) {
+    c_log_error("Corrupted compressed data: %s", why);
+    d->state = C_LZ_DECODE_FAILED;
+    return false;
+}
+
+// Handles what's at the start of `in`; Gives back how many bytes it used, 0 if it needs more.
+static size_t c_lz_decoder_step(c_Lz_decoder *d, c_String_view in, c_String_builder *out) {
+    switch (d->state) {
+    case C_LZ_DECODE_HEADER: {
+        if (in.count < 8) return 0;
+        if (memcmp(in.data, C_LZ_FRAME_MAGIC, 4) != 0) return c_lz_decoder_fail(d, "not a compressed frame"), 0;
+        d->block_size = c_lz_get32(in.data + 4);
+        if (d->block_size == 0 || d->block_size > C_LZ_MAX_BLOCK_SIZE) return c_lz_decoder_fail(d, "bad block size"), 0;
+        d->state = C_LZ_DECODE_BLOCKS;
+        return 8;
+    }
+    case C_LZ_DECODE_BLOCKS: {
+        if (in.count < 4) return 0;
+        uint32 header = c_lz_get32(in.data);
+        if (header == 0) {
+            d->state = C_LZ_DECODE_CHECKSUM;
+            return 4;
+        }
+        bool stored = (header & 0x80000000u) != 0;
+        size_t size = header & 0x7FFFFFFFu;
+        if (size > c_lz_compress_bound(d->block_size)) return c_lz_decoder_fail(d, "block too big"), 0;
+        if (in.count - 4 < size) return 0;
+
+        const char *data = in.data + 4;
+        if (stored) {
+            if (size > d->block_size) return c_lz_decoder_fail(d, "block too big"), 0;
+            c_sb_append_sv(out, (c_String_view){ .data = (char *)data, .count = size });
+            c_hash_update(&d->hash, data, size);
+        } else {
+            c_sb_reserve(out, d->block_size);
+            int64 n = c_lz_decompress_block(data, size, out->items + out->count, d->block_size);
+            if (n < 0) return c_lz_decoder_fail(d, "bad block"), 0;
+            c_hash_update(&d->hash, out->items + out->count, (size_t)n);
+            out->count += (size_t)n;
+        }
+        return 4 + size;
+    }
+    case C_LZ_DECODE_CHECKSUM: {
+        if (in.count < 8) return 0;
+        uint64 checksum = (uint64)c_lz_get32(in.data) | ((uint64)c_lz_get32(in.data + 4) << 32);
+        if (checksum != c_hash_final(&d->hash)) return c_lz_decoder_fail(d, "checksum mismatch"), 0;
+        d->state = C_LZ_DECODE_DONE;
+        return 8;
+    }
+    case C_LZ_DECODE_DONE:
+        return c_lz_decoder_fail(d, "data after the end of the frame"), 0;
+    default:
+        return 0;
+    }
+}
+
+bool c_lz_decoder_feed(c_Lz_decoder *d, c_String_view in, c_String_builder *out) {
+    if (d->state == C_LZ_DECODE_FAILED) return false;
+
+    // NOTE: Steps run straight on `in` when nothing is pending, so whole frames never get copied
+    while (in.count > 0) {
+        if (d->pending.count == 0) {
+            size_t used = c_lz_decoder_step(d, in, out);
+            if (d->state == C_LZ_DECODE_FAILED) return false;
+            if (used > 0) {
+                c_sv_lremove(&in, used);
+                continue;
+            }
+            c_sb_append_sv(&d->pending, in);
+            return true;
+        }
+
+        // Exactly what the next step needs, so it uses all of `pending` and the rest can go the fast way above
+        size_t want = 8;
+        if (d->state == C_LZ_DECODE_BLOCKS) {
+            want = d->pending.count < 4 ? 4 : 4 + (c_lz_get32(d->pending.items) & 0x7FFFFFFFu);
+        }
+        size_t n = want - d->pending.count;
+        if (n > in.count) n = in.count;
+        c_sb_append_sv(&d->pending, (c_String_view){ .data = in.data, .count = n });
+        c_sv_lremove(&in, n);
+
+        size_t used = c_lz_decoder_step(d, (c_String_view){ .data = d->pending.items, .count = d->pending.count }, out);
+        if (d->state == C_LZ_DECODE_FAILED) return false;
+        if (used > 0) {
+            C_MEMMOVE(d->pending.items, d->pending.items + used, d->pending.count - used);
+            d->pending.count -= used;
         }
     }
     return true;
 }
 
+bool c_lz_decoder_done(const c_Lz_decoder *d) {
+    return d->state == C_LZ_DECODE_DONE && d->pending.count == 0;
+}
+
+void c_lz_decoder_free(c_Lz_decoder *d) {
+    c_sb_free(&d->pending);
+    C_MEMSET(d, 0, sizeof(*d));
+}
+
+void c_lz_compress(c_String_view src, c_String_builder *out) {
+    c_Lz_encoder e;
+    c_lz_encoder_begin(&e, out);
+    c_lz_encoder_write(&e, src);
+    c_lz_encoder_end(&e);
+}
+
+bool c_lz_decompress(c_String_view src, c_String_builder *out) {
+    c_Lz_decoder d;
+    c_lz_decoder_begin(&d);
+    bool ok = c_lz_decoder_feed(&d, src, out);
+    if (ok && !c_lz_decoder_done(&d)) ok = c_lz_decoder_fail(&d, "the frame is cut short");
+    c_lz_decoder_free(&d);
+    return ok;
+}
+
 #endif
@@ -0,0 +1,46 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#define COMMONLIB_TRACK_ALLOCS
+#include "../commonlib.h"
+
+typedef struct {
+    int *items;
+    size_t count;
+    size_t capacity;
+} Ints; // @darr
+
+// Only the sites in this file, line numbers in commonlib.h move around
+static void print_sites(void) {
+    Alloc_sites sites = {0};
+    alloc_summary(&sites);
+    for (size_t i = 0; i < sites.count; ++i) {
+        Alloc_site s = sites.items[i];
+        if (strstr(s.file, "alloc_tracking.c") == NULL) continue;
+        printf("line %d: live %llu bytes in %llu, peak %llu, %llu allocations\n", s.line,
+               (unsigned long long)s.live_bytes, (unsigned long long)s.live_count,
+               (unsigned long long)s.peak_bytes, (unsigned long long)s.total_count);
+    }
+    darr_free(sites);
+}
+
+int main(void) {
+    void *a = C_MALLOC(100);
+    void *b = C_CALLOC(10, 30);
+    char *c = C_MALLOC(8);
+    c = C_REALLOC(c, 64);
+
+    Ints xs = {0};
+    for (int i = 0; i < 1000; ++i) darr_append(xs, i);
+
+    C_FREE(a);
+    print_sites();
+
+    // Not tracked, so just freed
+    C_FREE(malloc(16));
+
+    darr_free(xs);
+    C_FREE(c);
+    printf("leaks: %llu\n", (unsigned long long)alloc_print_leaks(stdout));
+    (void)b; // left for the report at exit
+    return 0;
+}
@@ -0,0 +1,84 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#define PATH "arena_snapshot.tmp"
+
+// A chained hash table of names to ids, all in the arena
+typedef struct {
+    Rel_ptr next; // Entry
+    Rel_ptr name; // NUL-terminated
+    int64 id;
+} Entry;
+
+#define BUCKETS 64
+
+typedef struct {
+    int64 count;
+    Rel_ptr buckets[BUCKETS]; // Entry
+} Table;
+
+static int64 lookup(const Table *t, const char *name) {
+    const Entry *e = rel_ptr_get(&t->buckets[hash(name, strlen(name), 0) % BUCKETS]);
+    for (; e; e = rel_ptr_get(&e->next)) {
+        if (strcmp(rel_ptr_get(&e->name), name) == 0) return e->id;
+    }
+    return -1;
+}
+
+int main(void) {
+    // Small on purpose, so it moves while growing
+    Arena a = arena_make(256);
+    size_t table_off = arena_offset(&a, arena_alloc(&a, sizeof(Table)));
+    C_MEMSET(arena_at(&a, table_off), 0, sizeof(Table));
+
+    for (int64 i = 0; i < 1000; ++i) {
+        char name[32];
+        int len = snprintf(name, sizeof(name), "name_%lld", (long long)i);
+        // NOTE: c_arena_alloc() doesn't align, so keep the entries 8-byte aligned by hand
+        size_t name_off = arena_offset(&a, arena_alloc(&a, ((size_t)len + 8) & ~(size_t)7));
+        size_t entry_off = arena_offset(&a, arena_alloc(&a, sizeof(Entry)));
+        memcpy(arena_at(&a, name_off), name, (size_t)len + 1);
+
+        Table *t = arena_at(&a, table_off);
+        Entry *e = arena_at(&a, entry_off);
+        Rel_ptr *bucket = &t->buckets[hash(name, (size_t)len, 0) % BUCKETS];
+        e->id = i * 10;
+        rel_ptr_set(&e->name, arena_at(&a, name_off));
+        rel_ptr_set(&e->next, rel_ptr_get(bucket));
+        rel_ptr_set(bucket, e);
+        t->count++;
+    }
+    if (!arena_save(&a, arena_at(&a, table_off), PATH)) return 1;
+    arena_free(&a);
+
+    Arena_snapshot s;
+    if (!arena_snapshot_load(&s, PATH, true)) return 1;
+    const Table *t = s.root;
+    printf("count: %lld\n", (long long)t->count);
+    printf("name_0: %lld, name_999: %lld, name_1000: %lld\n",
+           (long long)lookup(t, "name_0"), (long long)lookup(t, "name_999"), (long long)lookup(t, "name_1000"));
+    size_t size = s.size;
+    arena_snapshot_unload(&s);
+
+    // Flip a byte in the data
+    FILE *f = fopen(PATH, "r+b");
+    fseek(f, C_ARENA_SNAPSHOT_HEADER_SIZE + (long)size / 2, SEEK_SET);
+    int ch = fgetc(f);
+    fseek(f, C_ARENA_SNAPSHOT_HEADER_SIZE + (long)size / 2, SEEK_SET);
+    fputc(ch ^ 0x20, f);
+    fclose(f);
+    printf("corrupted, verified: %s\n", arena_snapshot_load(&s, PATH, true) ? "loaded" : "refused");
+    printf("corrupted, not verified: %s\n", arena_snapshot_load(&s, PATH, false) ? "loaded" : "refused");
+    arena_snapshot_unload(&s);
+
+    // Truncated
+    Arena empty = arena_make(0);
+    if (!arena_save(&empty, NULL, PATH)) return 1;
+    arena_free(&empty);
+    printf("empty: %s\n", arena_snapshot_load(&s, PATH, true) && s.root == NULL && s.size == 0 ? "loaded" : "refused");
+    arena_snapshot_unload(&s);
+
+    remove(PATH);
+    return 0;
+}
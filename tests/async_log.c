@@ -0,0 +1,43 @@
+// Small so the messages below wrap around it plenty of times
+#define C_LOG_RING_SIZE 4096
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+static void *thread_main(void *arg) {
+    int id = *(int *)arg;
+    for (int i = 0; i < 3; ++i) log_info("thread %d: message %d", id, i);
+    return NULL;
+}
+
+int main(void) {
+    log_info("sync before start");
+    ASSERT(log_async_start(), "We are trying to start async logging...");
+    log_install_crash_handler();
+
+    for (int i = 0; i < 5; ++i) log_info("main: message %d", i);
+    log_warning("main: a warning");
+    log_error("main: an error");
+    // Order is only kept per thread, flush so the thread's logs come after
+    log_flush();
+
+    int id = 1;
+    Thread t;
+    thread_create(&t, thread_main, &id);
+    thread_join(t);
+    log_flush();
+
+    // Bigger than the on-stack format buffer
+    char big[2000];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    log_info("big: %zu chars", strlen(big));
+    log_info("%s", big);
+
+    // Lots of messages to go through the ring more than once
+    for (int i = 0; i < 300; ++i) log_info("spam %d", i);
+    log_async_stop();
+
+    log_info("sync after stop");
+    return 0;
+}
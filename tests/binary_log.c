@@ -0,0 +1,83 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+static Log_module net_log = LOG_MODULE_INIT("net");
+
+static int evaluated = 0;
+static int count_evaluation(void) {
+    return ++evaluated;
+}
+
+static void net_logs(void) {
+#undef C_LOG_MODULE
+#define C_LOG_MODULE (&net_log)
+    log_debug("net: debug %d", count_evaluation());
+    log_info("net: info %d", count_evaluation());
+#undef C_LOG_MODULE
+#define C_LOG_MODULE (&c_log_default_module)
+}
+
+int main(void) {
+    // Thresholds
+    log_debug("hidden by default %d", count_evaluation());
+    net_logs();
+    printf("evaluated: %d\n", evaluated);
+
+    ASSERT(log_configure("net=debug, *=warning"), "Valid spec");
+    log_info("hidden by '*' %d", count_evaluation());
+    net_logs();
+    printf("evaluated: %d\n", evaluated);
+
+    log_set_level("net", C_LOG_OFF);
+    net_logs();
+    printf("evaluated: %d\n", evaluated);
+
+    ASSERT(!log_configure("net=loud"), "Invalid level");
+    log_configure("net=info,*=debug");
+
+    // Binary logging
+    const char *path = "binary_log_test.clog";
+    ASSERT(blog_open(path), "We are trying to open the binary log...");
+    for (int i = 0; i < 3; ++i) log_info("int %d, unsigned %u, hex %#x", -i, (unsigned)i, 255u + i);
+    log_info("long %ld, long long %lld, size %zu, ptrdiff %td", -1L, 1LL << 40, (size_t)42, (ptrdiff_t)-7);
+    log_info("double %.3f, %e, %g, long double %.2Lf", 3.14159, 1e10, 0.5, (long double)2.25);
+    log_info("char %c, percent %%, width %5d|%-5d|", 'x', 12, 34);
+    log_info("star width %*d| precision %.*f|", 6, 7, 2, 1.23456);
+    log_info("string '%s' '%8s' '%.3s'", "hello", "pad", "truncated");
+    // Straight to the binary log, the text path of log_info() would get the NULL too
+    static c_Log_site null_site = { .fmt = "[INFO] null string '%s'\n", .level = C_LOG_INFO };
+    c_blog_write(&null_site, (const char *)NULL);
+    log_warning("net: a warning");
+    log_error("an error");
+    net_logs();
+    blog_close();
+
+    // Text again once it's closed
+    log_info("text after close");
+
+    // NOTE: Not read_file(), it drops '\r's
+    String_view data = map_file(path, 0);
+    ASSERT(data.data != NULL, "We are trying to read the binary log...");
+    String_builder sb = {0};
+    ASSERT(blog_decode(data, &sb), "Decoding");
+    printf("--- decoded\n%.*s---\n", (int)sb.count, sb.items);
+
+    // A second binary log describes the call sites again
+    ASSERT(blog_open(path), "Reopening");
+    net_logs();
+    log_info("new site %d", 1);
+    blog_close();
+    unmap_file(data);
+    data = map_file(path, 0);
+    sb.count = 0;
+    ASSERT(blog_decode(data, &sb), "Decoding again");
+    printf("--- decoded\n%.*s---\n", (int)sb.count, sb.items);
+
+    ASSERT(!blog_decode((String_view){ data.data, 4 }, &sb), "Truncated log");
+
+    unmap_file(data);
+    darr_free(sb);
+    remove(path);
+    return 0;
+}
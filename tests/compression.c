@@ -0,0 +1,85 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+static bool same(String_builder *sb, String_view sv) {
+    return sb->count == sv.count && (sv.count == 0 || memcmp(sb->items, sv.data, sv.count) == 0);
+}
+
+int main(void) {
+    // Text that repeats a lot, bigger than a block
+    String_builder text = {0};
+    for (int i = 0; i < 40000; ++i) sb_appendf(&text, "line %d: the quick brown fox jumps over the lazy dog\n", i % 500);
+    String_view text_sv = { .data = text.items, .count = text.count };
+
+    String_builder packed = {0}, unpacked = {0};
+    lz_compress(text_sv, &packed);
+    printf("text: %zu -> smaller than a tenth: %s\n", text.count, packed.count * 10 < text.count ? "true" : "false");
+    printf("roundtrip: %s\n", lz_decompress((String_view){ .data = packed.items, .count = packed.count }, &unpacked) && same(&unpacked, text_sv) ? "true" : "false");
+
+    // Fed in odd pieces, as if read from a file
+    Lz_decoder d;
+    lz_decoder_begin(&d);
+    unpacked.count = 0;
+    bool ok = true;
+    for (size_t i = 0; i < packed.count && ok; i += 777) {
+        size_t n = packed.count - i < 777 ? packed.count - i : 777;
+        ok = lz_decoder_feed(&d, (String_view){ .data = packed.items + i, .count = n }, &unpacked);
+    }
+    printf("streamed: %s\n", ok && lz_decoder_done(&d) && same(&unpacked, text_sv) ? "true" : "false");
+    lz_decoder_free(&d);
+
+    // Written in odd pieces too
+    String_builder packed2 = {0};
+    Lz_encoder e;
+    lz_encoder_begin(&e, &packed2);
+    for (size_t i = 0; i < text.count; i += 1000) {
+        lz_encoder_write(&e, (String_view){ .data = text.items + i, .count = text.count - i < 1000 ? text.count - i : 1000 });
+    }
+    lz_encoder_end(&e);
+    printf("same frame: %s\n", packed2.count == packed.count && memcmp(packed2.items, packed.items, packed.count) == 0 ? "true" : "false");
+
+    // Random bytes don't compress and get stored as is
+    Rng rng;
+    rng_seed(&rng, 3);
+    char noise[5000];
+    for (size_t i = 0; i < sizeof(noise); ++i) noise[i] = (char)rng_below(&rng, 256);
+    String_view noise_sv = { .data = noise, .count = sizeof(noise) };
+    packed.count = 0;
+    unpacked.count = 0;
+    lz_compress(noise_sv, &packed);
+    printf("noise: %zu -> %zu\n", noise_sv.count, packed.count);
+    printf("noise roundtrip: %s\n", lz_decompress((String_view){ .data = packed.items, .count = packed.count }, &unpacked) && same(&unpacked, noise_sv) ? "true" : "false");
+
+    packed.count = 0;
+    unpacked.count = 0;
+    lz_compress((String_view){0}, &packed);
+    printf("empty: %zu bytes, roundtrip: %s\n", packed.count,
+           lz_decompress((String_view){ .data = packed.items, .count = packed.count }, &unpacked) && unpacked.count == 0 ? "true" : "false");
+
+    // Raw blocks
+    char block[64];
+    char back[sizeof("abcabcabcabcabcabcabcabcabcabcabc!")];
+    size_t n = lz_compress_block("abcabcabcabcabcabcabcabcabcabcabc!", sizeof(back), block, sizeof(block));
+    int64 m = lz_decompress_block(block, n, back, sizeof(back));
+    printf("block: %zu -> %zu -> %lld, %s\n", sizeof(back), n, (long long)m, back);
+    printf("block too small for it: %lld\n", (long long)lz_decompress_block(block, n, back, sizeof(back) - 1));
+
+    // Broken frames
+    packed.count = 0;
+    lz_compress(text_sv, &packed);
+    packed.items[packed.count / 2] ^= 0x10;
+    unpacked.count = 0;
+    printf("corrupted: %s\n", lz_decompress((String_view){ .data = packed.items, .count = packed.count }, &unpacked) ? "accepted" : "refused");
+    packed.items[packed.count / 2] ^= 0x10;
+    unpacked.count = 0;
+    printf("cut short: %s\n", lz_decompress((String_view){ .data = packed.items, .count = packed.count - 3 }, &unpacked) ? "accepted" : "refused");
+    unpacked.count = 0;
+    printf("not a frame: %s\n", lz_decompress(SV("hello there, not compressed"), &unpacked) ? "accepted" : "refused");
+
+    sb_free(&text);
+    sb_free(&packed);
+    sb_free(&packed2);
+    sb_free(&unpacked);
+    return 0;
+}
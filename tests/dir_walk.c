@@ -0,0 +1,91 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#include <sys/stat.h>
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char **)a, *(char **)b);
+}
+
+static const char *type_str(Dir_entry_type type) {
+    switch (type) {
+        case DIR_ENTRY_FILE: return "file";
+        case DIR_ENTRY_DIR:  return "dir";
+        case DIR_ENTRY_LINK: return "link";
+        default:             return "other";
+    }
+}
+
+// Entries come out in the filesystem's order, so sort them to get a stable output
+static void print_walk(const char *title, Dir_walk *walk) {
+    char **lines = malloc(sizeof(char *) * walk->count);
+    for (size_t i = 0; i < walk->count; ++i) {
+        Dir_entry *e = &walk->items[i];
+        size_t n = strlen(dir_entry_path(walk, e)) + 32;
+        lines[i] = malloc(n);
+        snprintf(lines[i], n, "%s (%s, name '%s')", dir_entry_path(walk, e), type_str(e->type), dir_entry_name(walk, e));
+    }
+    qsort(lines, walk->count, sizeof(*lines), cmp_str);
+
+    log_info("%s: %zu entries", title, walk->count);
+    for (size_t i = 0; i < walk->count; ++i) {
+        log_info("    %s", lines[i]);
+        free(lines[i]);
+    }
+    free(lines);
+}
+
+static bool skip_b(cstr path, cstr name, Dir_entry_type type, void *user) {
+    (void)path; (void)type; (void)user;
+    return strcmp(name, "b") != 0;
+}
+
+int main(void) {
+    mkdir("walk", 0755);
+    mkdir("walk/a", 0755);
+    mkdir("walk/a/deep", 0755);
+    mkdir("walk/b", 0755);
+    touch_file_if_doesnt_exist("walk/top.txt");
+    touch_file_if_doesnt_exist("walk/a/one.txt");
+    touch_file_if_doesnt_exist("walk/a/deep/two.txt");
+    touch_file_if_doesnt_exist("walk/b/three.txt");
+
+    Dir_walk walk = {0};
+    dir_walk(&walk, "walk", 0, NULL, NULL);
+    print_walk("top level", &walk);
+    dir_walk_free(&walk);
+
+    dir_walk(&walk, "walk", WALK_RECURSIVE, NULL, NULL);
+    print_walk("recursive", &walk);
+    dir_walk_free(&walk);
+
+    dir_walk(&walk, "walk", WALK_THREADED, NULL, NULL);
+    print_walk("threaded", &walk);
+    dir_walk_free(&walk);
+
+    dir_walk(&walk, "walk", WALK_RECURSIVE, skip_b, NULL);
+    print_walk("without b", &walk);
+    dir_walk_free(&walk);
+
+    // Used to stat() relative to the cwd instead of `dir`
+    String_array files = os_list_files("walk/a");
+    for (size_t i = 0; i < files.count; ++i) {
+        log_info("os_list_files: %s", files.items[i]);
+        free(files.items[i]);
+    }
+    darr_free(files);
+
+    log_info("missing dir: %s", dir_walk(&walk, "no_such_dir", 0, NULL, NULL) ? "true" : "false");
+
+    remove("walk/b/three.txt");
+    remove("walk/a/deep/two.txt");
+    remove("walk/a/one.txt");
+    remove("walk/top.txt");
+    remove("walk/b");
+    remove("walk/a/deep");
+    remove("walk/a");
+    remove("walk");
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#define N 1003 // not a multiple of 4 to go through the tails
+
+typedef void (*Batch_fn)(const float *in, float *out, size_t n);
+typedef float (*Scalar_fn)(float t);
+
+static float in[N], out[N];
+
+static void check(const char *name, Batch_fn batch, Scalar_fn scalar) {
+    batch(in, out, N);
+    float max_err = 0.f;
+    for (size_t i = 0; i < N; ++i) max_err = MAX(max_err, fabsf(out[i] - scalar(in[i])));
+    printf("%s: %s\n", name, max_err < 1e-6f ? "ok" : "too far off");
+}
+
+int main(void) {
+    for (size_t i = 0; i < N; ++i) in[i] = (float)i / (N - 1);
+
+    check("ease_in_sine_batch", ease_in_sine_batch, ease_in_sine);
+    check("ease_out_sine_batch", ease_out_sine_batch, ease_out_sine);
+    check("ease_in_out_sine_batch", ease_in_out_sine_batch, ease_in_out_sine);
+    check("ease_in_bounce_batch", ease_in_bounce_batch, ease_in_bounce);
+    check("ease_out_bounce_batch", ease_out_bounce_batch, ease_out_bounce);
+
+    // Touches the ground between bounces, tops of the bounces in between
+    float ts[] = { 0.f, 1.f / 2.75f, 1.5f / 2.75f, 2.f / 2.75f, 2.25f / 2.75f, 2.5f / 2.75f, 2.625f / 2.75f, 1.f };
+    for (size_t i = 0; i < C_ARRAY_LEN(ts); ++i) printf("ease_out_bounce(%.4f): %.4f\n", ts[i], ease_out_bounce(ts[i]));
+
+    // Batch and scalar fast trig agree exactly, and stay close to libm over a wide range
+    for (size_t i = 0; i < N; ++i) in[i] = -1000.f + 2000.f * (float)i / (N - 1);
+    bool same = true;
+    float max_err = 0.f;
+    sin_fast_batch(in, out, N);
+    for (size_t i = 0; i < N; ++i) {
+        same = same && out[i] == sin_fast(in[i]);
+        max_err = MAX(max_err, fabsf(out[i] - (float)sin(in[i])));
+    }
+    cos_fast_batch(in, out, N);
+    for (size_t i = 0; i < N; ++i) {
+        same = same && out[i] == cos_fast(in[i]);
+        max_err = MAX(max_err, fabsf(out[i] - (float)cos(in[i])));
+    }
+    printf("fast trig batch == scalar: %s\n", same ? "true" : "false");
+    printf("fast trig error < 2e-7: %s\n", max_err < 2e-7f ? "true" : "false");
+    printf("sin_fast(pi/6): %.6f, cos_fast(-pi/3): %.6f\n", sin_fast(C_PI_F / 6.f), cos_fast(-C_PI_F / 3.f));
+
+    // Out of the fast range (and non-finite) inputs go to libm, in the batch versions too
+    float odd[] = { NAN, INFINITY, -INFINITY, 1e10f, -3e9f, 8192.5f, 0.5f, 1e30f };
+    float odd_out[C_ARRAY_LEN(odd)];
+    sin_fast_batch(odd, odd_out, C_ARRAY_LEN(odd));
+    same = true;
+    for (size_t i = 0; i < C_ARRAY_LEN(odd); ++i) {
+        float expected = fabsf(odd[i]) <= 8192.f ? sin_fast(odd[i]) : sinf(odd[i]);
+        same = same && (odd_out[i] == expected || (isnan(odd_out[i]) && isnan(expected)));
+    }
+    cos_fast_batch(odd, odd_out, C_ARRAY_LEN(odd));
+    for (size_t i = 0; i < C_ARRAY_LEN(odd); ++i) {
+        float expected = fabsf(odd[i]) <= 8192.f ? cos_fast(odd[i]) : cosf(odd[i]);
+        same = same && (odd_out[i] == expected || (isnan(odd_out[i]) && isnan(expected)));
+    }
+    printf("out of range like libm: %s\n", same ? "true" : "false");
+    printf("sin_fast(nan): %s, cos_fast(inf): %s\n", isnan(sin_fast(NAN)) ? "nan" : "?", isnan(cos_fast(INFINITY)) ? "nan" : "?");
+
+    // In place
+    for (size_t i = 0; i < N; ++i) in[i] = (float)i / (N - 1);
+    ease_out_sine_batch(in, in, N);
+    printf("in place: %.4f %.4f\n", in[0], in[N - 1]);
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+int main(void) {
+    const char *data = "commonlib.h: Standard Library for C";
+    size_t data_size = strlen(data);
+
+    // HEX
+    String_builder sb = {0};
+    sb_append_hex(&sb, data, data_size);
+    log_info("hex: "SV_FMT, (int)sb.count, sb.items);
+
+    String_builder decoded = {0};
+    ASSERT(sb_append_hex_decoded(&decoded, (String_view){ .data = sb.items, .count = sb.count }), "We just encoded this!");
+    log_info("hex decoded: "SV_FMT, (int)decoded.count, decoded.items);
+
+    uint8 bytes[4] = {0};
+    size_t bytes_size = 0;
+    log_info("DEADbeef valid: %d", hex_decode(SV("DEADbeef"), bytes, &bytes_size));
+    log_info("DEADbeef: %02x %02x %02x %02x (%zu bytes)", bytes[0], bytes[1], bytes[2], bytes[3], bytes_size);
+    bool valid = hex_decode(SV("DEADbexf"), bytes, &bytes_size);
+    log_info("DEADbexf valid: %d (%zu bytes before the error)", valid, bytes_size);
+    log_info("abc valid: %d", hex_decode(SV("abc"), bytes, &bytes_size));
+
+    log_info("sv_is_hex_numbers(\"c0ffee\"): %d", sv_is_hex_numbers(SV("c0ffee")));
+    log_info("sv_is_hex_numbers(\"coffee\"): %d", sv_is_hex_numbers(SV("coffee")));
+
+    // BASE64
+    const char *rfc4648[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+    for (size_t i = 0; i < ARRAY_LEN(rfc4648); ++i) {
+        sb.count = 0;
+        sb_append_base64(&sb, rfc4648[i], strlen(rfc4648[i]));
+        decoded.count = 0;
+        ASSERT(sb_append_base64_decoded(&decoded, (String_view){ .data = sb.items, .count = sb.count }), "We just encoded this!");
+        log_info("base64(\"%s\") = \""SV_FMT"\" -> \""SV_FMT"\"", rfc4648[i], (int)sb.count, sb.items, (int)decoded.count, decoded.items);
+    }
+
+    decoded.count = 0;
+    log_info("Zm9vYg valid: %d", sb_append_base64_decoded(&decoded, SV("Zm9vYg")));
+    log_info("Zm9v*g== valid: %d", sb_append_base64_decoded(&decoded, SV("Zm9v*g==")));
+    log_info("Zm9vY valid: %d", sb_append_base64_decoded(&decoded, SV("Zm9vY")));
+    log_info("decoded: "SV_FMT, (int)decoded.count, decoded.items);
+
+    sb_free(&sb);
+    sb_free(&decoded);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+int main(void) {
+    FILE *f = fopen("reader.txt", "wb");
+    ASSERT(f != NULL, "We are trying to write a test file...");
+    fputs("first line\r\n", f);
+    fputs("second line\n", f);
+    fputs("\n", f);
+    fputs("this line is quite a bit longer than the sixteen byte buffer\r\n", f);
+    fputs("no newline at the end", f);
+    fclose(f);
+
+    File_reader r;
+    ASSERT(file_reader_open(&r, "reader.txt", 16), "We are trying to open the test file...");
+    String_view line;
+    int n = 0;
+    while (file_reader_next_line(&r, &line)) {
+        log_info("line %d: '"SV_FMT"'", ++n, SV_ARG(line));
+    }
+    log_info("failed: %s", r.failed ? "true" : "false");
+    file_reader_close(&r);
+
+    f = fopen("reader.txt", "wb");
+    fputs("a,bb,,ccc,", f);
+    fclose(f);
+
+    ASSERT(file_reader_open(&r, "reader.txt", 4), "We are trying to open the test file...");
+    String_view record;
+    while (file_reader_next_record(&r, ',', &record)) {
+        log_info("record: '"SV_FMT"'", SV_ARG(record));
+    }
+    file_reader_close(&r);
+
+    remove("reader.txt");
+
+    log_info("missing file opened: %s", file_reader_open(&r, "this_file_does_not_exist.txt", 0) ? "true" : "false");
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#define _GNU_SOURCE // glibc only has O_DIRECT with this
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#include <sys/stat.h>
+
+// Writes `size` bytes of a known pattern in pieces of `piece` bytes
+static bool write_pattern(File_writer *w, char *pattern, size_t size, size_t piece) {
+    for (size_t i = 0; i < size; ++i) pattern[i] = (char)('a' + i % 26);
+    for (size_t i = 0; i < size; i += piece) {
+        if (!file_writer_write(w, pattern + i, size - i < piece ? size - i : piece)) return false;
+    }
+    return true;
+}
+
+static bool file_matches(const char *path, const char *pattern, size_t size) {
+    int file_size = 0;
+    const char *content = read_file(path, &file_size);
+    bool ok = content != NULL && (size_t)file_size == size && memcmp(content, pattern, size) == 0;
+    free((void *)content);
+    return ok;
+}
+
+int main(void) {
+    File_writer w;
+    // NOTE: The buffer is rounded up to 4096 bytes
+    ASSERT(file_writer_open(&w, "writer.txt", 0, 64), "We are trying to write a test file...");
+    file_writer_write_sv(&w, SV("Hello, "));
+    String_builder sb = {0};
+    sb_append(&sb, "World!\n");
+    file_writer_write_sb(&w, &sb);
+    for (int i = 0; i < 10; ++i) file_writer_writef(&w, "line %d\n", i);
+    file_writer_writef(&w, "%0100d\n", 42);
+    ASSERT(file_writer_close(&w), "Closing should work");
+
+    int size = 0;
+    const char *content = read_file("writer.txt", &size);
+    log_info("%d bytes:\n%s", size, content);
+    free((void *)content);
+
+    // Bigger than the buffer, goes straight to the file
+    char *pattern = malloc(64*1024);
+    ASSERT(file_writer_open(&w, "writer.txt", 0, 64), "We are trying to write a test file...");
+    file_writer_write_sv(&w, SV("x"));
+    ASSERT(write_pattern(&w, pattern + 1, 20000, 10000), "Writing should work");
+    pattern[0] = 'x';
+    ASSERT(file_writer_close(&w), "Closing should work");
+    log_info("pass-through: %s", file_matches("writer.txt", pattern, 20001) ? "matches" : "differs");
+
+    // Falls back to normal writes where O_DIRECT isn't supported (or defined), so the output is the same either way
+    ASSERT(file_writer_open(&w, "writer.txt", WRITE_DIRECT, 4096), "We are trying to write a test file...");
+    ASSERT(write_pattern(&w, pattern, 3*4096 + 100, 1000), "Writing should work");
+    ASSERT(write_pattern(&w, pattern + 3*4096 + 100, 20000, 20000), "Writing should work");
+    ASSERT(file_writer_close(&w), "Closing should work");
+    log_info("direct: %s", file_matches("writer.txt", pattern, 3*4096 + 100 + 20000) ? "matches" : "differs");
+    free(pattern);
+
+    chmod("writer.txt", 0640);
+    ASSERT(file_writer_open(&w, "writer.txt", WRITE_ATOMIC, 0), "We are trying to write a test file...");
+    file_writer_write_sv(&w, SV("replaced atomically\n"));
+    file_writer_flush(&w);
+    content = read_file("writer.txt", &size);
+    log_info("before close: %d bytes", size);
+    free((void *)content);
+    ASSERT(file_writer_close(&w), "Closing should work");
+
+    content = read_file("writer.txt", &size);
+    log_info("after close: %s", content);
+    free((void *)content);
+    struct stat st;
+    stat("writer.txt", &st);
+    log_info("mode kept: %o", (unsigned)(st.st_mode & 0777));
+
+    remove("writer.txt");
+    sb_free(&sb);
+
+    log_info("writing to a missing dir: %s", file_writer_open(&w, "no/such/dir/file.txt", WRITE_ATOMIC, 0) ? "true" : "false");
+
+    return 0;
+}
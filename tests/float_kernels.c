@@ -0,0 +1,67 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#define N 1037 // not a multiple of any vector width to go through the tails
+
+static float32 a[N], b[N], out[N];
+
+static bool close_to(float32 x, float32 y, float32 eps) {
+    return fabsf(x - y) <= eps * fmaxf(1.f, fabsf(y));
+}
+
+int main(void) {
+    printf("mapf(15, 10 ~ 20, 0 ~ 100): %.2f\n", mapf(15.f, 10.f, 20.f, 0.f, 100.f));
+
+    Rng r;
+    rng_seed(&r, 1);
+    for (size_t i = 0; i < N; ++i) {
+        a[i] = rng_float(&r) * 4.f - 2.f;
+        b[i] = rng_float(&r) * 4.f - 2.f;
+    }
+
+    float32 min = INFINITY, max = -INFINITY;
+    float64 sum = 0, dot = 0;
+    for (size_t i = 0; i < N; ++i) {
+        min = MIN(min, a[i]);
+        max = MAX(max, a[i]);
+        sum += a[i];
+        dot += (float64)a[i] * b[i];
+    }
+
+    // Every level this CPU has must agree with the plain loops
+    bool all_ok = true;
+    for (int level = C_SIMD_LEVEL_SCALAR; level <= (int)simd_detected_level(); ++level) {
+        simd_set_level((Simd_level)level);
+        bool ok = simd_level() == (Simd_level)level;
+
+        for (size_t n = 0; n <= N; n += (n < 70 ? 1 : 161)) {
+            f32_clamp(a, out, n, -1.f, 1.f);
+            for (size_t i = 0; i < n; ++i) ok = ok && out[i] == clampf(a[i], -1.f, 1.f);
+            f32_add(a, b, out, n);
+            for (size_t i = 0; i < n; ++i) ok = ok && out[i] == a[i] + b[i];
+            f32_lerp(a, b, out, n, 0.25f);
+            for (size_t i = 0; i < n; ++i) ok = ok && close_to(out[i], a[i] + (b[i] - a[i]) * 0.25f, 1e-6f);
+            f32_scale_add(a, out, n, 3.f, -1.f);
+            for (size_t i = 0; i < n; ++i) ok = ok && close_to(out[i], a[i] * 3.f - 1.f, 1e-6f);
+            f32_map(a, out, n, -2.f, 2.f, 0.f, 1.f);
+            for (size_t i = 0; i < n; ++i) ok = ok && close_to(out[i], mapf(a[i], -2.f, 2.f, 0.f, 1.f), 1e-6f);
+        }
+        ok = ok && f32_min(a, N) == min && f32_max(a, N) == max;
+        ok = ok && close_to(f32_sum(a, N), (float32)sum, 1e-4f) && close_to(f32_dot(a, b, N), (float32)dot, 1e-4f);
+        ok = ok && f32_min(a, 0) == INFINITY && f32_max(a, 0) == -INFINITY && f32_sum(a, 0) == 0.f;
+        if (!ok) printf("%s: FAILED\n", simd_level_name((Simd_level)level));
+        all_ok = all_ok && ok;
+    }
+    printf("all levels agree: %s\n", all_ok ? "true" : "false");
+
+    // Can't go above what's detected
+    simd_set_level(C_SIMD_LEVEL_AVX512);
+    printf("capped: %s\n", simd_level() == simd_detected_level() ? "true" : "false");
+
+    // In place
+    f32_clamp(a, a, N, 0.f, 0.5f);
+    printf("in place: %.2f ~ %.2f\n", f32_min(a, N), f32_max(a, N));
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+int main(void) {
+    String_builder sb = {0};
+
+    sb_appendf(&sb, "%s has %d items", "List", 3);
+    sb_append_sv(&sb, SV(", "));
+    sb_append_int(&sb, -1337);
+    sb_append_char(&sb, ' ');
+    sb_append_uint(&sb, 18446744073709551615ull);
+    sb_append_null(&sb);
+    log_info("%s", sb.items);
+
+    // Bigger than the capacity in one go
+    sb.count = 0;
+    char big[1024];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    sb_append(&sb, big);
+    sb_appendf(&sb, "%s", big);
+    log_info("big appends: %zu bytes", sb.count);
+
+    float64 doubles[] = { 0.1, 0.3, 1.0/3.0, 100, 1e21, 1e-7, 5e-324, -2.5, -0.0 };
+    for (size_t i = 0; i < ARRAY_LEN(doubles); ++i) {
+        sb.count = 0;
+        sb_append_float64(&sb, doubles[i]);
+        log_info("float64: %.*s", (int)sb.count, sb.items);
+    }
+
+    float32 floats[] = { 0.1f, 1.0f/3.0f, 16777216.0f, 3.4028235e38f };
+    for (size_t i = 0; i < ARRAY_LEN(floats); ++i) {
+        sb.count = 0;
+        sb_append_float32(&sb, floats[i]);
+        log_info("float32: %.*s", (int)sb.count, sb.items);
+    }
+
+    char num[FMT_NUMBER_MAX_SIZE];
+    int len = fmt_int(INT64_MIN, num);
+    log_info("fmt_int: %.*s", len, num);
+
+    sb_free(&sb);
+    return 0;
+}
@@ -0,0 +1,38 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+int main(void) {
+    const char *strs[] = {
+        "",
+        "a",
+        "abc",
+        "Hello, World!",
+        "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.",
+    };
+
+    for (size_t i = 0; i < ARRAY_LEN(strs); ++i) {
+        String_view sv = SV(strs[i]);
+        Hash128 h128 = sv_hash128(sv, 0);
+        log_info("%zu bytes: %016llx seed 69: %016llx 128: %016llx%016llx", sv.count,
+                 (unsigned long long)sv_hash(sv, 0), (unsigned long long)sv_hash(sv, 69),
+                 (unsigned long long)h128.hi, (unsigned long long)h128.lo);
+    }
+
+    // Streaming
+    const char *data = strs[ARRAY_LEN(strs)-1];
+    size_t data_size = strlen(data);
+
+    Hash_state st = {0};
+    hash128_init(&st, 0);
+    for (size_t i = 0; i < data_size; i += 7) {
+        hash_update(&st, data + i, data_size - i < 7 ? data_size - i : 7);
+    }
+
+    Hash128 streamed = hash128_final(&st);
+    Hash128 oneshot = hash128(data, data_size, 0);
+    log_info("streamed 64-bit hash matches: %s", hash_final(&st) == hash(data, data_size, 0) ? "yes" : "no");
+    log_info("streamed 128-bit hash matches: %s", streamed.lo == oneshot.lo && streamed.hi == oneshot.hi ? "yes" : "no");
+
+    return 0;
+}
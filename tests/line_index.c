@@ -0,0 +1,40 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+int main(void) {
+    String_view text = SV("first line\nsecond line\r\n\nfourth line after an empty one\nlast line without a newline");
+
+    Line_index li = line_index_build(text);
+
+    log_info("lines: %zu", line_index_count(&li));
+    log_info("newlines: %zu", sv_count_char(text, '\n'));
+
+    for (size_t i = 0; i < line_index_count(&li); ++i) {
+        String_view line = line_index_get(&li, i);
+        log_info("%zu: '"SV_FMT"'", i, SV_ARG(line));
+    }
+
+    log_info("byte 15 is on line %zu", line_index_find(&li, 15));
+
+    for (size_t i = 0; i < 3; ++i) {
+        String_view chunk = line_index_chunk(&li, i, 3);
+        log_info("chunk %zu: %zu bytes, starts with '%c'", i, chunk.count, chunk.count > 0 ? chunk.data[0] : '-');
+    }
+
+    line_index_free(&li);
+
+    // One long line at the end used to leave the chunks before it empty
+    li = line_index_build(SV("a\nb\nc\na much longer last line than all the others together"));
+    for (size_t i = 0; i < 4; ++i) {
+        String_view chunk = line_index_chunk(&li, i, 4);
+        log_info("chunk %zu of 4: %zu bytes, starts with '%c'", i, chunk.count, chunk.count > 0 ? chunk.data[0] : '-');
+    }
+    line_index_free(&li);
+
+    li = line_index_build(SV("trailing\n"));
+    log_info("lines in \"trailing\\n\": %zu", line_index_count(&li));
+    line_index_free(&li);
+
+    return 0;
+}
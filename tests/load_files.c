@@ -0,0 +1,40 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+int main(void) {
+    char paths[8][32];
+    File_load files[10] = {0};
+    for (int i = 0; i < 8; ++i) {
+        snprintf(paths[i], sizeof(paths[i]), "load_%d.txt", i);
+        FILE *f = fopen(paths[i], "wb");
+        ASSERT(f != NULL, "We are trying to write a test file...");
+        for (int j = 0; j < i*100; ++j) fputc('a' + (j % 26), f);
+        fclose(f);
+        files[i].path = paths[i];
+    }
+    files[8].path = "this_file_does_not_exist.txt";
+    files[9].path = ".";
+
+    Arena a = arena_make(16);
+    size_t loaded = load_files(files, ARRAY_LEN(files), &a, 4);
+    log_info("loaded %zu/%zu files", loaded, ARRAY_LEN(files));
+
+    for (size_t i = 0; i < ARRAY_LEN(files); ++i) {
+        File_load fl = files[i];
+        if (fl.error != 0) {
+            log_info("%s: %s", fl.path, strerror(fl.error));
+            continue;
+        }
+        bool ok = strlen(fl.content.data) == fl.content.count;
+        for (size_t j = 0; j < fl.content.count; ++j) {
+            if (fl.content.data[j] != 'a' + (char)(j % 26)) ok = false;
+        }
+        log_info("%s: %zu bytes, content %s", fl.path, fl.content.count, ok ? "ok" : "WRONG");
+    }
+
+    arena_free(&a);
+    for (int i = 0; i < 8; ++i) remove(paths[i]);
+
+    return 0;
+}
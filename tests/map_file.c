@@ -0,0 +1,33 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+int main(void) {
+    String_view content = map_file(__FILE__, MAP_SEQUENTIAL | MAP_WILLNEED);
+    ASSERT(content.data != NULL, "We are trying to map this file...");
+
+    int file_size = -1;
+    const char *buff = read_file(__FILE__, &file_size);
+    ASSERT(buff != NULL, "We are trying to read this file...");
+
+    log_info("mapped %zu bytes, read %d bytes, same content: %s", content.count, file_size,
+             content.count == (size_t)file_size && memcmp(content.data, buff, content.count) == 0 ? "yes" : "no");
+
+    String_view rest = content;
+    String_view first_line = sv_lpop_until_char(&rest, '\n');
+    log_info("first line: '"SV_FMT"'", SV_ARG(first_line));
+
+    unmap_file(content);
+    free((void *)buff);
+
+    touch_file_if_doesnt_exist("empty.txt");
+    String_view empty = map_file("empty.txt", 0);
+    log_info("empty file: data %s, %zu bytes", empty.data ? "set" : "NULL", empty.count);
+    unmap_file(empty);
+    remove("empty.txt");
+
+    String_view missing = map_file("this_file_does_not_exist.txt", 0);
+    log_info("missing file: data %s", missing.data ? "set" : "NULL");
+
+    return 0;
+}
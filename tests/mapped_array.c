@@ -0,0 +1,62 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#define PATH "mapped_array.tmp"
+
+typedef struct {
+    float64 *items;
+    size_t count;
+    size_t capacity;
+    Mdarr_file file;
+} Samples; // @mdarr
+
+typedef struct {
+    int32 *items;
+    size_t count;
+    size_t capacity;
+    Mdarr_file file;
+} Ints; // @mdarr
+
+int main(void) {
+    remove(PATH);
+
+    Samples s = {0};
+    if (!mdarr_open(s, PATH)) return 1;
+    printf("new: count %zu, capacity %zu\n", s.count, s.capacity);
+    for (int i = 0; i < 100000; ++i) mdarr_append(s, (float64)i * 0.5);
+    printf("appended: count %zu, capacity >= count: %s\n", s.count, s.capacity >= s.count ? "true" : "false");
+    mdarr_close(s);
+
+    // Still there after reopening, and loops work like on any darr
+    if (!mdarr_open(s, PATH)) return 1;
+    float64 sum = 0;
+    for (size_t i = 0; i < s.count; ++i) sum += s.items[i];
+    printf("reopened: count %zu, sum %.1f\n", s.count, sum);
+
+    // Count changed by hand is saved by sync/close
+    s.count = 10;
+    mdarr_sync(s);
+    mdarr_close(s);
+    if (!mdarr_open(s, PATH)) return 1;
+    printf("truncated: count %zu, last %.1f\n", s.count, s.items[s.count - 1]);
+    mdarr_append(s, 42.0);
+    printf("appended after reopen: %.1f at %zu\n", s.items[10], s.count - 1);
+    mdarr_close(s);
+
+    Ints wrong = {0};
+    printf("other item size: %s\n", mdarr_open(wrong, PATH) ? "opened" : "refused");
+    remove(PATH);
+
+    // Sized but never got its header (eg: died right after creating it), so it's started over
+    FILE *zeroed = fopen(PATH, "wb");
+    static char zeros[C_MDARR_HEADER_SIZE + 4096];
+    fwrite(zeros, 1, sizeof(zeros), zeroed);
+    fclose(zeroed);
+    if (!mdarr_open(s, PATH)) return 1;
+    printf("zeroed header: count %zu, capacity %zu\n", s.count, s.capacity);
+    mdarr_close(s);
+
+    remove(PATH);
+    return 0;
+}
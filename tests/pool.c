@@ -0,0 +1,92 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+typedef struct {
+    int64 *items;
+    size_t count;
+    size_t capacity;
+} Ints; // @darr
+
+static int64 counter = 0;
+
+static void inc(void *arg) {
+    (void)arg;
+    ATOMIC_FETCH_ADD(&counter, (int64)1);
+}
+
+// Waits from inside a job
+static void spawn_ten(void *arg) {
+    (void)arg;
+    Wait_group wg = {0};
+    Job jobs[10];
+    for (int i = 0; i < 10; ++i) {
+        jobs[i] = (Job){ inc, NULL, &wg };
+        pool_submit(&jobs[i]);
+    }
+    wait_group_wait(&wg);
+}
+
+static void square(void *items, size_t begin, size_t end, void *ctx) {
+    (void)ctx;
+    int64 *xs = items;
+    for (size_t i = begin; i < end; ++i) xs[i] *= xs[i];
+}
+
+static void sum_map(void *items, size_t begin, size_t end, void *acc, void *ctx) {
+    (void)ctx;
+    float *xs = items;
+    for (size_t i = begin; i < end; ++i) *(float *)acc += xs[i];
+}
+
+static void sum_combine(void *acc, const void *other, void *ctx) {
+    (void)ctx;
+    *(float *)acc += *(const float *)other;
+}
+
+int main(void) {
+    pool_start(3);
+    printf("workers: %d\n", pool_worker_count());
+
+    Wait_group wg = {0};
+    Job jobs[100];
+    for (int i = 0; i < 100; ++i) {
+        jobs[i] = (Job){ spawn_ten, NULL, &wg };
+        pool_submit(&jobs[i]);
+    }
+    wait_group_wait(&wg);
+    printf("nested jobs: %lld\n", (long long)counter);
+
+    Ints xs = {0};
+    for (int64 i = 0; i < 100003; ++i) darr_append(xs, i % 1000);
+    darr_parallel_for(xs, 0, square, NULL);
+    bool ok = true;
+    for (size_t i = 0; i < xs.count; ++i) ok = ok && xs.items[i] == (int64)((i % 1000) * (i % 1000));
+    printf("parallel_for: %s\n", ok ? "true" : "false");
+
+    // Tiny grain, lots of splitting
+    for (size_t i = 0; i < xs.count; ++i) xs.items[i] = 3;
+    darr_parallel_for(xs, 1, square, NULL);
+    ok = true;
+    for (size_t i = 0; i < xs.count; ++i) ok = ok && xs.items[i] == 9;
+    printf("grain 1: %s\n", ok ? "true" : "false");
+
+    // Same float sum whatever the number of threads
+    float fs[10007];
+    for (size_t i = 0; i < ARRAY_LEN(fs); ++i) fs[i] = 1.0f / (float)(i + 1);
+    float parallel = 0.0f;
+    parallel_reduce(fs, ARRAY_LEN(fs), 100, sum_map, sum_combine, &parallel, sizeof(parallel), NULL);
+    pool_stop();
+    pool_start(1);
+    float single = 0.0f;
+    parallel_reduce(fs, ARRAY_LEN(fs), 100, sum_map, sum_combine, &single, sizeof(single), NULL);
+    printf("reduce: %.6f, deterministic: %s\n", parallel, memcmp(&parallel, &single, sizeof(float)) == 0 ? "true" : "false");
+
+    int64 none = 42;
+    parallel_reduce(NULL, 0, 0, NULL, NULL, &none, sizeof(none), NULL);
+    printf("empty reduce: %lld\n", (long long)none);
+
+    pool_stop();
+    darr_free(xs);
+    return 0;
+}
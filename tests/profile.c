@@ -0,0 +1,80 @@
+#define COMMONLIB_PROFILE
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+static volatile uint64 sink = 0;
+
+static size_t count_str(const char *s, const char *needle) {
+    size_t n = 0;
+    while ((s = strstr(s, needle)) != NULL) {
+        n++;
+        s++;
+    }
+    return n;
+}
+
+static void work(int n) {
+    PROFILE_BEGIN("work");
+    for (int i = 0; i < n; ++i) sink += (uint64)i * i;
+    PROFILE_END();
+}
+
+static void *thread_main(void *arg) {
+    (void)arg;
+    for (int i = 0; i < 10; ++i) work(1000);
+    return NULL;
+}
+
+int main(void) {
+    PROFILE_BEGIN("main");
+    for (int i = 0; i < 3; ++i) {
+        PROFILE_BEGIN("frame");
+        work(100000);
+        work(100000);
+        PROFILE_END();
+    }
+    Thread t;
+    thread_create(&t, thread_main, NULL);
+    thread_join(t);
+    PROFILE_BEGIN("not ended");
+    PROFILE_END();
+    PROFILE_END();
+
+    Profile_stats stats = {0};
+    profile_summary(&stats);
+    bool self_le_total = true;
+    bool sorted = true;
+    for (size_t i = 0; i < stats.count; ++i) {
+        if (stats.items[i].self_ns > stats.items[i].total_ns) self_le_total = false;
+        if (i > 0 && stats.items[i].self_ns > stats.items[i-1].self_ns) sorted = false;
+    }
+    // Sorted by name for a stable output
+    const char *names[] = {"frame", "main", "not ended", "work"};
+    for (size_t n = 0; n < ARRAY_LEN(names); ++n) {
+        for (size_t i = 0; i < stats.count; ++i) {
+            if (strcmp(stats.items[i].name, names[n]) == 0) {
+                log_info("%s: %llu calls", names[n], (unsigned long long)stats.items[i].calls);
+            }
+        }
+    }
+    log_info("self <= total: %s", self_le_total ? "yes" : "no");
+    log_info("sorted by self time: %s", sorted ? "yes" : "no");
+    darr_free(stats);
+    stats = (Profile_stats){0};
+
+    ASSERT(profile_write_trace("trace.json"), "We are trying to write the trace...");
+    int size = 0;
+    const char *json = read_file("trace.json", &size);
+    log_info("trace: %zu begin and %zu end events, starts with '%.16s'",
+             count_str(json, "\"ph\":\"B\""), count_str(json, "\"ph\":\"E\""), json);
+    free((void *)json);
+    remove("trace.json");
+
+    profile_reset();
+    profile_summary(&stats);
+    log_info("after reset: %zu zones", stats.count);
+    darr_free(stats);
+
+    return 0;
+}
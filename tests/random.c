@@ -0,0 +1,77 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+static void *thread_main(void *arg) {
+    *(uint64 *)arg = rng_next(rng_thread());
+    return NULL;
+}
+
+int main(void) {
+    Rng r;
+    rng_seed(&r, 42);
+    for (int i = 0; i < 3; ++i) printf("next: %016llx\n", (unsigned long long)rng_next(&r));
+
+    Rng j = r;
+    rng_jump(&j);
+    printf("jump: %016llx %016llx %016llx %016llx\n",
+           (unsigned long long)j.s[0], (unsigned long long)j.s[1], (unsigned long long)j.s[2], (unsigned long long)j.s[3]);
+    Rng l = r;
+    rng_long_jump(&l);
+    printf("long jump: %016llx %016llx %016llx %016llx\n",
+           (unsigned long long)l.s[0], (unsigned long long)l.s[1], (unsigned long long)l.s[2], (unsigned long long)l.s[3]);
+
+    // Every value of a small range comes up about as often
+    int hist[7] = {0};
+    for (int i = 0; i < 70000; ++i) hist[rng_range(&r, -3, 3) + 3]++;
+    bool even = true;
+    for (int i = 0; i < 7; ++i) even = even && hist[i] > 9000 && hist[i] < 11000;
+    printf("range even: %s\n", even ? "true" : "false");
+    printf("whole int64 range: %s\n", rng_range(&r, INT64_MIN, INT64_MAX) != rng_range(&r, INT64_MIN, INT64_MAX) ? "true" : "false");
+    printf("below 1: %llu\n", (unsigned long long)rng_below(&r, 1));
+
+    // Bulk; Odd sizes to go through the tails
+    int32 ints[1001];
+    rng_fill_int(&r, ints, C_ARRAY_LEN(ints), -5, 5);
+    int min = INT_MAX, max = INT_MIN;
+    for (size_t i = 0; i < C_ARRAY_LEN(ints); ++i) {
+        min = MIN(min, ints[i]);
+        max = MAX(max, ints[i]);
+    }
+    printf("fill int: %d ~ %d\n", min, max);
+
+    float floats[1003];
+    rng_fill_float(&r, floats, C_ARRAY_LEN(floats), 2.f, 4.f);
+    bool in_range = true;
+    double sum = 0;
+    for (size_t i = 0; i < C_ARRAY_LEN(floats); ++i) {
+        in_range = in_range && floats[i] >= 2.f && floats[i] < 4.f;
+        sum += floats[i];
+    }
+    printf("fill float in range: %s, mean ~3: %s\n", in_range ? "true" : "false", sum / C_ARRAY_LEN(floats) > 2.9 && sum / C_ARRAY_LEN(floats) < 3.1 ? "true" : "false");
+
+    // Same seed, same numbers
+    random_seed(7);
+    int a = randomi(1, 6);
+    float f = randomf(-1.f, 1.f);
+    random_seed(7);
+    printf("reseeded: %s\n", a == randomi(1, 6) && f == randomf(-1.f, 1.f) ? "true" : "false");
+    // `to` is left out, so randomi(0, count) can index an array
+    bool randomi_ok = true;
+    for (int i = 0; i < 10000; ++i) {
+        int v = randomi(1, 6);
+        randomi_ok = randomi_ok && v >= 1 && v < 6;
+    }
+    printf("randomi in range: %s\n", randomi_ok ? "true" : "false");
+
+    // Each thread gets its own stream
+    uint64 first[2];
+    Thread t;
+    thread_create(&t, thread_main, &first[0]);
+    thread_join(t);
+    thread_create(&t, thread_main, &first[1]);
+    thread_join(t);
+    printf("threads differ: %s\n", first[0] != first[1] ? "true" : "false");
+
+    return 0;
+}
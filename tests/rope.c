@@ -0,0 +1,49 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+#include <fcntl.h>
+
+int main(void) {
+    // In memory
+    String_rope r = rope_make(-1, 16, 0);
+    rope_append_sv(&r, SV("Hello, "));
+    rope_appendf(&r, "%s! %d + %d = %d", "World", 34, 35, 34 + 35);
+    rope_append(&r, " (bytes)", 8);
+
+    String_builder sb = {0};
+    rope_to_sb(&r, &sb);
+    log_info("segments: %zu, buffered: %zu", r.count, r.buffered);
+    log_info("'"SV_FMT"'", (int)sb.count, sb.items);
+    rope_free(&r);
+
+    // Flushed to a file as it grows
+    const char *path = "rope.txt";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT(fd >= 0, "Failed to open rope.txt");
+
+    r = rope_make(fd, 64, 256);
+    size_t max_buffered = 0;
+    for (int i = 0; i < 1000; ++i) {
+        rope_appendf(&r, "line %d\n", i);
+        if (r.buffered > max_buffered) max_buffered = r.buffered;
+    }
+    log_info("written before the final flush: %s", r.written > 0 ? "yes" : "no");
+    log_info("never buffered more than threshold + a segment: %s", max_buffered <= 256 + 64 ? "yes" : "no");
+    ASSERT(rope_flush(&r), "Failed to flush the rope");
+    log_info("written: %llu bytes", (unsigned long long)r.written);
+    rope_free(&r);
+    close(fd);
+
+    int file_size = -1;
+    const char *content = read_file(path, &file_size);
+    ASSERT(content != NULL, "We just wrote this file");
+
+    sb.count = 0;
+    for (int i = 0; i < 1000; ++i) sb_appendf(&sb, "line %d\n", i);
+    log_info("file matches: %s", (size_t)file_size == sb.count && memcmp(content, sb.items, sb.count) == 0 ? "yes" : "no");
+
+    free((void *)content);
+    remove(path);
+    sb_free(&sb);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#include <time.h>
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = ms*1000000L };
+    nanosleep(&ts, NULL);
+}
+
+int main(void) {
+    uint64 a = time_now_ns();
+    sleep_ms(20);
+    uint64 b = time_now_ns();
+    log_info("time_now_ns() around a 20ms sleep: %s", b - a >= 20000000 && b - a < 500000000 ? "ok" : "WRONG");
+
+    uint64 t0 = time_ticks();
+    sleep_ms(20);
+    uint64 t1 = time_ticks();
+    uint64 ns = ticks_to_ns(t1 - t0);
+    log_info("ticks_to_ns() around a 20ms sleep: %s", ns >= 19000000 && ns < 500000000 ? "ok" : "WRONG");
+
+    Stopwatch sw = {0};
+    stopwatch_start(&sw);
+    sleep_ms(10);
+    stopwatch_stop(&sw);
+    sleep_ms(500); // not counted, as long as the sleeps that are stay under it
+    stopwatch_start(&sw);
+    sleep_ms(10);
+    uint64 lap = stopwatch_lap_ns(&sw);
+    log_info("stopwatch: %s", lap >= 19000000 && lap < 500000000 ? "ok" : "WRONG");
+    stopwatch_stop(&sw);
+    log_info("stopwatch after lap: %s", stopwatch_elapsed_ns(&sw) < lap ? "ok" : "WRONG");
+
+    Arena arena = arena_make(0);
+    cstr timedate = os_get_timedate(&arena);
+    bool ok = strlen(timedate) == 19;
+    for (int i = 0; ok && i < 19; ++i) {
+        char expected = i == 4 || i == 7 ? '-' : i == 10 ? ' ' : i == 13 || i == 16 ? ':' : '0';
+        ok = expected == '0' ? isdigit((unsigned char)timedate[i]) != 0 : timedate[i] == expected;
+    }
+    log_info("os_get_timedate() format: %s", ok ? "ok" : "WRONG");
+    cstr again = os_get_timedate(&arena);
+    log_info("second call gives a new string: %s", again != timedate ? "yes" : "no");
+    arena_free(&arena);
+
+    return 0;
+}
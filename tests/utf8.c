@@ -0,0 +1,82 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+#include <wchar.h>
+
+int main(void) {
+    String_view text = SV("h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80!");
+
+    size_t error_offset = 0;
+    log_info("valid: %d", utf8_validate(text, &error_offset));
+    log_info("bytes: %zu codepoints: %zu utf16 units: %zu", text.count, utf8_count_codepoints(text), utf8_utf16_length(text));
+
+    String_view it = text;
+    uint32 cp = 0;
+    while (sv_lpop_codepoint(&it, &cp)) {
+        log_info("U+%04X", cp);
+    }
+
+    uint16 utf16[32] = {0};
+    size_t utf16_count = 0;
+    ASSERT(utf8_to_utf16(text, utf16, &utf16_count), "We know `text` is valid!");
+    log_info("utf16[%zu]: %04X %04X", utf16_count, utf16[utf16_count-3], utf16[utf16_count-2]);
+
+    uint32 utf32[32] = {0};
+    size_t utf32_count = 0;
+    ASSERT(utf8_to_utf32(text, utf32, &utf32_count), "We know `text` is valid!");
+    log_info("utf32[%zu]: %X", utf32_count, utf32[utf32_count-2]);
+
+    wchar *wstr = sv_to_wstr(text);
+    ASSERT(wstr != NULL, "We know `text` is valid!");
+    log_info("wstr length: %zu", (size_t)wcslen(wstr));
+    C_FREE(wstr);
+
+    // Invalid
+    const char *invalid[] = {
+        "overlong \xc0\xaf",
+        "surrogate \xed\xa0\x80",
+        "too big \xf4\x90\x80\x80",
+        "truncated \xe2\x82",
+        "stray continuation \x80",
+    };
+    for (size_t i = 0; i < ARRAY_LEN(invalid); ++i) {
+        bool valid = utf8_validate(SV(invalid[i]), &error_offset);
+        log_info("'%.*s' valid: %d error at: %zu", (int)error_offset, invalid[i], valid, error_offset);
+    }
+
+    it = SV("a\xff" "b");
+    while (sv_lpop_codepoint(&it, &cp)) {
+        log_info("U+%04X", cp);
+    }
+
+    String_builder sb = {0};
+    sb_append_codepoint(&sb, 0x1F600);
+    sb_append_codepoint(&sb, 0xD800);
+    log_info("encoded: %zu bytes, valid: %d", sb.count, utf8_validate((String_view){ .data = sb.items, .count = sb.count }, NULL));
+    sb_free(&sb);
+
+    // Long enough for the vector paths, with the error moved over every block boundary
+    char long_text[300];
+    for (size_t i = 0; i + 4 <= sizeof(long_text); i += 4) memcpy(long_text + i, i % 8 ? "\xf0\x9f\x98\x80" : "ab\xc3\xa9", 4);
+    size_t mismatches = 0;
+    for (size_t at = 0; at < sizeof(long_text); ++at) {
+        char saved = long_text[at];
+        long_text[at] = (char)0xC0;
+        String_view sv = { .data = long_text, .count = sizeof(long_text) };
+        simd_set_level(C_SIMD_LEVEL_SCALAR);
+        size_t scalar_offset = 0;
+        bool scalar_valid = utf8_validate(sv, &scalar_offset);
+        simd_set_level(simd_detected_level());
+        size_t simd_offset = 0;
+        bool simd_valid = utf8_validate(sv, &simd_offset);
+        if (scalar_valid != simd_valid || scalar_offset != simd_offset) mismatches++;
+        long_text[at] = saved;
+    }
+    log_info("long text valid: %d, simd mismatches: %zu", utf8_validate((String_view){ .data = long_text, .count = sizeof(long_text) }, NULL), mismatches);
+
+    String_view padded = SV(" \t trimmed \r\n");
+    sv_trim(&padded);
+    log_info("'"SV_FMT"'", SV_ARG(padded));
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#define COMMONLIB_IMPLEMENTATION
+#define COMMONLIB_REMOVE_PREFIX
+#include "../commonlib.h"
+
+#include <sys/stat.h>
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char **)a, *(char **)b);
+}
+
+// Events come out in the order the kernel sent them, so sort them to get a stable output
+static void print_events(const char *title, Watch_events *events) {
+    char **lines = malloc(sizeof(char *) * (events->count + 1));
+    for (size_t i = 0; i < events->count; ++i) {
+        Watch_event *e = &events->items[i];
+        lines[i] = malloc(256);
+        snprintf(lines[i], 256, "%s%s:%s%s%s%s", watch_event_path(events, e), e->is_dir ? "/" : "",
+                 e->events & WATCH_CREATED  ? " created"  : "",
+                 e->events & WATCH_MODIFIED ? " modified" : "",
+                 e->events & WATCH_DELETED  ? " deleted"  : "",
+                 e->events & WATCH_MOVED    ? " moved"    : "");
+    }
+    qsort(lines, events->count, sizeof(*lines), cmp_str);
+
+    log_info("%s: %zu events", title, events->count);
+    for (size_t i = 0; i < events->count; ++i) {
+        log_info("    %s", lines[i]);
+        free(lines[i]);
+    }
+    free(lines);
+}
+
+static void write_file(const char *path, const char *content) {
+    FILE *f = fopen(path, "ab");
+    ASSERT(f != NULL, "We are trying to write a test file...");
+    fputs(content, f);
+    fclose(f);
+}
+
+int main(void) {
+    mkdir("watched", 0755);
+    mkdir("watched/sub", 0755);
+    write_file("watched/old.txt", "old");
+
+    Watch w;
+    ASSERT(os_watch_init(&w), "inotify should work");
+    ASSERT(os_watch_add(&w, "watched", WATCH_RECURSIVE), "We are trying to watch a dir...");
+
+    Watch_events events = {0};
+    os_watch_poll(&w, &events, 0);
+    print_events("nothing happened", &events);
+
+    // Many writes to the same file turn into one event
+    for (int i = 0; i < 100; ++i) write_file("watched/config.txt", "key = value\n");
+    write_file("watched/sub/asset.txt", "data");
+    rename("watched/old.txt", "watched/new.txt");
+    remove("watched/new.txt");
+    os_watch_poll(&w, &events, 100);
+    print_events("first batch", &events);
+
+    // Dirs created after the watch started are watched too
+    mkdir("watched/sub/later", 0755);
+    os_watch_poll(&w, &events, 100);
+    write_file("watched/sub/later/file.txt", "data");
+    os_watch_poll(&w, &events, 100);
+    print_events("new dir", &events);
+
+    // The watches follow a renamed dir, and so do the paths of everything under it
+    rename("watched/sub", "watched/renamed");
+    os_watch_poll(&w, &events, 100);
+    print_events("renamed dir", &events);
+    write_file("watched/renamed/later/new.txt", "data");
+    os_watch_poll(&w, &events, 100);
+    print_events("in the renamed dir", &events);
+
+    // Moved out of the tree, not watched anymore
+    mkdir("outside", 0755);
+    rename("watched/renamed", "outside/renamed");
+    os_watch_poll(&w, &events, 100);
+    print_events("moved out", &events);
+    write_file("outside/renamed/later/ignored.txt", "data");
+    os_watch_poll(&w, &events, 100);
+    print_events("outside the tree", &events);
+
+    remove("outside/renamed/later/ignored.txt");
+    remove("outside/renamed/later/new.txt");
+    remove("outside/renamed/later/file.txt");
+    remove("outside/renamed/later");
+    remove("outside/renamed/asset.txt");
+    remove("outside/renamed");
+    remove("outside");
+    remove("watched/config.txt");
+    remove("watched");
+    os_watch_close(&w);
+
+    // A file replaced the way editors save (write a temp file, rename it over) is still watched afterwards
+    ASSERT(os_watch_init(&w), "inotify should work");
+    write_file("watched_file.txt", "old");
+    ASSERT(os_watch_add(&w, "watched_file.txt", 0), "We are trying to watch a file...");
+    write_file("watched_file.txt.tmp", "new");
+    rename("watched_file.txt.tmp", "watched_file.txt");
+    os_watch_poll(&w, &events, 100);
+    print_events("replaced file", &events);
+    write_file("watched_file.txt", " and more");
+    os_watch_poll(&w, &events, 100);
+    print_events("written after the replace", &events);
+    remove("watched_file.txt");
+
+    watch_events_free(&events);
+    os_watch_close(&w);
+    return 0;
+}